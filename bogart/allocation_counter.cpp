@@ -0,0 +1,48 @@
+#include "bogart/allocation_counter.hpp"
+
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+//--------------------------------------------------------------------------------------------------
+//! Internal helper functions.
+//--------------------------------------------------------------------------------------------------
+namespace
+{
+  std::atomic<unsigned long> allocations(0);
+} // Anonymous namespace
+
+//--------------------------------------------------------------------------------------------------
+//! Replacements of the global allocation functions. The array and nothrow forms of operator new
+//! end up calling this one.
+//--------------------------------------------------------------------------------------------------
+void* operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  unsigned long get_allocation_count()
+  {
+    return allocations.load(std::memory_order_relaxed);
+  }
+} // namespace bogart
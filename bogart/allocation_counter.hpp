@@ -0,0 +1,14 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns how many times operator new has been called since the program started, by any
+  //!  thread, the engine included. Counting costs a relaxed atomic increment per allocation.
+  //!  Thread-safe.
+  //------------------------------------------------------------------------------------------------
+  unsigned long get_allocation_count();
+} // namespace bogart
+
+#endif // ALLOCATION_COUNTER_HPP
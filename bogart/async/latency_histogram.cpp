@@ -0,0 +1,148 @@
+#include "bogart/async/latency_histogram.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const unsigned int LINEAR_BUCKETS = 64;  // values below this get one bucket each
+    const unsigned int SUB_BUCKET_BITS = 5;  // every power of two above that is split in 32
+    const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    const unsigned int MAX_SHIFT = 39;       // covers values up to 2^45 ns (about 9.7 hours)
+    const unsigned int BUCKET_COUNT = LINEAR_BUCKETS + MAX_SHIFT * SUB_BUCKETS;
+
+    unsigned int get_bucket(unsigned long long value)
+    {
+      if (value < LINEAR_BUCKETS) {
+        return static_cast<unsigned int>(value);
+      }
+
+      // Keep the SUB_BUCKET_BITS + 1 most significant bits of the value
+      unsigned int magnitude = 63 - __builtin_clzll(value);
+      unsigned int shift = magnitude - SUB_BUCKET_BITS;
+      if (shift > MAX_SHIFT) {
+        return BUCKET_COUNT - 1;
+      }
+
+      return LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + static_cast<unsigned int>(value >> shift) - SUB_BUCKETS;
+    }
+
+    unsigned long long get_bucket_upper_bound(unsigned int bucket)
+    {
+      if (bucket < LINEAR_BUCKETS) {
+        return bucket;
+      }
+
+      unsigned int shift = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + 1;
+      unsigned long long sub_bucket = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+      return ((sub_bucket + 1) << shift) - 1;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  latency_histogram::latency_histogram() :
+    counts(BUCKET_COUNT, 0),
+    count(0),
+    sum(0),
+    sum_squares(0.0),
+    min(std::numeric_limits<long long>::max()),
+    max(0)
+  {
+
+  }
+
+  void latency_histogram::record(duration value)
+  {
+    long long v = (value.count() > 0) ? value.count() : 0;
+    counts[get_bucket(v)]++;
+    count++;
+    sum += v;
+    sum_squares += static_cast<double>(v) * v;
+    min = (v < min) ? v : min;
+    max = (v > max) ? v : max;
+  }
+
+  void latency_histogram::merge(const latency_histogram& other)
+  {
+    for (unsigned int i = 0; i < BUCKET_COUNT; i++) {
+      counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    sum_squares += other.sum_squares;
+    min = (other.min < min) ? other.min : min;
+    max = (other.max > max) ? other.max : max;
+  }
+
+  void latency_histogram::reset()
+  {
+    *this = latency_histogram();
+  }
+
+  unsigned long latency_histogram::get_count() const
+  {
+    return count;
+  }
+
+  latency_histogram::duration latency_histogram::get_min() const
+  {
+    return duration(count ? min : 0);
+  }
+
+  latency_histogram::duration latency_histogram::get_max() const
+  {
+    return duration(max);
+  }
+
+  latency_histogram::duration latency_histogram::get_mean() const
+  {
+    return duration(count ? sum / static_cast<long long>(count) : 0);
+  }
+
+  latency_histogram::duration latency_histogram::get_stddev() const
+  {
+    if (count == 0) {
+      return duration::zero();
+    }
+
+    double mean = static_cast<double>(sum) / count;
+    double variance = sum_squares / count - mean * mean;
+    return duration(static_cast<long long>(std::sqrt(std::max(variance, 0.0))));
+  }
+
+  latency_histogram::duration latency_histogram::get_percentile(double percentile) const
+  {
+    if (count == 0) {
+      return duration::zero();
+    }
+
+    // Rank of the requested value, counting from 1. Multiplying first keeps whole ranks exact.
+    unsigned long rank = static_cast<unsigned long>(std::ceil(percentile * count / 100.0));
+    rank = (rank < 1) ? 1 : ((rank > count) ? count : rank);
+
+    unsigned long seen = 0;
+    for (unsigned int i = 0; i < BUCKET_COUNT; i++) {
+      seen += counts[i];
+      if (seen >= rank) {
+        long long upper = static_cast<long long>(get_bucket_upper_bound(i));
+        return duration((upper < max) ? upper : max);
+      }
+    }
+
+    return duration(max);
+  }
+} // namespace async
+} // namespace bogart
@@ -0,0 +1,70 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <chrono>
+#include <vector>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class latency_histogram
+  //! @ingroup async
+  //!
+  //! Histogram of durations with log-linear buckets, in the style of HdrHistogram. Values below
+  //! 64 ns get a bucket each. Above that, every power of two is split into 32 buckets, so the
+  //! relative error of any reported value is under 3.2% while the whole range from 1 ns to
+  //! several hours fits in a fixed number of counters. Recording a value is O(1) and does not
+  //! allocate.
+  //!
+  //! Negative durations are recorded as zero. Values beyond the range are recorded in the last
+  //! bucket, but min and max are always exact.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class latency_histogram
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    typedef std::chrono::nanoseconds duration;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    latency_histogram();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    void record(duration value);
+    void merge(const latency_histogram& other);
+    void reset();
+    unsigned long get_count() const;
+    duration get_min() const;
+    duration get_max() const;
+    duration get_mean() const;
+    duration get_stddev() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the smallest value such that at least percentile % of the recorded values are
+    //!  less than or equal to it. Returns zero if the histogram is empty.
+    //! @param percentile Percentile in the range [0, 100].
+    //----------------------------------------------------------------------------------------------
+    duration get_percentile(double percentile) const;
+
+  private:
+    std::vector<unsigned long> counts;
+    unsigned long count;
+    long long sum;
+    double sum_squares;  // of the values in nanoseconds, for the standard deviation
+    long long min;
+    long long max;
+  }; // class latency_histogram
+} // namespace async
+} // namespace bogart
+
+#endif // LATENCY_HISTOGRAM_HPP
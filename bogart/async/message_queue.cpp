@@ -1,8 +1,12 @@
 #include "bogart/async/message_queue.hpp"
+#include "bogart/async/precise_wait.hpp"
 #include "bogart/log/log.hpp"
 
 #include <condition_variable>
+#include <algorithm>
 #include <stdexcept>
+#include <atomic>
+#include <thread>
 #include <mutex>
 #include <list>
 
@@ -18,6 +22,7 @@ namespace async
     void run_and_catch(runnable_ptr r) {
       try
       {
+        r->record_start();
         r->exec();
       }
       catch(std::exception& ex) {
@@ -32,7 +37,7 @@ namespace async
   class message_queue::message_queue_impl
   {
   public:
-    message_queue_impl() {
+    message_queue_impl() : high_precision(false), stats_enabled(false) {
 
     }
 
@@ -47,23 +52,79 @@ namespace async
       return true;
     }
 
+    bool wait_work_until(time_point deadline) {
+      std::unique_lock<std::mutex> lock(mtx);
+      time_point target = high_precision ? deadline - margin.get() : deadline;
+      bool slept = false;
+      while (runnables.empty()) {
+        if (clock::now() >= target) {
+          // Only sleeps that reached their target tell us about overshoot
+          if (high_precision && slept) {
+            margin.record_overshoot(clock::now() - target);
+          }
+          return false;
+        }
+        more.wait_until(lock, target);
+        slept = true;
+      }
+
+      return true;
+    }
+
     runnable_ptr get_next() {
       std::unique_lock<std::mutex> lock(mtx);
       runnable_ptr ret;
       if (!runnables.empty()) {
-        ret = std::move(runnables.front());
+        // Handlers posted before the stats were enabled have no posting time
+        time_point posted = runnables.front().posted;
+        if (stats_enabled.load(std::memory_order_relaxed) && posted != time_point()) {
+          std::chrono::nanoseconds wait = clock::now() - posted;
+          stats.handlers++;
+          stats.total_wait += wait;
+          stats.max_wait = std::max(stats.max_wait, wait);
+        }
+        ret = std::move(runnables.front().r);
         runnables.pop_front();
       }
 
       return ret;
     }
 
+    // Must be called with mtx locked. now is only read when the stats are enabled.
+    void push(runnable_ptr r, time_point now) {
+      runnables.push_back(queued_runnable(std::move(r), now));
+      stats.max_depth = std::max(stats.max_depth, runnables.size());
+    }
+
+    // The posting time of handlers, or nothing if nobody is collecting stats
+    time_point get_post_time() const {
+      return stats_enabled.load(std::memory_order_relaxed) ? clock::now() : time_point();
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    struct queued_runnable
+    {
+      queued_runnable(runnable_ptr r, time_point posted) : r(std::move(r)), posted(posted)
+      {
+
+      }
+
+      runnable_ptr r;
+      time_point posted;
+    };
+
     //----------------------------------------------------------------------------------------------
     //! Member variables
     //----------------------------------------------------------------------------------------------
-    std::list<runnable_ptr> runnables;
+    std::list<queued_runnable> runnables;
     std::condition_variable more;
     std::mutex mtx;
+    bool high_precision;
+    sleep_margin margin;
+    message_queue_stats stats;
+    std::atomic<bool> stats_enabled;     // read without the lock by post()
   }; // class message_queue::message_queue_impl
 
   //------------------------------------------------------------------------------------------------
@@ -78,8 +139,18 @@ namespace async
   }
 
   void message_queue::post(runnable_ptr r) {
+    time_point now = impl->get_post_time();
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    impl->push(std::move(r), now);
+    impl->more.notify_all();
+  }
+
+  void message_queue::post(runnable_vector rs) {
+    time_point now = impl->get_post_time();
     std::unique_lock<std::mutex> lock(impl->mtx);
-    impl->runnables.push_back(std::move(r));
+    for (runnable_vector::iterator it = rs.begin(); it != rs.end(); it++) {
+      impl->push(std::move(*it), now);
+    }
     impl->more.notify_all();
   }
 
@@ -92,5 +163,59 @@ namespace async
       }
     }
   }
+
+  void message_queue::run_until(time_point deadline)
+  {
+    runnable_ptr r;
+    while (clock::now() < deadline && impl->wait_work_until(deadline)) {
+      while ((r = impl->get_next())) {
+        run_and_catch(std::move(r));
+      }
+    }
+
+    // In high precision mode the wait above returns a bit early. Keep running handlers while we
+    // spin the rest of the way.
+    while (clock::now() < deadline) {
+      if ((r = impl->get_next())) {
+        run_and_catch(std::move(r));
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void message_queue::poll()
+  {
+    runnable_ptr r;
+    while ((r = impl->get_next())) {
+      run_and_catch(std::move(r));
+    }
+  }
+
+  void message_queue::set_high_precision(bool enabled)
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    impl->high_precision = enabled;
+  }
+
+  void message_queue::set_stats_enabled(bool enabled)
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    if (enabled != impl->stats_enabled.load()) {
+      impl->stats = message_queue_stats();
+      impl->stats.max_depth = impl->runnables.size();
+      impl->stats_enabled = enabled;
+    }
+  }
+
+  message_queue_stats message_queue::collect_stats()
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    message_queue_stats ret = impl->stats;
+    ret.depth = impl->runnables.size();
+    impl->stats = message_queue_stats();
+    impl->stats.max_depth = ret.depth;
+    return ret;
+  }
 } // namespace async
 } // namespace bogart
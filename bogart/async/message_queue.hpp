@@ -1,22 +1,62 @@
 #ifndef MESSAGE_QUEUE_HPP
 #define MESSAGE_QUEUE_HPP
 
+#include <cstddef>
 #include <chrono>
 #include <memory>
+#include <vector>
 
 namespace bogart
 {
 namespace async
 {
+  //------------------------------------------------------------------------------------------------
+  //! Receives how late runnables with a deadline started running. See runnable::set_deadline().
+  //------------------------------------------------------------------------------------------------
+  class lateness_sink
+  {
+  public:
+    lateness_sink() {}
+    virtual ~lateness_sink() {}
+    virtual void record(std::chrono::nanoseconds lateness) = 0;
+  };
+
+  typedef std::shared_ptr<lateness_sink> lateness_sink_ptr;
+
   class runnable
   {
   public:
-    runnable() {}
+    runnable() : deadline(), lateness() {}
     virtual ~runnable() {}
     virtual void exec() = 0;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Makes the queue that runs this runnable tell sink how long after deadline it started.
+    //!  Timers use it to measure their lateness without wrapping their handlers.
+    //----------------------------------------------------------------------------------------------
+    void set_deadline(std::chrono::steady_clock::time_point d, lateness_sink_ptr sink)
+    {
+      deadline = d;
+      lateness = std::move(sink);
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Called by the queue right before exec().
+    //----------------------------------------------------------------------------------------------
+    void record_start()
+    {
+      if (lateness) {
+        lateness->record(std::chrono::steady_clock::now() - deadline);
+      }
+    }
+
+  private:
+    std::chrono::steady_clock::time_point deadline;
+    lateness_sink_ptr lateness;
   };
 
   typedef std::unique_ptr<runnable> runnable_ptr;
+  typedef std::vector<runnable_ptr> runnable_vector;
 
   //------------------------------------------------------------------------------------------------
   //! @class callable_wrapper
@@ -62,6 +102,24 @@ namespace async
     return std::make_unique<callable_wrapper<callable>>(std::move(c));
   }
 
+  //------------------------------------------------------------------------------------------------
+  //! Counters of a message queue, accumulated since they were last collected. The wait of a
+  //! handler is the time from the moment it was posted to the moment it starts running.
+  //------------------------------------------------------------------------------------------------
+  struct message_queue_stats
+  {
+    message_queue_stats() : depth(0), max_depth(0), handlers(0), total_wait(), max_wait()
+    {
+
+    }
+
+    std::size_t depth;                 //!< handlers waiting to run when the stats were collected
+    std::size_t max_depth;             //!< most handlers waiting at once
+    unsigned long handlers;            //!< handlers that started running
+    std::chrono::nanoseconds total_wait;
+    std::chrono::nanoseconds max_wait;
+  };
+
   //------------------------------------------------------------------------------------------------
   //! @class message_queue
   //! @ingroup async
@@ -74,7 +132,9 @@ namespace async
     //----------------------------------------------------------------------------------------------
     //! Types
     //----------------------------------------------------------------------------------------------
-    typedef std::chrono::high_resolution_clock::duration duration;
+    typedef std::chrono::steady_clock clock;
+    typedef clock::duration duration;
+    typedef clock::time_point time_point;
 
     //----------------------------------------------------------------------------------------------
     //! Constructor
@@ -97,6 +157,12 @@ namespace async
     //----------------------------------------------------------------------------------------------
     void post(runnable_ptr r);
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief Queues several runnables to run immediately, in order, taking the lock and waking up
+    //!  the threads in run() only once.
+    //----------------------------------------------------------------------------------------------
+    void post(runnable_vector rs);
+
     //----------------------------------------------------------------------------------------------
     //! @brief Executes the event processing loop, running handlers as soon as they are posted.
     //! @param timeout Timeout for handler waits. If no handlers are posted for this duration the
@@ -106,6 +172,37 @@ namespace async
     //----------------------------------------------------------------------------------------------
     void run(duration timeout);
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief Executes the event processing loop until the given deadline, running handlers as soon
+    //!  as they are posted.
+    //! @remarks In high precision mode the method returns closer to the deadline, at the cost of
+    //!  spinning for a short time before it.
+    //----------------------------------------------------------------------------------------------
+    void run_until(time_point deadline);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Runs the handlers that are queued, and the ones they post, without waiting for more.
+    //----------------------------------------------------------------------------------------------
+    void poll();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Enables or disables high precision mode, in which waits for a deadline sleep until
+    //!  shortly before it and spin the rest of the way. The margin is tuned automatically from the
+    //!  overshoot of previous sleeps. Disabled by default.
+    //----------------------------------------------------------------------------------------------
+    void set_high_precision(bool enabled);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Enables or disables the counters returned by collect_stats(). While they are disabled
+    //!  post() doesn't read the clock, and only the depth is reported. Disabled by default.
+    //----------------------------------------------------------------------------------------------
+    void set_stats_enabled(bool enabled);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the counters accumulated since the last call and starts over.
+    //----------------------------------------------------------------------------------------------
+    message_queue_stats collect_stats();
+
   private:
     class message_queue_impl;                            //!< implementation class (Pimpl idiom)
     std::unique_ptr<message_queue_impl> impl;            //!< pointer to implementation (Pimpl idiom)
@@ -0,0 +1,71 @@
+#include "bogart/async/precise_wait.hpp"
+
+#include <thread>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const sleep_margin::duration MIN_MARGIN = std::chrono::microseconds(50);
+    const sleep_margin::duration MAX_MARGIN = std::chrono::milliseconds(2);
+    const sleep_margin::duration INITIAL_MARGIN = std::chrono::microseconds(500);
+    const int DECAY = 16; // smaller overshoots close 1/16th of the gap to the current margin
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  sleep_margin::sleep_margin() : margin(INITIAL_MARGIN)
+  {
+
+  }
+
+  sleep_margin::duration sleep_margin::get() const
+  {
+    return margin;
+  }
+
+  void sleep_margin::record_overshoot(duration overshoot)
+  {
+    if (overshoot < duration::zero()) {
+      return;
+    }
+
+    if (overshoot > margin) {
+      margin = overshoot;
+    } else {
+      margin -= (margin - overshoot) / DECAY;
+    }
+
+    margin = (margin < MIN_MARGIN) ? MIN_MARGIN : ((margin > MAX_MARGIN) ? MAX_MARGIN : margin);
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  void spin_until(std::chrono::steady_clock::time_point deadline)
+  {
+    while (std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+  }
+
+  void precise_sleep_until(std::chrono::steady_clock::time_point deadline, sleep_margin& margin)
+  {
+    std::chrono::steady_clock::time_point target = deadline - margin.get();
+    if (std::chrono::steady_clock::now() < target) {
+      std::this_thread::sleep_until(target);
+      margin.record_overshoot(std::chrono::steady_clock::now() - target);
+    }
+    spin_until(deadline);
+  }
+} // namespace async
+} // namespace bogart
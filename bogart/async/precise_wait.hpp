@@ -0,0 +1,68 @@
+#ifndef PRECISE_WAIT_HPP
+#define PRECISE_WAIT_HPP
+
+#include <chrono>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class sleep_margin
+  //! @ingroup async
+  //!
+  //! Sleeping until a deadline with a condition variable or a timerfd usually overshoots it by
+  //! somewhere between 50 us and 1 ms, depending on the scheduler and the load of the machine. A
+  //! precise wait sleeps until the deadline minus a margin and spins the rest of the way with
+  //! spin_until().
+  //!
+  //! sleep_margin tunes that margin from the overshoot measured after each sleep. It follows a
+  //! decaying maximum: an overshoot bigger than the current margin replaces it at once, and smaller
+  //! ones pull it down slowly, so a single quiet period doesn't make the next wait late.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class sleep_margin
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    typedef std::chrono::steady_clock::duration duration;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    sleep_margin();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    duration get() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Feeds the time that passed between the requested end of a sleep and the moment the
+    //!  thread actually woke up. Negative values (early wake-ups) are ignored.
+    //----------------------------------------------------------------------------------------------
+    void record_overshoot(duration overshoot);
+
+  private:
+    duration margin;
+  }; // class sleep_margin
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Busy-waits until the deadline, yielding the processor on every iteration so that other
+  //!  threads on the same core can still make progress.
+  //------------------------------------------------------------------------------------------------
+  void spin_until(std::chrono::steady_clock::time_point deadline);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Blocks the calling thread until the deadline: sleeps until the deadline minus the
+  //!  margin, feeds the overshoot of the sleep back to the margin and spins the rest of the way.
+  //------------------------------------------------------------------------------------------------
+  void precise_sleep_until(std::chrono::steady_clock::time_point deadline, sleep_margin& margin);
+} // namespace async
+} // namespace bogart
+
+#endif // PRECISE_WAIT_HPP
@@ -1,3 +1,4 @@
+#include "bogart/async/precise_wait.hpp"
 #include "bogart/async/timer.hpp"
 #include "bogart/log/log.hpp"
 
@@ -5,8 +6,16 @@
 #include <stdexcept>
 #include <thread>
 #include <mutex>
+#include <vector>
 #include <map>
-#include <set>
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#endif
 
 namespace bogart
 {
@@ -25,16 +34,152 @@ namespace async
       WAITING
     };
 
-    typedef std::multimap<timer::time_point, std::reference_wrapper<timer>> timer_map;
+    struct timer_entry
+    {
+      timer_entry(timer& t, timer::duration slack) : t(t), slack(slack)
+      {
+
+      }
+
+      std::reference_wrapper<timer> t;
+      timer::duration slack;
+    };
+
+    class lateness_record : public lateness_sink
+    {
+    public:
+      virtual void record(std::chrono::nanoseconds lateness)
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        histogram.record(lateness);
+      }
+
+      std::mutex mtx;
+      latency_histogram histogram;
+    };
+
+    typedef std::shared_ptr<lateness_record> lateness_record_ptr;
+
+    typedef std::multimap<timer::time_point, timer_entry> timer_map;
     typedef timer_map::iterator timer_it;
-    typedef std::set<timer::time_point> time_point_set;
-    typedef time_point_set::iterator time_point_it;
+    typedef std::pair<message_queue*, runnable_vector> queue_batch;
+    typedef std::vector<queue_batch> queue_batch_vector;
+    typedef queue_batch_vector::iterator queue_batch_it;
+
+    //----------------------------------------------------------------------------------------------
+    //! Strategy used by the timer thread to sleep. wait_until() is called with the loop mutex
+    //! locked and must return with it locked. notify() is called with the loop mutex locked and
+    //! must make a pending or future wait_until() return.
+    //----------------------------------------------------------------------------------------------
+    class timer_waiter
+    {
+    public:
+      timer_waiter() {}
+      virtual ~timer_waiter() {}
+      virtual void wait_until(std::unique_lock<std::mutex>& lock, timer::time_point deadline) = 0;
+      virtual void notify() = 0;
+    };
+
+    typedef std::unique_ptr<timer_waiter> timer_waiter_ptr;
+
+    class condition_variable_waiter : public timer_waiter
+    {
+    public:
+      virtual void wait_until(std::unique_lock<std::mutex>& lock, timer::time_point deadline)
+      {
+        cond.wait_until(lock, deadline);
+      }
+
+      virtual void notify()
+      {
+        cond.notify_one();
+      }
+
+    private:
+      std::condition_variable cond;
+    };
+
+#ifdef __linux__
+    //----------------------------------------------------------------------------------------------
+    //! Sleeps in poll() on a timerfd armed on CLOCK_MONOTONIC. An eventfd is polled alongside it
+    //! so that notify() can interrupt the wait. Since the eventfd keeps its counter until it is
+    //! read, a notification sent before the thread reaches poll() is not lost.
+    //----------------------------------------------------------------------------------------------
+    class timerfd_waiter : public timer_waiter
+    {
+    public:
+      timerfd_waiter() :
+        timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)),
+        event_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+
+      }
+
+      virtual ~timerfd_waiter()
+      {
+        if (timer_fd != -1) {
+          close(timer_fd);
+        }
+
+        if (event_fd != -1) {
+          close(event_fd);
+        }
+      }
+
+      bool is_ok()
+      {
+        return (timer_fd != -1 && event_fd != -1);
+      }
+
+      virtual void wait_until(std::unique_lock<std::mutex>& lock, timer::time_point deadline)
+      {
+        if (deadline <= timer::clock::now()) {
+          return;
+        }
+
+        // steady_clock is CLOCK_MONOTONIC, so its time points can be used as absolute times
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        itimerspec spec = itimerspec();
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+        pollfd fds[2];
+        fds[0].fd = timer_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = event_fd;
+        fds[1].events = POLLIN;
+        lock.unlock();
+        poll(fds, 2, -1);
+        lock.lock();
+
+        // Drain both descriptors so that the next poll() blocks again
+        uint64_t count = 0;
+        ssize_t r = read(timer_fd, &count, sizeof(count));
+        r = read(event_fd, &count, sizeof(count));
+        (void) r;
+      }
+
+      virtual void notify()
+      {
+        uint64_t one = 1;
+        ssize_t r = write(event_fd, &one, sizeof(one));
+        (void) r;
+      }
+
+    private:
+      int timer_fd;
+      int event_fd;
+    };
+#endif
 
     class timer_loop
     {
     public:
       timer_loop() :
         keep_running(true),
+        wake_up_time(),
+        high_precision(false),
+        waiter(std::make_unique<condition_variable_waiter>()),
         thr(&timer_loop::loop, this) {
 
       }
@@ -50,75 +195,149 @@ namespace async
         }
       }
 
-      void add_timer(timer& t, timer::time_point deadline) {
+      void add_timer(timer& t, timer::time_point deadline, timer::duration slack) {
         std::unique_lock<std::mutex> lock(mtx);
-        timer_map::value_type value(deadline, t);
+        timer_map::value_type value(deadline, timer_entry(t, slack));
         timers.insert(value);
-        cond.notify_one();
+
+        // Only interrupt the timer thread if it would otherwise wake up too late for this timer
+        if (deadline + slack < wake_up_time) {
+          waiter->notify();
+        }
       }
 
       void remove_timer(timer& t) {
-        // Iterate timers and save all matching keys
+        // Erase by position, other timers may share the same deadline
         std::unique_lock<std::mutex> lock(mtx);
-        time_point_set ts;
-        for (timer_it tit = timers.begin(); tit != timers.end(); tit++) {
-          if (&tit->second.get() == &t) {
-            ts.insert(tit->first);
+        timer_it tit = timers.begin();
+        while (tit != timers.end()) {
+          if (&tit->second.t.get() == &t) {
+            tit = timers.erase(tit);
+          } else {
+            tit++;
           }
         }
+      }
 
-        // Remove keys from map
-        for (time_point_it kit = ts.begin(); kit != ts.end(); kit++) {
-          timers.erase(*kit);
-        }
+      void set_waiter(timer_waiter_ptr w) {
+        // The timer thread may be inside the current waiter, so it makes the swap itself
+        std::unique_lock<std::mutex> lock(mtx);
+        next_waiter = std::move(w);
+        waiter->notify();
+      }
+
+      void set_high_precision(bool enabled) {
+        std::unique_lock<std::mutex> lock(mtx);
+        high_precision = enabled;
+      }
+
+      timer_loop_stats get_stats() {
+        std::unique_lock<std::mutex> lock(mtx);
+        return stats;
       }
 
     private:
       void stop() {
         std::unique_lock<std::mutex> lock(mtx);
         keep_running = false;
-        cond.notify_one();
+        waiter->notify();
+      }
+
+      timer::time_point get_wake_up_time() {
+        // Timers are sorted by deadline. A timer whose deadline is later than the best wake-up
+        // time found so far cannot move it earlier, so we can stop the search there.
+        timer::time_point ret = timer::clock::now() + std::chrono::seconds(5);
+        for (timer_it it = timers.begin(); it != timers.end() && it->first < ret; it++) {
+          timer::time_point latest = it->first + it->second.slack;
+          if (latest < ret) {
+            ret = latest;
+          }
+        }
+
+        return ret;
       }
 
       void dispatch_ready_timers() {
-        // Iterate timers and post the ones that are ready
-        time_point_set ready_keys;
-        timer::time_point now = std::chrono::high_resolution_clock::now();
+        // Collect the handlers of the ready timers grouped by target queue. There are only a few
+        // queues, so a linear search is cheaper than a map.
+        timer::time_point now = timer::clock::now();
         timer_it it = timers.begin();
         while (it != timers.end() && it->first <= now) {
-          ready_keys.insert(it->first);
-          timer& t = it->second;
-          t.dispatch();
+          timer& t = it->second.t;
+          message_queue* q = &t.get_queue();
+          queue_batch_it bit = batches.begin();
+          while (bit != batches.end() && bit->first != q) {
+            bit++;
+          }
+          if (bit == batches.end()) {
+            bit = batches.insert(bit, queue_batch(q, runnable_vector()));
+          }
+          bit->second.push_back(t.expire());
+          stats.dispatched++;
           it++;
         }
 
         // Remove ready timers from map
-        for (auto k : ready_keys) {
-          timers.erase(k);
+        timers.erase(timers.begin(), it);
+
+        // Hand each queue its handlers with a single lock and notification
+        for (queue_batch_it bit = batches.begin(); bit != batches.end(); bit++) {
+          bit->first->post(std::move(bit->second));
+          stats.posts++;
+        }
+        batches.clear();
+      }
+
+      void precise_wait(std::unique_lock<std::mutex>& lock) {
+        // Sleep until shortly before the wake-up time. If the sleep timed out (rather than being
+        // interrupted by a new timer) its overshoot tells us how much margin we need.
+        timer::time_point target = wake_up_time - margin.get();
+        if (timer::clock::now() < target) {
+          waiter->wait_until(lock, target);
+          timer::time_point now = timer::clock::now();
+          if (now < target) {
+            return;
+          }
+          margin.record_overshoot(now - target);
         }
+
+        // Let other threads add timers while we spin
+        lock.unlock();
+        spin_until(wake_up_time);
+        lock.lock();
       }
 
       void loop() {
         std::unique_lock<std::mutex> lock(mtx);
         while (keep_running) {
-          timer::time_point timeout = std::chrono::high_resolution_clock::now() + std::chrono::seconds(5);
-          if (!timers.empty()) {
-            timeout = timers.begin()->first;
+          wake_up_time = get_wake_up_time();
+          if (high_precision) {
+            precise_wait(lock);
+          } else {
+            waiter->wait_until(lock, wake_up_time);
+          }
+          stats.wake_ups++;
+
+          if (next_waiter) {
+            waiter = std::move(next_waiter);
           }
-          cond.wait_until(lock, timeout);
 
           if (keep_running) {
             dispatch_ready_timers();
           }
         }
-
-        cond.notify_one();
       }
 
       bool keep_running;
       timer_map timers;
+      queue_batch_vector batches;
+      timer::time_point wake_up_time;
+      bool high_precision;
+      sleep_margin margin;
+      timer_loop_stats stats;
       std::mutex mtx;
-      std::condition_variable cond;
+      timer_waiter_ptr waiter;
+      timer_waiter_ptr next_waiter;
       std::thread thr;
     };
 
@@ -131,8 +350,10 @@ namespace async
   class timer::timer_impl
   {
   public:
-    timer_impl(message_queue& queue) :
+    timer_impl(message_queue& queue, timer::duration slack) :
       queue(queue),
+      slack(slack),
+      lateness(std::make_shared<lateness_record>()),
       state(IDLE) {
 
     }
@@ -147,10 +368,23 @@ namespace async
       return state;
     }
 
-    void set_handler(bogart::async::runnable_ptr h)
+    void set_handler(bogart::async::runnable_ptr h, timer::time_point t)
     {
       std::unique_lock<std::mutex> lock(mtx);
       handler = std::move(h);
+      deadline = t;
+    }
+
+    void set_slack(timer::duration s)
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      slack = s;
+    }
+
+    timer::duration get_slack()
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      return slack;
     }
 
     //--------------------------------------------------------------------------------------------
@@ -158,16 +392,55 @@ namespace async
     //--------------------------------------------------------------------------------------------
     message_queue& queue;
     timer::time_point deadline;
+    timer::duration slack;
+    // Shared with the handlers in flight, which may run after the timer is destroyed
+    lateness_record_ptr lateness;
     bogart::async::runnable_ptr handler;
     timer_state state;
     std::mutex mtx;
   }; // class timer::timer_impl
 
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool set_timer_backend(timer_backend backend) {
+    if (backend == TIMER_BACKEND_CONDITION_VARIABLE) {
+      loop.set_waiter(std::make_unique<condition_variable_waiter>());
+      return true;
+    }
+
+#ifdef __linux__
+    if (backend == TIMER_BACKEND_TIMERFD) {
+      std::unique_ptr<timerfd_waiter> w = std::make_unique<timerfd_waiter>();
+      if (w->is_ok()) {
+        loop.set_waiter(std::move(w));
+        return true;
+      }
+      log::error("Could not create timerfd, keeping current timer backend");
+    }
+#endif
+
+    return false;
+  }
+
+  void set_timer_high_precision(bool enabled) {
+    loop.set_high_precision(enabled);
+  }
+
+  timer_loop_stats get_timer_loop_stats() {
+    return loop.get_stats();
+  }
+
   //------------------------------------------------------------------------------------------------
   //! Public member functions.
   //------------------------------------------------------------------------------------------------
   timer::timer(message_queue& queue) :
-    impl(std::make_unique<timer::timer_impl>(queue)) {
+    impl(std::make_unique<timer::timer_impl>(queue, duration::zero())) {
+
+  }
+
+  timer::timer(message_queue& queue, duration slack) :
+    impl(std::make_unique<timer::timer_impl>(queue, slack)) {
 
   }
 
@@ -178,18 +451,41 @@ namespace async
     }
   }
 
+  void timer::set_slack(duration slack) {
+    impl->set_slack(slack);
+  }
+
   void timer::async_wait(time_point t, bogart::async::runnable_ptr handler) {
     if (impl->get_state() == IDLE) {
       impl->set_state(WAITING);
-      impl->set_handler(std::move(handler));
-      loop.add_timer(*this, t);
+      impl->set_handler(std::move(handler), t);
+      loop.add_timer(*this, t, impl->get_slack());
     }
   }
 
   void timer::dispatch() {
+    impl->queue.post(expire());
+  }
+
+  runnable_ptr timer::expire() {
     std::unique_lock<std::mutex> lock(impl->mtx);
     impl->state = IDLE;
-    impl->queue.post(std::move(impl->handler));
+    impl->handler->set_deadline(impl->deadline, impl->lateness);
+    return std::move(impl->handler);
+  }
+
+  message_queue& timer::get_queue() {
+    return impl->queue;
+  }
+
+  latency_histogram timer::get_lateness() {
+    std::unique_lock<std::mutex> lock(impl->lateness->mtx);
+    return impl->lateness->histogram;
+  }
+
+  void timer::reset_lateness() {
+    std::unique_lock<std::mutex> lock(impl->lateness->mtx);
+    impl->lateness->histogram.reset();
   }
 } // namespace async
 } // namespace bogart
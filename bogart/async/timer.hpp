@@ -1,6 +1,7 @@
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
+#include "bogart/async/latency_histogram.hpp"
 #include "bogart/async/message_queue.hpp"
 
 #include <chrono>
@@ -10,10 +11,68 @@ namespace bogart
 {
 namespace async
 {
+  //------------------------------------------------------------------------------------------------
+  //! Backends the timer thread can use to sleep until the next deadline.
+  //!
+  //! TIMER_BACKEND_CONDITION_VARIABLE is portable and is the default.
+  //! TIMER_BACKEND_TIMERFD is only available on Linux. It sleeps on a timerfd armed on
+  //! CLOCK_MONOTONIC, which is not subject to the spurious wake-ups and the coarse rounding of
+  //! condition variable waits.
+  //------------------------------------------------------------------------------------------------
+  enum timer_backend
+  {
+    TIMER_BACKEND_CONDITION_VARIABLE = 0,
+    TIMER_BACKEND_TIMERFD
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! Counters of the timer thread, accumulated since the program started.
+  //------------------------------------------------------------------------------------------------
+  struct timer_loop_stats
+  {
+    timer_loop_stats() : wake_ups(0), dispatched(0), posts(0)
+    {
+
+    }
+
+    unsigned long wake_ups;   //!< times the timer thread returned from a wait
+    unsigned long dispatched; //!< timers whose handlers were posted to their queues
+    unsigned long posts;      //!< batches of handlers posted, at most one per queue and wake-up
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Selects the backend used by the timer thread.
+  //! @return false if the backend is not available on this platform. In that case the current
+  //!  backend is kept.
+  //! @remarks Thread-safe. Timers that are already waiting are kept and serviced by the new
+  //!  backend.
+  //------------------------------------------------------------------------------------------------
+  bool set_timer_backend(timer_backend backend);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Enables or disables high precision mode for the timer thread, in which it sleeps until
+  //!  shortly before the next wake-up time and spins the rest of the way. The margin is tuned
+  //!  automatically from the overshoot of previous sleeps. Disabled by default. Thread-safe.
+  //------------------------------------------------------------------------------------------------
+  void set_timer_high_precision(bool enabled);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns the counters of the timer thread. Thread-safe.
+  //------------------------------------------------------------------------------------------------
+  timer_loop_stats get_timer_loop_stats();
+
   //------------------------------------------------------------------------------------------------
   //! @class timer
   //! @ingroup async
   //!
+  //! Each timer has a slack, which is the amount of time its handler is allowed to be dispatched
+  //! after the deadline. The timer thread wakes up at the earliest time that honours the slack of
+  //! every waiting timer, so deadlines that fall within the same slack window are dispatched
+  //! together in a single wake-up. The default slack is zero.
+  //!
+  //! Every timer records the lateness of its handlers, that is, the time from the deadline to the
+  //! moment the handler starts running on the target queue. This includes the slack, the wake-up
+  //! latency of the timer thread and the time the handler waits in the queue.
   //------------------------------------------------------------------------------------------------
   class timer
   {
@@ -21,16 +80,37 @@ namespace async
     //----------------------------------------------------------------------------------------------
     //! Type for handlers
     //----------------------------------------------------------------------------------------------
-    typedef std::chrono::high_resolution_clock::time_point time_point;
+    typedef std::chrono::steady_clock clock;
+    typedef clock::time_point time_point;
+    typedef clock::duration duration;
 
     //----------------------------------------------------------------------------------------------
     //! Member functions
     //----------------------------------------------------------------------------------------------
     timer(message_queue& q);
+    timer(message_queue& q, duration slack);
     ~timer();
+    void set_slack(duration slack);
     void async_wait(time_point t, bogart::async::runnable_ptr handler);
     void dispatch();
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief Like dispatch(), but returns the handler instead of posting it, so that the caller
+    //!  can post the handlers of several timers to the same queue at once.
+    //----------------------------------------------------------------------------------------------
+    runnable_ptr expire();
+    message_queue& get_queue();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns a copy of the lateness histogram of this timer. Thread-safe.
+    //----------------------------------------------------------------------------------------------
+    latency_histogram get_lateness();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Clears the lateness histogram of this timer. Thread-safe.
+    //----------------------------------------------------------------------------------------------
+    void reset_lateness();
+
   private:
     class timer_impl;                            //!< implementation class (Pimpl idiom)
     std::unique_ptr<timer_impl> impl;            //!< pointer to implementation (Pimpl idiom)
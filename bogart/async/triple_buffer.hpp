@@ -0,0 +1,94 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class triple_buffer
+  //! @ingroup async
+  //!
+  //! Lock-free channel that hands the latest value of T from one writer thread to one reader
+  //! thread. Intermediate values that the reader doesn't get to see are dropped, which is what we
+  //! want for state that is fully described by its latest version, such as the world snapshot the
+  //! controller hands to the view.
+  //!
+  //! There are three buffers: the writer owns one, the reader owns another and the third one is
+  //! shared. Publishing swaps the writer's buffer with the shared one and marks it as fresh.
+  //! Reading swaps the reader's buffer with the shared one if it is fresh. Neither side ever waits
+  //! for the other, and neither side ever touches the buffer the other side owns.
+  //!
+  //! Thread-safety: get_write_buffer() and publish() must only be called from the writer thread.
+  //! update() and get_read_buffer() must only be called from the reader thread.
+  //------------------------------------------------------------------------------------------------
+  template<typename T>
+  class triple_buffer
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    triple_buffer() : shared(1), write_index(0), read_index(2)
+    {
+
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    T& get_write_buffer()
+    {
+      return buffers[write_index].value;
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Makes the contents of the write buffer available to the reader. The writer gets a new
+    //!  write buffer, whose contents are stale and must be overwritten.
+    //----------------------------------------------------------------------------------------------
+    void publish()
+    {
+      write_index = shared.exchange(write_index | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Makes the latest published value the read buffer.
+    //! @return true if a value was published since the last call, false if the read buffer did not
+    //!  change.
+    //----------------------------------------------------------------------------------------------
+    bool update()
+    {
+      if ((shared.load(std::memory_order_relaxed) & FRESH) == 0) {
+        return false;
+      }
+
+      read_index = shared.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+      return true;
+    }
+
+    const T& get_read_buffer() const
+    {
+      return buffers[read_index].value;
+    }
+
+  private:
+    static const unsigned int INDEX_MASK = 0x3;
+    static const unsigned int FRESH = 0x4;
+
+    // Each buffer gets its own cache line so that the two threads don't false-share
+    struct alignas(64) slot
+    {
+      T value;
+    };
+
+    slot buffers[3];
+    std::atomic<unsigned int> shared;  //!< index of the shared buffer, plus the FRESH flag
+    unsigned int write_index;          //!< only accessed by the writer
+    unsigned int read_index;           //!< only accessed by the reader
+  }; // class triple_buffer
+} // namespace async
+} // namespace bogart
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,179 @@
+#include "bogart/async/worker_pool.hpp"
+
+#include <condition_variable>
+#include <algorithm>
+#include <exception>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace bogart
+{
+namespace async
+{
+  class worker_pool::worker_pool_impl
+  {
+  public:
+    worker_pool_impl() :
+      threads(),
+      worker_count(0),
+      mtx(),
+      start(),
+      done(),
+      generation(0),
+      stopping(false),
+      body(nullptr),
+      begin(0),
+      end(0),
+      grain(1),
+      chunk_count(0),
+      next_chunk(0),
+      finished_workers(0),
+      error()
+    {
+
+    }
+
+    void work()
+    {
+      unsigned long seen = 0;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          while (!stopping && generation == seen) {
+            start.wait(lock);
+          }
+          if (stopping) {
+            return;
+          }
+          seen = generation;
+        }
+        run_chunks();
+
+        std::unique_lock<std::mutex> lock(mtx);
+        if (++finished_workers == worker_count) {
+          done.notify_all();
+        }
+      }
+    }
+
+    // Runs chunks of the current loop until there are none left to claim. The first exception a
+    // chunk throws is kept for parallel_for() to rethrow, and the chunks nobody claimed yet are
+    // skipped.
+    void run_chunks()
+    {
+      std::size_t chunk;
+      while ((chunk = next_chunk.fetch_add(1)) < chunk_count) {
+        std::size_t chunk_begin = begin + chunk * grain;
+        try
+        {
+          (*body)(chunk_begin, std::min(chunk_begin + grain, end));
+        }
+        catch(...) {
+          std::unique_lock<std::mutex> lock(mtx);
+          if (!error) {
+            error = std::current_exception();
+          }
+          next_chunk = chunk_count;
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    std::vector<std::thread> threads;
+    std::size_t worker_count;            // size of threads once they have all started
+    std::mutex mtx;
+    std::condition_variable start;       // a loop started or the pool is stopping
+    std::condition_variable done;        // the last worker finished its part of a loop
+    unsigned long generation;            // loops started so far
+    bool stopping;
+
+    // Current loop. Written by parallel_for() before bumping generation and read-only until every
+    // worker is done with it, so that a late worker never mixes up two loops.
+    const range_function* body;
+    std::size_t begin;
+    std::size_t end;
+    std::size_t grain;
+    std::size_t chunk_count;
+    std::atomic<std::size_t> next_chunk;
+    std::size_t finished_workers;
+    std::exception_ptr error;            // first exception thrown by a chunk of the current loop
+  }; // class worker_pool::worker_pool_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  worker_pool::worker_pool(unsigned int thread_count) : impl(std::make_unique<worker_pool::worker_pool_impl>())
+  {
+    impl->worker_count = (thread_count > 1) ? thread_count - 1 : 0;
+    for (unsigned int i = 1; i < thread_count; i++) {
+      impl->threads.push_back(std::thread(&worker_pool_impl::work, impl.get()));
+    }
+  }
+
+  worker_pool::~worker_pool()
+  {
+    {
+      std::unique_lock<std::mutex> lock(impl->mtx);
+      impl->stopping = true;
+      impl->start.notify_all();
+    }
+    for (std::thread& t : impl->threads) {
+      t.join();
+    }
+  }
+
+  unsigned int worker_pool::get_thread_count() const
+  {
+    return static_cast<unsigned int>(impl->worker_count) + 1;
+  }
+
+  void worker_pool::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const range_function& body)
+  {
+    grain = (grain > 0) ? grain : 1;
+    std::size_t chunk_count = get_chunk_count(begin, end, grain);
+    if (chunk_count == 0) {
+      return;
+    }
+
+    // A single chunk isn't worth waking anybody up
+    if (chunk_count == 1 || impl->worker_count == 0) {
+      for (std::size_t b = begin; b < end; b += grain) {
+        body(b, std::min(b + grain, end));
+      }
+      return;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(impl->mtx);
+      impl->body = &body;
+      impl->begin = begin;
+      impl->end = end;
+      impl->grain = grain;
+      impl->chunk_count = chunk_count;
+      impl->next_chunk = 0;
+      impl->finished_workers = 0;
+      impl->error = nullptr;
+      impl->generation++;
+      impl->start.notify_all();
+    }
+
+    impl->run_chunks();
+
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(impl->mtx);
+      while (impl->finished_workers < impl->worker_count) {
+        impl->done.wait(lock);
+      }
+      std::swap(error, impl->error);
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+} // namespace async
+} // namespace bogart
@@ -0,0 +1,105 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bogart
+{
+namespace async
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class worker_pool
+  //! @ingroup async
+  //!
+  //! Fixed set of threads for data-parallel loops. parallel_for() splits a range into chunks of
+  //! grain elements and runs them on the workers and on the calling thread, returning when all of
+  //! them are done. Chunk boundaries depend only on the range and the grain, never on the number of
+  //! threads, so a body that writes disjoint data per element gives the same results with any
+  //! thread count, serial included.
+  //!
+  //! A pool of N threads starts N - 1 workers, the caller being the last one. A pool of one thread
+  //! runs everything on the caller.
+  //!
+  //! Thread-safety: parallel_for() must not be called from different threads at the same time, nor
+  //! from within a body.
+  //------------------------------------------------------------------------------------------------
+  class worker_pool
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    typedef std::function<void(std::size_t, std::size_t)> range_function;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //! @param thread_count Threads to run loops on, the caller included. Zero is taken as one.
+    //----------------------------------------------------------------------------------------------
+    explicit worker_pool(unsigned int thread_count);
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor. Stops and joins the workers.
+    //----------------------------------------------------------------------------------------------
+    ~worker_pool();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    unsigned int get_thread_count() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Calls body(chunk_begin, chunk_end) for every chunk of [begin, end), in parallel.
+    //!
+    //! If body throws, the chunks that haven't started yet are skipped and the first exception is
+    //! rethrown on the calling thread once every worker is done with the loop.
+    //! @param grain Elements per chunk, the last one may be shorter. Zero is taken as one.
+    //----------------------------------------------------------------------------------------------
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const range_function& body);
+
+  private:
+    class worker_pool_impl;                              //!< implementation class (Pimpl idiom)
+    std::unique_ptr<worker_pool_impl> impl;              //!< pointer to implementation (Pimpl idiom)
+  }; // class worker_pool
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns the number of chunks parallel_for() splits [begin, end) into.
+  //------------------------------------------------------------------------------------------------
+  inline std::size_t get_chunk_count(std::size_t begin, std::size_t end, std::size_t grain)
+  {
+    grain = (grain > 0) ? grain : 1;
+    return (end > begin) ? (end - begin + grain - 1) / grain : 0;
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Maps every chunk of [begin, end) to a value in parallel, then folds the values with
+  //!  combine in chunk order, starting from init. The result doesn't depend on the thread count of
+  //!  the pool, even for combine functions that aren't associative such as floating point sums.
+  //------------------------------------------------------------------------------------------------
+  template<typename T, typename map_function, typename combine_function>
+  T parallel_reduce(worker_pool& pool,
+                    std::size_t begin,
+                    std::size_t end,
+                    std::size_t grain,
+                    T init,
+                    map_function map,
+                    combine_function combine)
+  {
+    grain = (grain > 0) ? grain : 1;
+    std::vector<T> partials(get_chunk_count(begin, end, grain), init);
+    pool.parallel_for(begin, end, grain, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+      partials[(chunk_begin - begin) / grain] = map(chunk_begin, chunk_end);
+    });
+
+    T ret = init;
+    for (const T& partial : partials) {
+      ret = combine(ret, partial);
+    }
+    return ret;
+  }
+} // namespace async
+} // namespace bogart
+
+#endif // WORKER_POOL_HPP
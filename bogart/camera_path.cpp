@@ -0,0 +1,118 @@
+#include "bogart/camera_path.hpp"
+#include "bogart/log/log.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    // Uniform Catmull-Rom interpolation between p1 and p2
+    template<typename T>
+    T catmull_rom(const T& p0, const T& p1, const T& p2, const T& p3, float u)
+    {
+      float u2 = u * u;
+      float u3 = u2 * u;
+      return 0.5f * ((2.0f * p1) +
+                     (p2 - p0) * u +
+                     (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 +
+                     (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+    }
+
+    bool is_earlier(const camera_keyframe& k, float t)
+    {
+      return k.time < t;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  camera_path::camera_path() : keyframes()
+  {
+
+  }
+
+  bool camera_path::load(const std::string& path)
+  {
+    std::ifstream in(path.c_str());
+    if (!in) {
+      log::error(std::string("Could not open camera path: ") + path);
+      return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+
+      std::istringstream ss(line);
+      camera_keyframe k;
+      if (!(ss >> k.time >> k.position.x >> k.position.y >> k.position.z >> k.pitch >> k.yaw)) {
+        log::error(std::string("Invalid camera path line: ") + line);
+        keyframes.clear();
+        return false;
+      }
+
+      if (!keyframes.empty() && k.time <= keyframes.back().time) {
+        log::error(std::string("Camera path keyframes are not in increasing order of time: ") + line);
+        keyframes.clear();
+        return false;
+      }
+
+      keyframes.push_back(k);
+    }
+
+    return !keyframes.empty();
+  }
+
+  bool camera_path::is_empty() const
+  {
+    return keyframes.empty();
+  }
+
+  float camera_path::get_duration() const
+  {
+    return keyframes.empty() ? 0.0f : keyframes.back().time;
+  }
+
+  camera_keyframe camera_path::evaluate(float t) const
+  {
+    if (keyframes.empty()) {
+      return camera_keyframe();
+    }
+
+    // Find the segment [i1, i2] that contains t
+    camera_keyframe_vector::const_iterator it = std::lower_bound(keyframes.begin(), keyframes.end(), t, is_earlier);
+    if (it == keyframes.begin()) {
+      return keyframes.front();
+    }
+    if (it == keyframes.end()) {
+      return keyframes.back();
+    }
+
+    size_t i2 = it - keyframes.begin();
+    size_t i1 = i2 - 1;
+    size_t i0 = (i1 > 0) ? i1 - 1 : i1;
+    size_t i3 = (i2 + 1 < keyframes.size()) ? i2 + 1 : i2;
+    const camera_keyframe& k0 = keyframes[i0];
+    const camera_keyframe& k1 = keyframes[i1];
+    const camera_keyframe& k2 = keyframes[i2];
+    const camera_keyframe& k3 = keyframes[i3];
+    float u = (t - k1.time) / (k2.time - k1.time);
+
+    camera_keyframe ret;
+    ret.time = t;
+    ret.position = catmull_rom(k0.position, k1.position, k2.position, k3.position, u);
+    ret.pitch = catmull_rom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, u);
+    ret.yaw = catmull_rom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, u);
+    return ret;
+  }
+} // namespace bogart
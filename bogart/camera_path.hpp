@@ -0,0 +1,65 @@
+#ifndef CAMERA_PATH_HPP
+#define CAMERA_PATH_HPP
+
+#include <glm/vec3.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+  struct camera_keyframe
+  {
+    camera_keyframe() : time(0.0f), position(0.0f), pitch(0.0f), yaw(0.0f)
+    {
+
+    }
+
+    float time;         // In seconds from the start of the path
+    glm::vec3 position;
+    float pitch;        // In degrees
+    float yaw;          // In degrees
+  };
+
+  typedef std::vector<camera_keyframe> camera_keyframe_vector;
+
+  //------------------------------------------------------------------------------------------------
+  //! @class camera_path
+  //! @ingroup bogart
+  //!
+  //! Camera path through a Catmull-Rom spline of keyframes. Path files are text files with one
+  //! keyframe per line, in increasing order of time:
+  //!
+  //!   time x y z pitch yaw
+  //!
+  //! Empty lines and lines starting with '#' are ignored.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class camera_path
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    camera_path();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    bool load(const std::string& path);
+    bool is_empty() const;
+    float get_duration() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the camera state at time t. Times outside the path are clamped to it.
+    //----------------------------------------------------------------------------------------------
+    camera_keyframe evaluate(float t) const;
+
+  private:
+    camera_keyframe_vector keyframes;
+  }; // class camera_path
+} // namespace bogart
+
+#endif // CAMERA_PATH_HPP
@@ -0,0 +1,596 @@
+#include "bogart/collision/bvh.hpp"
+#include "bogart/collision/geometry.hpp"
+#include "bogart/log/log.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const unsigned int BIN_COUNT = 12;
+    const std::size_t MAX_LEAF_SIZE = 4;
+    const std::size_t MAX_FORCED_LEAF_SIZE = 16;     // leaves SAH may keep if splitting doesn't pay
+    const float TRAVERSAL_COST = 1.0f;               // relative to a triangle test
+    const unsigned int MAX_STACK_DEPTH = 64;
+    const float SKIN = 1e-3f;
+    const unsigned int MAX_ADVANCE_ITERATIONS = 16;
+    const float MIN_DIRECTION = 1e-30f;
+    const char MAGIC[4] = { 'B', 'G', 'B', 'V' };
+    const std::uint32_t VERSION = 1;
+    const std::size_t NODE_SIZE = 32;                // bytes per node, in memory and in the cache
+
+    struct box
+    {
+      box() : min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max())
+      {
+
+      }
+
+      void grow(const glm::vec3& p)
+      {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+      }
+
+      void grow(const box& b)
+      {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+      }
+
+      float get_area() const
+      {
+        glm::vec3 e = max - min;
+        return (e.x < 0.0f) ? 0.0f : e.x * e.y + e.y * e.z + e.z * e.x;
+      }
+
+      glm::vec3 min;
+      glm::vec3 max;
+    };
+
+    struct build_triangle
+    {
+      box bounds;
+      glm::vec3 centroid;
+      std::uint32_t id;
+    };
+
+    struct bin
+    {
+      bin() : bounds(), count(0)
+      {
+
+      }
+
+      box bounds;
+      std::size_t count;
+    };
+
+    struct file_header
+    {
+      char magic[4];
+      std::uint32_t version;
+      std::uint64_t source_hash;
+      std::uint32_t node_count;
+      std::uint32_t triangle_count;
+    };
+
+    template<typename T>
+    bool read_array(std::ifstream& in, std::vector<T>& values, std::size_t count)
+    {
+      values.resize(count);
+      return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), count * sizeof(T)));
+    }
+
+    template<typename T>
+    void write_array(std::ofstream& out, const std::vector<T>& values)
+    {
+      out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    // Size the file must have for the counts in header
+    std::uint64_t get_file_size(const file_header& header)
+    {
+      return sizeof(file_header) +
+             static_cast<std::uint64_t>(header.node_count) * NODE_SIZE +
+             static_cast<std::uint64_t>(header.triangle_count) * (3 * sizeof(glm::vec3) + sizeof(std::uint32_t));
+    }
+
+    unsigned int get_bin(const build_triangle& t, int axis, float origin, float scale)
+    {
+      int i = static_cast<int>((t.centroid[axis] - origin) * scale);
+      return static_cast<unsigned int>(std::min(std::max(i, 0), static_cast<int>(BIN_COUNT) - 1));
+    }
+
+    // Slab test of the ray against [min, max]
+    bool intersect_box(const glm::vec3& min,
+                       const glm::vec3& max,
+                       const glm::vec3& origin,
+                       const glm::vec3& inv_dir,
+                       float max_t,
+                       float& t_enter)
+    {
+      glm::vec3 t1 = (min - origin) * inv_dir;
+      glm::vec3 t2 = (max - origin) * inv_dir;
+      glm::vec3 near = glm::min(t1, t2);
+      glm::vec3 far = glm::max(t1, t2);
+      float t_min = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+      float t_max = std::min(std::min(far.x, far.y), std::min(far.z, max_t));
+      t_enter = t_min;
+      return t_min <= t_max;
+    }
+
+    bool overlaps(const glm::vec3& min_a, const glm::vec3& max_a, const glm::vec3& min_b, const glm::vec3& max_b)
+    {
+      return min_a.x <= max_b.x && min_b.x <= max_a.x &&
+             min_a.y <= max_b.y && min_b.y <= max_a.y &&
+             min_a.z <= max_b.z && min_b.z <= max_a.z;
+    }
+
+    // Conservative advancement of capsule c along motion towards triangle (v0, v1, v2). The distance
+    // between two convex shapes is a convex function of a linear motion, so each Newton step stays
+    // short of contact.
+    bool advance(const capsule& c,
+                 const glm::vec3& motion,
+                 const glm::vec3& v0,
+                 const glm::vec3& v1,
+                 const glm::vec3& v2,
+                 float max_t,
+                 float& t,
+                 glm::vec3& normal)
+    {
+      t = 0.0f;
+      for (unsigned int i = 0; i < MAX_ADVANCE_ITERATIONS; i++) {
+        glm::vec3 on_segment;
+        glm::vec3 on_triangle;
+        glm::vec3 offset = motion * t;
+        float d = closest_points_segment_triangle(c.a + offset, c.b + offset, v0, v1, v2, on_segment, on_triangle);
+        if (d > SKIN * SKIN) {
+          normal = (on_segment - on_triangle) / d;
+        } else {
+          // Touching or crossing the plane, push out along the face against the motion
+          normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+          if (glm::dot(normal, motion) > 0.0f) {
+            normal = -normal;
+          }
+        }
+
+        float gap = d - c.radius;
+        float speed = -glm::dot(motion, normal); // rate at which the distance decreases
+        if (speed <= 0.0f) {
+          return false;
+        }
+        if (gap <= SKIN) {
+          return true;
+        }
+
+        t += (gap - 0.5f * SKIN) / speed;
+        if (t > max_t) {
+          return false;
+        }
+      }
+
+      // Every step is conservative, so stopping early is safe
+      return true;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  bvh::bvh() : nodes(), vertices(), ids(), source_hash(0)
+  {
+    static_assert(sizeof(node) == NODE_SIZE, "bvh nodes must be 32 bytes");
+  }
+
+  void bvh::build(const triangle_mesh& mesh)
+  {
+    nodes.clear();
+    vertices.clear();
+    ids.clear();
+    source_hash = hash_mesh(mesh);
+
+    std::size_t triangle_count = mesh.get_triangle_count();
+    std::vector<build_triangle> triangles(triangle_count);
+    for (std::size_t i = 0; i < triangle_count; i++) {
+      build_triangle& t = triangles[i];
+      for (std::size_t j = 0; j < 3; j++) {
+        t.bounds.grow(mesh.vertices[mesh.indices[3 * i + j]]);
+      }
+      t.centroid = (t.bounds.min + t.bounds.max) * 0.5f;
+      t.id = static_cast<std::uint32_t>(i);
+    }
+    if (triangle_count == 0) {
+      return;
+    }
+
+    // Depth-first with an explicit stack of (node, begin, end) ranges
+    struct range
+    {
+      std::size_t node;
+      std::size_t begin;
+      std::size_t end;
+      unsigned int depth;
+    };
+    std::vector<range> pending;
+    nodes.push_back(node());
+    pending.push_back(range{ 0, 0, triangle_count, 1 });
+    while (!pending.empty()) {
+      range r = pending.back();
+      pending.pop_back();
+
+      box bounds;
+      box centroids;
+      for (std::size_t i = r.begin; i < r.end; i++) {
+        bounds.grow(triangles[i].bounds);
+        centroids.grow(triangles[i].centroid);
+      }
+      nodes[r.node].min = bounds.min;
+      nodes[r.node].max = bounds.max;
+
+      std::size_t count = r.end - r.begin;
+      std::size_t split = r.begin;
+      // Queries keep a fixed stack of one entry per level
+      if (count > MAX_LEAF_SIZE && r.depth + 1 < MAX_STACK_DEPTH) {
+        // Evaluate the SAH at the bin boundaries of every axis
+        float best_cost = std::numeric_limits<float>::max();
+        int best_axis = -1;
+        unsigned int best_bin = 0;
+        for (int axis = 0; axis < 3; axis++) {
+          float extent = centroids.max[axis] - centroids.min[axis];
+          if (extent <= 0.0f) {
+            continue;
+          }
+
+          float scale = BIN_COUNT / extent;
+          bin bins[BIN_COUNT];
+          for (std::size_t i = r.begin; i < r.end; i++) {
+            bin& b = bins[get_bin(triangles[i], axis, centroids.min[axis], scale)];
+            b.bounds.grow(triangles[i].bounds);
+            b.count++;
+          }
+
+          float right_area[BIN_COUNT];
+          std::size_t right_count[BIN_COUNT];
+          box right;
+          std::size_t n = 0;
+          for (unsigned int i = BIN_COUNT - 1; i > 0; i--) {
+            right.grow(bins[i].bounds);
+            n += bins[i].count;
+            right_area[i] = right.get_area();
+            right_count[i] = n;
+          }
+
+          box left;
+          n = 0;
+          for (unsigned int i = 1; i < BIN_COUNT; i++) {
+            left.grow(bins[i - 1].bounds);
+            n += bins[i - 1].count;
+            float cost = left.get_area() * n + right_area[i] * right_count[i];
+            if (n > 0 && right_count[i] > 0 && cost < best_cost) {
+              best_cost = cost;
+              best_axis = axis;
+              best_bin = i;
+            }
+          }
+        }
+
+        float leaf_cost = static_cast<float>(count);
+        float split_cost = TRAVERSAL_COST + best_cost / std::max(bounds.get_area(), std::numeric_limits<float>::min());
+        if (best_axis >= 0 && (split_cost < leaf_cost || count > MAX_FORCED_LEAF_SIZE)) {
+          float scale = BIN_COUNT / (centroids.max[best_axis] - centroids.min[best_axis]);
+          float origin = centroids.min[best_axis];
+          auto middle = std::partition(triangles.begin() + r.begin, triangles.begin() + r.end, [&](const build_triangle& t) {
+            return get_bin(t, best_axis, origin, scale) < best_bin;
+          });
+          split = middle - triangles.begin();
+        } else if (best_axis < 0 && count > MAX_FORCED_LEAF_SIZE) {
+          // All centroids coincide, any split is as good as another
+          split = r.begin + count / 2;
+        }
+      }
+
+      if (split == r.begin) {
+        nodes[r.node].offset = static_cast<std::uint32_t>(r.begin);
+        nodes[r.node].count = static_cast<std::uint32_t>(count);
+        continue;
+      }
+
+      // Siblings are stored next to each other
+      std::size_t left = nodes.size();
+      std::size_t right = left + 1;
+      nodes.push_back(node());
+      nodes.push_back(node());
+      nodes[r.node].offset = static_cast<std::uint32_t>(left);
+      nodes[r.node].count = 0;
+      pending.push_back(range{ right, split, r.end, r.depth + 1 });
+      pending.push_back(range{ left, r.begin, split, r.depth + 1 });
+    }
+
+    vertices.reserve(3 * triangle_count);
+    ids.reserve(triangle_count);
+    for (const build_triangle& t : triangles) {
+      for (std::size_t j = 0; j < 3; j++) {
+        vertices.push_back(mesh.vertices[mesh.indices[3 * t.id + j]]);
+      }
+      ids.push_back(t.id);
+    }
+  }
+
+  bool bvh::is_empty() const
+  {
+    return nodes.empty();
+  }
+
+  std::size_t bvh::get_node_count() const
+  {
+    return nodes.size();
+  }
+
+  std::size_t bvh::get_triangle_count() const
+  {
+    return ids.size();
+  }
+
+  std::uint64_t bvh::get_source_hash() const
+  {
+    return source_hash;
+  }
+
+  bool bvh::raycast(const glm::vec3& origin, const glm::vec3& dir, float max_t, ray_hit& hit) const
+  {
+    if (nodes.empty()) {
+      return false;
+    }
+
+    glm::vec3 safe_dir = dir;
+    for (int i = 0; i < 3; i++) {
+      if (std::abs(safe_dir[i]) < MIN_DIRECTION) {
+        safe_dir[i] = MIN_DIRECTION;
+      }
+    }
+    glm::vec3 inv_dir = 1.0f / safe_dir;
+
+    float best_t = max_t;
+    std::uint32_t best = 0;
+    bool found = false;
+    std::uint32_t stack[MAX_STACK_DEPTH];
+    unsigned int depth = 0;
+    float t_enter = 0.0f;
+    if (intersect_box(nodes[0].min, nodes[0].max, origin, inv_dir, best_t, t_enter)) {
+      stack[depth++] = 0;
+    }
+
+    while (depth > 0) {
+      const node& n = nodes[stack[--depth]];
+      if (n.count > 0) {
+        for (std::uint32_t i = n.offset; i < n.offset + n.count; i++) {
+          float t = 0.0f;
+          if (intersect_ray_triangle(origin, dir, best_t, vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2], t)) {
+            best_t = t;
+            best = i;
+            found = true;
+          }
+        }
+        continue;
+      }
+
+      // Visit the nearer child first
+      std::uint32_t left = n.offset;
+      std::uint32_t right = n.offset + 1;
+      float t_left = 0.0f;
+      float t_right = 0.0f;
+      bool hit_left = intersect_box(nodes[left].min, nodes[left].max, origin, inv_dir, best_t, t_left);
+      bool hit_right = intersect_box(nodes[right].min, nodes[right].max, origin, inv_dir, best_t, t_right);
+      if (hit_left && hit_right) {
+        if (t_left > t_right) {
+          std::swap(left, right);
+        }
+        stack[depth++] = right;
+        stack[depth++] = left;
+      } else if (hit_left) {
+        stack[depth++] = left;
+      } else if (hit_right) {
+        stack[depth++] = right;
+      }
+    }
+
+    if (!found) {
+      return false;
+    }
+
+    const glm::vec3* v = &vertices[3 * best];
+    hit.t = best_t;
+    hit.triangle = ids[best];
+    hit.normal = glm::normalize(glm::cross(v[1] - v[0], v[2] - v[0]));
+    if (glm::dot(hit.normal, dir) > 0.0f) {
+      hit.normal = -hit.normal;
+    }
+    return true;
+  }
+
+  bool bvh::sweep_capsule(const capsule& c, const glm::vec3& motion, sweep_hit& hit) const
+  {
+    if (nodes.empty()) {
+      return false;
+    }
+
+    // Bounds of the capsule over the whole motion
+    glm::vec3 margin(c.radius + SKIN);
+    glm::vec3 min = glm::min(glm::min(c.a, c.b), glm::min(c.a, c.b) + motion) - margin;
+    glm::vec3 max = glm::max(glm::max(c.a, c.b), glm::max(c.a, c.b) + motion) + margin;
+
+    // Candidate triangles, reused across calls so that queries don't allocate once warm
+    static thread_local std::vector<std::uint32_t> candidates;
+    candidates.clear();
+    std::uint32_t stack[MAX_STACK_DEPTH];
+    unsigned int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+      const node& n = nodes[stack[--depth]];
+      if (!overlaps(min, max, n.min, n.max)) {
+        continue;
+      }
+      if (n.count > 0) {
+        for (std::uint32_t i = n.offset; i < n.offset + n.count; i++) {
+          candidates.push_back(i);
+        }
+      } else {
+        stack[depth++] = n.offset + 1;
+        stack[depth++] = n.offset;
+      }
+    }
+
+    float best_t = 1.0f;
+    bool found = false;
+    for (std::uint32_t i : candidates) {
+      float t = 0.0f;
+      glm::vec3 normal;
+      if (advance(c, motion, vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2], best_t, t, normal) &&
+          (!found || t < best_t)) {
+        best_t = t;
+        hit.normal = normal;
+        hit.triangle = ids[i];
+        found = true;
+      }
+    }
+
+    hit.t = best_t;
+    return found;
+  }
+
+  bool bvh::save(const std::string& path) const
+  {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      log::error(std::string("Could not open BVH cache for writing: ") + path);
+      return false;
+    }
+
+    file_header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.source_hash = source_hash;
+    header.node_count = static_cast<std::uint32_t>(nodes.size());
+    header.triangle_count = static_cast<std::uint32_t>(ids.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_array(out, nodes);
+    write_array(out, vertices);
+    write_array(out, ids);
+    return static_cast<bool>(out);
+  }
+
+  bool bvh::load(const std::string& path, std::uint64_t expected_hash)
+  {
+    nodes.clear();
+    vertices.clear();
+    ids.clear();
+    source_hash = 0;
+
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+      return false;
+    }
+
+    file_header header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+      log::error(std::string("Not a valid BVH cache: ") + path);
+      return false;
+    }
+    if (header.source_hash != expected_hash) {
+      log::debug(std::string("BVH cache is stale: ") + path);
+      return false;
+    }
+
+    // Check the counts before allocating anything for them
+    in.seekg(0, std::ios::end);
+    std::streamoff file_size = in.tellg();
+    in.seekg(sizeof(header));
+    if (file_size < 0 || static_cast<std::uint64_t>(file_size) != get_file_size(header)) {
+      log::error(std::string("BVH cache size doesn't match its header: ") + path);
+      return false;
+    }
+
+    if (!read_array(in, nodes, header.node_count) ||
+        !read_array(in, vertices, 3 * static_cast<std::size_t>(header.triangle_count)) ||
+        !read_array(in, ids, header.triangle_count) ||
+        !is_valid()) {
+      log::error(std::string("Corrupt BVH cache: ") + path);
+      nodes.clear();
+      vertices.clear();
+      ids.clear();
+      return false;
+    }
+
+    source_hash = header.source_hash;
+    return true;
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! Private member functions.
+  //------------------------------------------------------------------------------------------------
+  bool bvh::is_valid() const
+  {
+    // What build() produces: leaves cover triangles that exist, and inner nodes have two children
+    // stored after them that no other node points to, no deeper than queries can stack
+    if (nodes.empty()) {
+      return ids.empty();
+    }
+
+    std::vector<unsigned int> depths(nodes.size(), 0);
+    depths[0] = 1;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      const node& n = nodes[i];
+      if (depths[i] == 0) {
+        return false;
+      }
+      if (n.count > 0) {
+        if (n.offset > ids.size() || n.count > ids.size() - n.offset) {
+          return false;
+        }
+        continue;
+      }
+
+      if (n.offset <= i || n.offset >= nodes.size() - 1 || depths[i] + 1 >= MAX_STACK_DEPTH ||
+          depths[n.offset] != 0 || depths[n.offset + 1] != 0) {
+        return false;
+      }
+      depths[n.offset] = depths[i] + 1;
+      depths[n.offset + 1] = depths[i] + 1;
+    }
+
+    return true;
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool load_or_build(bvh& b, const triangle_mesh& mesh, const std::string& cache_path)
+  {
+    if (b.load(cache_path, hash_mesh(mesh))) {
+      return true;
+    }
+
+    b.build(mesh);
+    b.save(cache_path);
+    return false;
+  }
+} // namespace collision
+} // namespace bogart
@@ -0,0 +1,150 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "bogart/collision/triangle_mesh.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! Types
+  //------------------------------------------------------------------------------------------------
+  struct ray_hit
+  {
+    ray_hit() : t(0.0f), normal(0.0f), triangle(0)
+    {
+
+    }
+
+    float t;                 // distance along the ray, in units of its direction
+    glm::vec3 normal;        // unit normal of the triangle, facing the ray origin
+    std::uint32_t triangle;  // index of the triangle in the source mesh
+  };
+
+  // Segment from a to b inflated by radius
+  struct capsule
+  {
+    capsule() : a(0.0f), b(0.0f), radius(0.0f)
+    {
+
+    }
+
+    capsule(const glm::vec3& aa, const glm::vec3& ab, float aradius) : a(aa), b(ab), radius(aradius)
+    {
+
+    }
+
+    glm::vec3 a;
+    glm::vec3 b;
+    float radius;
+  };
+
+  struct sweep_hit
+  {
+    sweep_hit() : t(0.0f), normal(0.0f), triangle(0)
+    {
+
+    }
+
+    float t;                 // fraction of the motion that can be done, in [0, 1]
+    glm::vec3 normal;        // unit contact normal, pointing from the triangle to the capsule
+    std::uint32_t triangle;  // index of the triangle in the source mesh
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @class bvh
+  //! @ingroup collision
+  //!
+  //! Bounding volume hierarchy over the triangles of a triangle_mesh, built top-down with the
+  //! surface area heuristic evaluated over 12 bins per axis. Nodes are flattened into a single
+  //! array of 32 bytes per node, with siblings next to each other. Triangles are copied in leaf
+  //! order so that a leaf reads a contiguous range.
+  //!
+  //! The BVH doesn't reference the mesh after build(), and can be saved to and loaded from a cache
+  //! file to skip building at startup. The cache stores a hash of the source mesh and is rejected
+  //! if the mesh has changed.
+  //!
+  //! Thread-safety: queries are const and may run concurrently on the same instance. Calling
+  //! build() or load() while other threads query the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class bvh
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    bvh();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    void build(const triangle_mesh& mesh);
+    bool is_empty() const;
+    std::size_t get_node_count() const;
+    std::size_t get_triangle_count() const;
+    std::uint64_t get_source_hash() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Finds the closest triangle hit by the ray origin + t * dir, t in [0, max_t].
+    //! @return false if there is no hit.
+    //----------------------------------------------------------------------------------------------
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float max_t, ray_hit& hit) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Moves c along motion until it comes in contact with a triangle.
+    //!
+    //! Contact happens a small skin distance before touching, so that the capsule at hit.t can be
+    //! moved again without starting in penetration. Triangles the capsule already overlaps at the
+    //! start of the motion are ignored if the motion takes the capsule away from them, which lets a
+    //! stuck capsule move out.
+    //! @return false if the whole motion can be done.
+    //----------------------------------------------------------------------------------------------
+    bool sweep_capsule(const capsule& c, const glm::vec3& motion, sweep_hit& hit) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Writes the BVH to a cache file.
+    //! @return false if the file can't be written.
+    //----------------------------------------------------------------------------------------------
+    bool save(const std::string& path) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Reads a cache file written by save().
+    //! @return false if the file can't be read, is not a valid cache or was built from a mesh
+    //!  whose hash is not source_hash. The BVH is left empty in that case.
+    //----------------------------------------------------------------------------------------------
+    bool load(const std::string& path, std::uint64_t source_hash);
+
+  private:
+    bool is_valid() const;   // checks that loaded nodes only reference triangles and nodes we have
+
+    struct node
+    {
+      glm::vec3 min;
+      std::uint32_t offset;  // first triangle for leaves, left child for inner nodes
+      glm::vec3 max;
+      std::uint32_t count;   // triangle count for leaves, 0 for inner nodes
+    };
+
+    std::vector<node> nodes;
+    std::vector<glm::vec3> vertices;    // 3 per triangle, in leaf order
+    std::vector<std::uint32_t> ids;     // index of each triangle in the source mesh
+    std::uint64_t source_hash;
+  }; // class bvh
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Loads the BVH of mesh from cache_path, or builds it and writes it to cache_path if the
+  //!  cache is missing or stale.
+  //! @return true if the BVH was loaded from the cache.
+  //------------------------------------------------------------------------------------------------
+  bool load_or_build(bvh& b, const triangle_mesh& mesh, const std::string& cache_path);
+} // namespace collision
+} // namespace bogart
+
+#endif // BVH_HPP
@@ -0,0 +1,218 @@
+#include "bogart/collision/geometry.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const float EPSILON = 1e-12f;
+
+    float clamp01(float x)
+    {
+      return std::min(std::max(x, 0.0f), 1.0f);
+    }
+
+    // Like intersect_ray_triangle, but returns the parameter instead of testing it against a range
+    bool ray_plane_hit(const glm::vec3& origin,
+                       const glm::vec3& dir,
+                       const glm::vec3& v0,
+                       const glm::vec3& v1,
+                       const glm::vec3& v2,
+                       float& t)
+    {
+      glm::vec3 e1 = v1 - v0;
+      glm::vec3 e2 = v2 - v0;
+      glm::vec3 p = glm::cross(dir, e2);
+      float det = glm::dot(e1, p);
+      if (std::abs(det) < EPSILON) {
+        return false;
+      }
+
+      float inv_det = 1.0f / det;
+      glm::vec3 s = origin - v0;
+      float u = glm::dot(s, p) * inv_det;
+      if (u < 0.0f || u > 1.0f) {
+        return false;
+      }
+      glm::vec3 q = glm::cross(s, e1);
+      float v = glm::dot(dir, q) * inv_det;
+      if (v < 0.0f || u + v > 1.0f) {
+        return false;
+      }
+
+      t = glm::dot(e2, q) * inv_det;
+      return true;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool intersect_ray_triangle(const glm::vec3& origin,
+                              const glm::vec3& dir,
+                              float max_t,
+                              const glm::vec3& v0,
+                              const glm::vec3& v1,
+                              const glm::vec3& v2,
+                              float& t)
+  {
+    float hit_t = 0.0f;
+    if (!ray_plane_hit(origin, dir, v0, v1, v2, hit_t) || hit_t < 0.0f || hit_t > max_t) {
+      return false;
+    }
+
+    t = hit_t;
+    return true;
+  }
+
+  glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+  {
+    // Voronoi region tests, see Ericson, Real-Time Collision Detection, 5.1.5
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+      return a;
+    }
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+      return b;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+      return a + ab * (d1 / (d1 - d3));
+    }
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+      return c;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+      return a + ac * (d2 / (d2 - d6));
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+      return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    float sum = va + vb + vc;
+    if (sum < EPSILON) {
+      // Degenerate triangle, all the edge regions failed by rounding
+      return a;
+    }
+    float denom = 1.0f / sum;
+    return a + ab * (vb * denom) + ac * (vc * denom);
+  }
+
+  void closest_points_segment_segment(const glm::vec3& p1,
+                                      const glm::vec3& q1,
+                                      const glm::vec3& p2,
+                                      const glm::vec3& q2,
+                                      glm::vec3& c1,
+                                      glm::vec3& c2)
+  {
+    // See Ericson, Real-Time Collision Detection, 5.1.9
+    glm::vec3 d1 = q1 - p1;
+    glm::vec3 d2 = q2 - p2;
+    glm::vec3 r = p1 - p2;
+    float a = glm::dot(d1, d1);
+    float e = glm::dot(d2, d2);
+    float f = glm::dot(d2, r);
+    float s = 0.0f;
+    float t = 0.0f;
+
+    if (a <= EPSILON && e <= EPSILON) {
+      // Both segments are points
+    } else if (a <= EPSILON) {
+      t = clamp01(f / e);
+    } else {
+      float c = glm::dot(d1, r);
+      if (e <= EPSILON) {
+        s = clamp01(-c / a);
+      } else {
+        float b = glm::dot(d1, d2);
+        float denom = a * e - b * b;
+        s = (denom > EPSILON) ? clamp01((b * f - c * e) / denom) : 0.0f;
+        t = (b * s + f) / e;
+        if (t < 0.0f) {
+          t = 0.0f;
+          s = clamp01(-c / a);
+        } else if (t > 1.0f) {
+          t = 1.0f;
+          s = clamp01((b - c) / a);
+        }
+      }
+    }
+
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+  }
+
+  float closest_points_segment_triangle(const glm::vec3& a,
+                                        const glm::vec3& b,
+                                        const glm::vec3& v0,
+                                        const glm::vec3& v1,
+                                        const glm::vec3& v2,
+                                        glm::vec3& on_segment,
+                                        glm::vec3& on_triangle)
+  {
+    float t = 0.0f;
+    if (ray_plane_hit(a, b - a, v0, v1, v2, t) && t >= 0.0f && t <= 1.0f) {
+      on_segment = a + (b - a) * t;
+      on_triangle = on_segment;
+      return 0.0f;
+    }
+
+    // Otherwise the closest pair involves an endpoint of the segment or an edge of the triangle
+    on_segment = a;
+    on_triangle = closest_point_on_triangle(a, v0, v1, v2);
+    float best = glm::dot(on_segment - on_triangle, on_segment - on_triangle);
+
+    glm::vec3 q = closest_point_on_triangle(b, v0, v1, v2);
+    float d = glm::dot(b - q, b - q);
+    if (d < best) {
+      best = d;
+      on_segment = b;
+      on_triangle = q;
+    }
+
+    const glm::vec3* edges[3][2] = { { &v0, &v1 }, { &v1, &v2 }, { &v2, &v0 } };
+    for (auto& edge : edges) {
+      glm::vec3 c1;
+      glm::vec3 c2;
+      closest_points_segment_segment(a, b, *edge[0], *edge[1], c1, c2);
+      d = glm::dot(c1 - c2, c1 - c2);
+      if (d < best) {
+        best = d;
+        on_segment = c1;
+        on_triangle = c2;
+      }
+    }
+
+    return std::sqrt(best);
+  }
+} // namespace collision
+} // namespace bogart
@@ -0,0 +1,53 @@
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+#include <glm/vec3.hpp>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! @brief Intersects the ray origin + t * dir with triangle (v0, v1, v2), both faces
+  //!  (Möller-Trumbore).
+  //! @return true if the ray hits the triangle at some t in [0, max_t], which is written to t.
+  //------------------------------------------------------------------------------------------------
+  bool intersect_ray_triangle(const glm::vec3& origin,
+                              const glm::vec3& dir,
+                              float max_t,
+                              const glm::vec3& v0,
+                              const glm::vec3& v1,
+                              const glm::vec3& v2,
+                              float& t);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns the point of triangle (a, b, c) closest to p.
+  //------------------------------------------------------------------------------------------------
+  glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Computes the closest points c1 on segment (p1, q1) and c2 on segment (p2, q2).
+  //------------------------------------------------------------------------------------------------
+  void closest_points_segment_segment(const glm::vec3& p1,
+                                      const glm::vec3& q1,
+                                      const glm::vec3& p2,
+                                      const glm::vec3& q2,
+                                      glm::vec3& c1,
+                                      glm::vec3& c2);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Computes the closest points on_segment on segment (a, b) and on_triangle on triangle
+  //!  (v0, v1, v2).
+  //! @return The distance between them, 0 if the segment crosses the triangle.
+  //------------------------------------------------------------------------------------------------
+  float closest_points_segment_triangle(const glm::vec3& a,
+                                        const glm::vec3& b,
+                                        const glm::vec3& v0,
+                                        const glm::vec3& v1,
+                                        const glm::vec3& v2,
+                                        glm::vec3& on_segment,
+                                        glm::vec3& on_triangle);
+} // namespace collision
+} // namespace bogart
+
+#endif // GEOMETRY_HPP
@@ -0,0 +1,295 @@
+#include "bogart/collision/triangle_mesh.hpp"
+#include "bogart/service/content_dir.hpp"
+#include "bogart/log/log.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const char GEO_MAGIC[4] = { 'H', '3', 'D', 'G' };
+    const std::int32_t GEO_VERSION = 5;
+    const std::int32_t GEO_STREAM_POSITIONS = 0;
+    const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    typedef std::map<std::string, std::string> attribute_map;
+
+    // Geometry file contents we care about
+    struct geo_data
+    {
+      geo_data() : positions(), indices()
+      {
+
+      }
+
+      std::vector<glm::vec3> positions;
+      std::vector<std::uint32_t> indices;
+    };
+
+    template<typename T>
+    bool read_value(std::ifstream& in, T& value)
+    {
+      return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool read_geo(const std::string& path, geo_data& data)
+    {
+      std::ifstream in(path.c_str(), std::ios::binary);
+      if (!in) {
+        log::error(std::string("Could not open geometry file: ") + path);
+        return false;
+      }
+
+      char magic[sizeof(GEO_MAGIC)];
+      std::int32_t version = 0;
+      std::int32_t joint_count = 0;
+      if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, GEO_MAGIC, sizeof(GEO_MAGIC)) != 0 ||
+          !read_value(in, version) || version != GEO_VERSION || !read_value(in, joint_count) || joint_count < 0) {
+        log::error(std::string("Not a valid geometry file: ") + path);
+        return false;
+      }
+
+      // Skip the inverse bind matrices of the joints
+      in.seekg(joint_count * 16 * sizeof(float), std::ios::cur);
+
+      std::int32_t stream_count = 0;
+      std::int32_t vertex_count = 0;
+      if (!read_value(in, stream_count) || !read_value(in, vertex_count) || stream_count < 0 || vertex_count < 0) {
+        log::error(std::string("Truncated geometry file: ") + path);
+        return false;
+      }
+
+      for (std::int32_t i = 0; i < stream_count; i++) {
+        std::int32_t id = 0;
+        std::int32_t element_size = 0;
+        if (!read_value(in, id) || !read_value(in, element_size) || element_size < 0) {
+          log::error(std::string("Truncated geometry file: ") + path);
+          return false;
+        }
+
+        if (id == GEO_STREAM_POSITIONS && element_size == sizeof(glm::vec3)) {
+          data.positions.resize(vertex_count);
+          in.read(reinterpret_cast<char*>(data.positions.data()), vertex_count * sizeof(glm::vec3));
+        } else {
+          in.seekg(static_cast<std::streamoff>(vertex_count) * element_size, std::ios::cur);
+        }
+      }
+
+      std::int32_t index_count = 0;
+      if (!in || !read_value(in, index_count) || index_count < 0) {
+        log::error(std::string("Truncated geometry file: ") + path);
+        return false;
+      }
+      data.indices.resize(index_count);
+      in.read(reinterpret_cast<char*>(data.indices.data()), index_count * sizeof(std::uint32_t));
+      if (!in) {
+        log::error(std::string("Truncated geometry file: ") + path);
+        return false;
+      }
+
+      for (std::uint32_t index : data.indices) {
+        if (index >= data.positions.size()) {
+          log::error(std::string("Geometry file has indices out of range: ") + path);
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // Appends triangles [first, first + count) of data, transformed by m
+    void append_triangles(const geo_data& data, std::size_t first, std::size_t count, const glm::mat4& m, triangle_mesh& mesh)
+    {
+      std::uint32_t base = static_cast<std::uint32_t>(mesh.vertices.size());
+      std::map<std::uint32_t, std::uint32_t> remap; // geometry index to mesh index
+      for (std::size_t i = first; i < first + count && i < data.indices.size(); i++) {
+        std::uint32_t index = data.indices[i];
+        auto it = remap.find(index);
+        if (it == remap.end()) {
+          it = remap.insert(std::make_pair(index, base + static_cast<std::uint32_t>(remap.size()))).first;
+          mesh.vertices.push_back(glm::vec3(m * glm::vec4(data.positions[index], 1.0f)));
+        }
+        mesh.indices.push_back(it->second);
+      }
+    }
+
+    // Transformation of a scene node, composed like Horde3D does: translation, then rotation
+    // about Y, X and Z (in degrees), then scale
+    glm::mat4 get_node_transform(const attribute_map& attributes)
+    {
+      auto get = [&](const char* name, float default_value) {
+        auto it = attributes.find(name);
+        return (it == attributes.end()) ? default_value : static_cast<float>(std::atof(it->second.c_str()));
+      };
+
+      glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(get("tx", 0.0f), get("ty", 0.0f), get("tz", 0.0f)));
+      m = glm::rotate(m, glm::radians(get("ry", 0.0f)), glm::vec3(0.0f, 1.0f, 0.0f));
+      m = glm::rotate(m, glm::radians(get("rx", 0.0f)), glm::vec3(1.0f, 0.0f, 0.0f));
+      m = glm::rotate(m, glm::radians(get("rz", 0.0f)), glm::vec3(0.0f, 0.0f, 1.0f));
+      return glm::scale(m, glm::vec3(get("sx", 1.0f), get("sy", 1.0f), get("sz", 1.0f)));
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Minimal scanner for the XML subset of Horde3D scene files: elements with attributes, no
+    //! text content.
+    //----------------------------------------------------------------------------------------------
+    struct xml_tag
+    {
+      xml_tag() : name(), attributes(), is_closing(false), is_self_closing(false)
+      {
+
+      }
+
+      std::string name;
+      attribute_map attributes;
+      bool is_closing;          // </name>
+      bool is_self_closing;     // <name ... />
+    };
+
+    // Reads the next tag starting at pos. Returns false at the end of the text.
+    bool next_tag(const std::string& text, std::size_t& pos, xml_tag& tag)
+    {
+      while (true) {
+        std::size_t start = text.find('<', pos);
+        if (start == std::string::npos) {
+          return false;
+        }
+        if (text.compare(start, 4, "<!--") == 0) {
+          std::size_t end = text.find("-->", start);
+          pos = (end == std::string::npos) ? text.size() : end + 3;
+          continue;
+        }
+        std::size_t end = text.find('>', start);
+        if (end == std::string::npos) {
+          return false;
+        }
+        pos = end + 1;
+        if (text[start + 1] == '?' || text[start + 1] == '!') {
+          continue;
+        }
+
+        tag = xml_tag();
+        std::size_t i = start + 1;
+        tag.is_closing = (text[i] == '/');
+        if (tag.is_closing) {
+          i++;
+        }
+        tag.is_self_closing = (text[end - 1] == '/');
+        std::size_t name_end = text.find_first_of(" \t\r\n/>", i);
+        tag.name = text.substr(i, name_end - i);
+
+        // name="value" pairs
+        i = name_end;
+        while (true) {
+          std::size_t eq = text.find('=', i);
+          if (eq == std::string::npos || eq > end) {
+            break;
+          }
+          std::size_t name_start = text.find_first_not_of(" \t\r\n", i);
+          std::size_t quote = text.find('"', eq);
+          std::size_t quote_end = text.find('"', quote + 1);
+          if (quote == std::string::npos || quote_end == std::string::npos || quote_end > end) {
+            break;
+          }
+          std::string name = text.substr(name_start, text.find_last_not_of(" \t\r\n", eq - 1) + 1 - name_start);
+          tag.attributes[name] = text.substr(quote + 1, quote_end - quote - 1);
+          i = quote_end + 1;
+        }
+        return true;
+      }
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool load_geo(const std::string& path, triangle_mesh& mesh)
+  {
+    geo_data data;
+    if (!read_geo(path, data)) {
+      return false;
+    }
+
+    append_triangles(data, 0, data.indices.size(), glm::mat4(1.0f), mesh);
+    return true;
+  }
+
+  bool load_scene(const std::string& path, const std::string& content_dir, triangle_mesh& mesh)
+  {
+    std::ifstream in(path.c_str());
+    if (!in) {
+      log::error(std::string("Could not open scene file: ") + path);
+      return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    geo_data data;
+    std::vector<glm::mat4> transforms(1, glm::mat4(1.0f)); // of the open elements
+    std::size_t pos = 0;
+    xml_tag tag;
+    while (next_tag(text, pos, tag)) {
+      if (tag.is_closing) {
+        if (transforms.size() > 1) {
+          transforms.pop_back();
+        }
+        continue;
+      }
+
+      if (tag.name == "Model") {
+        std::string geo_path;
+        if (!service::find_content_file(content_dir, tag.attributes["geometry"], geo_path) || !read_geo(geo_path, data)) {
+          log::error(std::string("Could not load the geometry of scene: ") + path);
+          return false;
+        }
+      }
+
+      // The model itself is at the origin of its space
+      glm::mat4 m = (tag.name == "Model") ? transforms.back() : transforms.back() * get_node_transform(tag.attributes);
+      if (tag.name == "Mesh") {
+        std::size_t first = std::strtoul(tag.attributes["batchStart"].c_str(), nullptr, 10);
+        std::size_t count = std::strtoul(tag.attributes["batchCount"].c_str(), nullptr, 10);
+        append_triangles(data, first, count, m, mesh);
+      }
+
+      if (!tag.is_self_closing) {
+        transforms.push_back(m);
+      }
+    }
+
+    return true;
+  }
+
+  std::uint64_t hash_mesh(const triangle_mesh& mesh)
+  {
+    std::uint64_t h = FNV_OFFSET;
+    auto add = [&h](const void* data, std::size_t size) {
+      const unsigned char* p = static_cast<const unsigned char*>(data);
+      for (std::size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+      }
+    };
+
+    add(mesh.vertices.data(), mesh.vertices.size() * sizeof(glm::vec3));
+    add(mesh.indices.data(), mesh.indices.size() * sizeof(std::uint32_t));
+    return h;
+  }
+} // namespace collision
+} // namespace bogart
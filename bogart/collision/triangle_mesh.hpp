@@ -0,0 +1,58 @@
+#ifndef TRIANGLE_MESH_HPP
+#define TRIANGLE_MESH_HPP
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+namespace collision
+{
+  //------------------------------------------------------------------------------------------------
+  //! Indexed triangle list. Triangle i is made of the vertices at indices 3i, 3i+1 and 3i+2.
+  //------------------------------------------------------------------------------------------------
+  struct triangle_mesh
+  {
+    triangle_mesh() : vertices(), indices()
+    {
+
+    }
+
+    std::size_t get_triangle_count() const
+    {
+      return indices.size() / 3;
+    }
+
+    std::vector<glm::vec3> vertices;
+    std::vector<std::uint32_t> indices;
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Appends all the triangles of a Horde3D geometry file (.geo, version 5) to mesh, with
+  //!  vertex positions as stored in the file.
+  //! @return false if the file can't be read or is not a valid geometry file.
+  //------------------------------------------------------------------------------------------------
+  bool load_geo(const std::string& path, triangle_mesh& mesh);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Appends the triangles of the meshes of a Horde3D scene file (.scene.xml) to mesh, in
+  //!  the space of the model. Each mesh takes its batch of the geometry file the model references
+  //!  (found in content_dir, which may list several directories separated by '|' like
+  //!  -content-dir does) and is transformed by its own transformation and those of the
+  //!  nodes it is nested in, as Horde3D does when rendering. Joints are treated like any other node,
+  //!  so skinned meshes come out in their bind pose only if their joints are at the origin.
+  //! @return false if the scene or its geometry can't be read.
+  //------------------------------------------------------------------------------------------------
+  bool load_scene(const std::string& path, const std::string& content_dir, triangle_mesh& mesh);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns a 64-bit FNV-1a hash of the vertices and indices of mesh.
+  //------------------------------------------------------------------------------------------------
+  std::uint64_t hash_mesh(const triangle_mesh& mesh);
+} // namespace collision
+} // namespace bogart
+
+#endif // TRIANGLE_MESH_HPP
@@ -1,14 +1,36 @@
+#include "bogart/service/thread_cpu_clock.hpp"
+#include "bogart/service/content_dir.hpp"
+#include "bogart/service/input_state.hpp"
+#include "bogart/service/input_log.hpp"
+#include "bogart/world/entity_world.hpp"
+#include "bogart/collision/triangle_mesh.hpp"
+#include "bogart/collision/bvh.hpp"
+#include "bogart/async/worker_pool.hpp"
 #include "bogart/async/timer.hpp"
+#include "bogart/player_camera.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/frame_report.hpp"
+#include "bogart/camera_path.hpp"
 #include "bogart/controller.hpp"
 #include "bogart/stop_watch.hpp"
-#include "bogart/fps_actor.hpp"
 #include "bogart/log/log.hpp"
 #include "bogart/view.hpp"
 
+#include <glm/trigonometric.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <sstream>
 #include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
 #include <string>
+#include <thread>
+#include <vector>
 #include <map>
 
 namespace bogart
@@ -24,6 +46,28 @@ namespace bogart
   const std::string OPTION_WIDTH              = "-width";
   const std::string OPTION_HEIGHT             = "-height";
   const std::string OPTION_FULLSCREEN         = "-fullscreen";
+  const std::string OPTION_TICK_RATE          = "-tick-rate";
+  const std::string OPTION_RECORD             = "-record";
+  const std::string OPTION_REPLAY             = "-replay";
+  const std::string OPTION_REPLAY_FAST        = "-replay-fast";
+  const std::string OPTION_BENCHMARK          = "-benchmark";
+  const std::string OPTION_BENCHMARK_DURATION = "-benchmark-duration";
+  const std::string OPTION_BENCHMARK_REPORT   = "-benchmark-report";
+  const std::string OPTION_BENCHMARK_MAX_P99  = "-benchmark-max-p99-ms";
+  const std::string OPTION_ACTORS             = "-actors";
+  const std::string OPTION_COLLISION          = "-collision";
+  const std::string OPTION_COLLISION_CACHE    = "-collision-cache-dir";
+  const std::string OPTION_WORKER_THREADS     = "-worker-threads";
+  const std::string OPTION_FPS_CAP            = "-fps-cap";
+  const int EXIT_STATUS_SUCCESS               = 0;
+  const int EXIT_STATUS_FAILURE               = 1;
+  const int EXIT_STATUS_BENCHMARK_TOO_SLOW    = 2;
+  const float MAX_FRAME_TIME                  = 0.25f; // in seconds, caps catch-up after a stall
+  const float PLAYER_VELOCITY                 = 7.5f;
+  const float PLAYER_RADIUS                   = 0.3f;
+  const float PLAYER_HEIGHT                   = 1.3f;  // between the centers of the capsule caps
+  const unsigned int MAX_SLIDE_ITERATIONS     = 3;
+  const std::size_t SCENE_GRAIN               = 4096;  // actor poses per chunk of update_scene()
 
   //------------------------------------------------------------------------------------------------
   //! Internal helper functions and types.
@@ -59,6 +103,154 @@ namespace bogart
       return ret;
     }
 
+    // Returns the fixed timestep in seconds, or zero for a variable timestep
+    float get_tick_step_from_cmd_args(const service::cmd_line_args& args)
+    {
+      float hz = args.get_float_option(OPTION_TICK_RATE, 0.0f);
+      return (hz > 0.0f) ? 1.0f / hz : 0.0f;
+    }
+
+    // -fps-cap takes "vsync", "adaptive", "off" or a number of frames per second. F7 cycles through
+    // the modes at runtime, with the number given here or 60 for the cap.
+    frame_pacing get_pacing_from_cmd_args(const service::cmd_line_args& args)
+    {
+      std::string value = args.get_option_value(OPTION_FPS_CAP, "off");
+      frame_pacing pacing;
+      if (value == "vsync") {
+        pacing.mode = PACING_VSYNC;
+      } else if (value == "adaptive") {
+        pacing.mode = PACING_ADAPTIVE_VSYNC;
+      } else if (value != "off") {
+        float fps = args.get_float_option(OPTION_FPS_CAP, 0.0f);
+        if (fps > 0.0f) {
+          pacing.mode = PACING_CAP;
+          pacing.fps_cap = fps;
+        }
+      }
+      return pacing;
+    }
+
+    // Threads the simulation tick runs on, the logic thread included. Defaults to one per core.
+    unsigned int get_worker_threads_from_cmd_args(const service::cmd_line_args& args)
+    {
+      float threads = args.get_float_option(OPTION_WORKER_THREADS, static_cast<float>(std::thread::hardware_concurrency()));
+      return (threads >= 1.0f) ? static_cast<unsigned int>(threads) : 1;
+    }
+
+    // Spawns count actors wandering around Sponza and appends them to actors. The seed is fixed so
+    // that runs are repeatable.
+    void spawn_actors(world::entity_world& w, unsigned int count, std::vector<world::entity>& actors)
+    {
+      std::mt19937 rng(1);
+      std::uniform_real_distribution<float> x(-12.0f, 12.0f);
+      std::uniform_real_distribution<float> y(0.5f, 8.0f);
+      std::uniform_real_distribution<float> z(-5.0f, 5.0f);
+      std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+      std::uniform_real_distribution<float> velocity(1.0f, 3.0f);
+      const unsigned int movements[] = { world::MOVE_FORWARD, world::MOVE_FORWARD | world::STRAFE_LEFT, world::MOVE_FORWARD | world::STRAFE_RIGHT, world::MOVE_BACKWARD };
+      for (unsigned int i = 0; i < count; i++) {
+        world::entity e = w.spawn(glm::vec3(x(rng), y(rng), z(rng)), 0.0f, yaw(rng), velocity(rng));
+        w.set_movement(e, movements[i % 4]);
+        actors.push_back(e);
+      }
+    }
+
+    // Node transform of an actor as last written to the scene mirror: translation to its position
+    // times the rotation of its yaw around the Y axis. Actors don't pitch their models.
+    struct actor_pose
+    {
+      actor_pose() : transform(1.0f), yaw(0.0f), moved(true)
+      {
+
+      }
+
+      glm::mat4 transform;
+      float yaw;                         // the rotation of transform, in degrees
+      bool moved;                        // transform changed since it was last written
+    };
+
+    // Brings the pose up to date with the entity. The rotation is only recomputed when the yaw
+    // changes, which wandering actors never do.
+    void update_actor_pose(const world::entity_world& w, world::entity e, actor_pose& pose)
+    {
+      std::size_t i = w.get_index(e);
+      const world::movement_components& m = w.get_movement_components();
+      if (m.yaw[i] != pose.yaw) {
+        float yaw = glm::radians(m.yaw[i]);
+        float c = std::cos(yaw);
+        float s = std::sin(yaw);
+        pose.transform[0] = glm::vec4(c, 0.0f, -s, 0.0f);
+        pose.transform[2] = glm::vec4(s, 0.0f, c, 0.0f);
+        pose.yaw = m.yaw[i];
+        pose.moved = true;
+      }
+
+      glm::vec4 position(m.x[i], m.y[i], m.z[i], 1.0f);
+      if (position != pose.transform[3]) {
+        pose.transform[3] = position;
+        pose.moved = true;
+      }
+    }
+
+    // Name of the BVH cache of the collision file at path, which is where the content directories
+    // resolved it to. Files with the same name from different places get different caches.
+    std::string get_collision_cache_path(const std::string& cache_dir, const std::string& path)
+    {
+      std::uint64_t hash = 14695981039346656037ull; // 64-bit FNV-1a
+      for (char c : path) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+      }
+
+      std::size_t slash = path.find_last_of('/');
+      std::ostringstream os;
+      os << (cache_dir.empty() ? "" : cache_dir + "/") << path.substr(slash == std::string::npos ? 0 : slash + 1)
+         << "." << std::hex << std::setw(16) << std::setfill('0') << hash << ".bvh";
+      return os.str();
+    }
+
+    // Loads the collision geometry, a Horde3D scene or geometry file found in the content
+    // directories. The BVH is cached in -collision-cache-dir, the working directory by default.
+    // Content directories may be read-only or under version control, so the cache is never written
+    // to one of them: if the cache directory is in one, the BVH is built on every start.
+    bool load_collision(const service::cmd_line_args& args, collision::bvh& b)
+    {
+      std::string content_dir = service::get_content_dir(args);
+      std::string name = args.get_option_value(OPTION_COLLISION, "");
+      std::string path;
+      if (!service::find_content_file(content_dir, name, path)) {
+        log::error("controller: collision geometry not found in the content directories: " + name);
+        return false;
+      }
+
+      collision::triangle_mesh mesh;
+      bool is_scene = (path.size() >= 4 && path.compare(path.size() - 4, 4, ".xml") == 0);
+      if (is_scene ? !collision::load_scene(path, content_dir, mesh) : !collision::load_geo(path, mesh)) {
+        return false;
+      }
+
+      std::string cache_dir = args.get_option_value(OPTION_COLLISION_CACHE, "");
+      bool cached = false;
+      if (service::is_in_content_dir(content_dir, cache_dir)) {
+        log::error("controller: the collision cache directory is in a content directory, not caching the BVH");
+        b.build(mesh);
+      } else {
+        cached = collision::load_or_build(b, mesh, get_collision_cache_path(cache_dir, path));
+      }
+      if (log::is_enabled(log::DEBUG)) {
+        std::ostringstream os;
+        os << "controller: collision BVH " << (cached ? "loaded" : "built") << ", " << b.get_triangle_count()
+           << " triangles, " << b.get_node_count() << " nodes";
+        log::debug(os.str());
+      }
+      return true;
+    }
+
+    // The player is a capsule hanging from the camera
+    collision::capsule get_player_capsule(const glm::vec3& position)
+    {
+      return collision::capsule(position - glm::vec3(0.0f, PLAYER_HEIGHT, 0.0f), position, PLAYER_RADIUS);
+    }
+
     typedef std::map<key_code, view_settings> view_settings_map;
 
     view_settings_map s_view_settings;
@@ -83,18 +275,50 @@ namespace bogart
     controller_impl(
       async::message_queue& m_queue,
       view& view,
+      scene_mirror& scene,
       service::cmd_line_args& cmd_args) :
       m_queue(m_queue),
       m_view(view),
+      m_scene(scene),
       m_cmd_args(cmd_args),
       m_timer(m_queue),
-      m_player(),
+      m_replay_timer(m_queue),
+      m_world(),
+      m_workers(get_worker_threads_from_cmd_args(cmd_args)),
+      m_player_entity(world::INVALID_ENTITY),
+      m_player_camera(),
+      m_actors(),
+      m_actor_nodes(),
+      m_actor_poses(),
+      m_collision(),
       m_settings(get_settings_from_cmd_args(cmd_args)),
+      m_pacing(get_pacing_from_cmd_args(cmd_args)),
       m_is_paused(false),
-      m_stats_enabled(false),
-      m_last_mouse_x(0.0f),
-      m_last_mouse_y(0.0f),
+      m_poll_pending(false),
+      m_pause_start(),
+      m_pause_cpu_start(0),
+      m_snapshot(),
+      m_input(),
       m_stop_watch(),
+      m_tick_step(get_tick_step_from_cmd_args(cmd_args)),
+      m_accumulator(0.0f),
+      m_previous_camera(),
+      m_next_poll(async::timer::clock::now()),
+      m_recorder(),
+      m_replay(),
+      m_replay_index(0),
+      m_replaying(false),
+      m_replay_dt(0.0f),
+      m_input_start(),
+      m_benchmark_path(),
+      m_benchmarking(false),
+      m_benchmark_time(0.0f),
+      m_benchmark_duration(0.0f),
+      m_logic_cpu(),
+      m_input_latency(),
+      m_resources_loaded(false),
+      m_exit_status(EXIT_STATUS_SUCCESS),
+      m_is_finished(false),
       m_state(STATE_INIT_MODEL_WAIT)
     {
 
@@ -104,15 +328,58 @@ namespace bogart
     {
       log::debug("controller: init_model");
       if (m_state == STATE_INIT_MODEL_WAIT) {
-        // Initialize game state
-        m_player.set_position(glm::vec3(12.75f, 2.0f, 0.1f));
-        m_player.set_pitch(12.7f);
-        m_player.set_yaw(88.0f);
-        m_player.set_velocity(7.5f);
+        // Initialize game state. The player is one more entity of the world, the one input acts on.
+        unsigned int actors = static_cast<unsigned int>(m_cmd_args.get_float_option(OPTION_ACTORS, 0.0f));
+        m_world.reserve(actors + 1);
+        m_player_entity = m_world.spawn(glm::vec3(12.75f, 2.0f, 0.1f), 12.7f, 88.0f, PLAYER_VELOCITY);
         m_is_paused = false;
+        spawn_actors(m_world, actors, m_actors);
+        m_actor_nodes.reserve(m_actors.size());
+        m_actor_poses.resize(m_actors.size());
+        {
+          scene_mirror::writer scene = m_scene.begin_update();
+          for (std::size_t i = 0; i < m_actors.size(); i++) {
+            update_actor_pose(m_world, m_actors[i], m_actor_poses[i]);
+            m_actor_poses[i].moved = false;
+            m_actor_nodes.push_back(scene.add_node(m_actor_poses[i].transform, 0));
+          }
+        }
+        if (m_cmd_args.has_option(OPTION_COLLISION) && !load_collision(m_cmd_args, m_collision)) {
+          log::error("controller: could not load collision geometry, moving freely");
+        }
         m_view.async_subscribe_to_events([=](event_vector_ptr events) {
-          process_events(std::move(events));
+          on_events(std::move(events));
+        });
+        m_view.async_subscribe_to_loading([=](const loading_progress& progress) {
+          on_loading_progress(progress);
         });
+        m_view.async_set_frame_pacing(m_pacing);
+
+        // Set up input recording or replay
+        if (m_cmd_args.has_option(OPTION_RECORD)) {
+          m_recorder.open(m_cmd_args.get_option_value(OPTION_RECORD, ""));
+        }
+        if (m_cmd_args.has_option(OPTION_REPLAY)) {
+          m_replaying = service::load_input_log(m_cmd_args.get_option_value(OPTION_REPLAY, ""), m_replay);
+          m_replay_index = 0;
+          log::debug(m_replaying ? "controller: replaying input log" : "controller: could not load input log, using live input");
+        }
+
+        // Set up the benchmark. Without a valid path there is nothing to measure, so we don't even
+        // open the view.
+        if (m_cmd_args.has_option(OPTION_BENCHMARK)) {
+          if (!m_benchmark_path.load(m_cmd_args.get_option_value(OPTION_BENCHMARK, ""))) {
+            log::error("controller: could not load benchmark camera path, aborting");
+            m_exit_status = EXIT_STATUS_FAILURE;
+            m_state = STATE_FAILURE;
+            m_is_finished = true;
+            return;
+          }
+          m_benchmarking = true;
+          m_benchmark_time = 0.0f;
+          m_benchmark_duration = m_cmd_args.get_float_option(OPTION_BENCHMARK_DURATION, m_benchmark_path.get_duration());
+          m_logic_cpu.reset();
+        }
 
         m_state = STATE_OPEN_VIEW_WAIT;
       }
@@ -139,13 +406,14 @@ namespace bogart
         if (is_window_open) {
           m_state = STATE_VIEW_OPENED;
           m_settings = current_settings;
-          m_last_mouse_x = m_settings.window_width / 2.0f;
-          m_last_mouse_y = m_settings.window_height / 2.0f;
+          m_input.reset_mouse(m_settings.window_width / 2.0f, m_settings.window_height / 2.0f);
           m_queue.post(async::make_callable([=](){ set_up(); }));
-          m_queue.post(async::make_callable([=](){ poll(); }));
+          schedule_poll();
         } else {
           log::error("controller: could not open view, aborting");
+          m_exit_status = EXIT_STATUS_FAILURE;
           m_state = STATE_FAILURE;
+          m_is_finished = true;
         }
       }
     }
@@ -156,102 +424,467 @@ namespace bogart
       if (m_state == STATE_VIEW_OPENED) {
         m_view.async_set_up();
         m_stop_watch.start();
+        m_accumulator = 0.0f;
+        m_previous_camera = get_player_camera();
+        m_next_poll = async::timer::clock::now();
         m_state = STATE_CONTROLLING;
+
+        // Input times are relative to the moment we first started controlling, so they keep
+        // counting when the view is reopened. A replay stopped by a reopening resumes where it was.
+        if (m_input_start == async::timer::time_point()) {
+          m_input_start = async::timer::clock::now();
+        }
+        if (m_replaying && m_replay_index < m_replay.size()) {
+          schedule_replay();
+        }
       }
     }
 
-    void process_events(event_vector_ptr events)
-    {
-      for (event_it it = events->begin(); it != events->end(); it++) {
-        auto event = *it;
-        if (event.type == EVENT_KEY_PRESS) {
-          if (event.value == KEY_F6) {
-            // F6 toggles stats
-            m_stats_enabled = !m_stats_enabled;
-            m_view.async_set_stats_enabled(m_stats_enabled);
-          } else if (event.value == KEY_ESCAPE) {
-            // ESCAPE exits the application
-            m_queue.post(async::make_callable([=](){ tear_down(); }));
-            m_queue.post(async::make_callable([=](){ close_view(); }));
-          } else if (event.value == KEY_SPACE) {
-            // SPACE pauses the simulation
-            m_is_paused = ~m_is_paused;
-          } else if (event.value == KEY_W) {
-            // W moves forward
-            m_player.start_moving_forward();
-          } else if (event.value == KEY_S) {
-            // S moves backward
-            m_player.start_moving_backward();
-          } else if (event.value == KEY_A) {
-            // A strafes left
-            m_player.start_strafing_left();
-          } else if (event.value == KEY_D) {
-            // D strafes right
-            m_player.start_strafing_right();
+    // The loading screen follows m_snapshot.loading. The benchmark doesn't start until everything
+    // is loaded, so that it measures the scene and not the loader.
+    void on_loading_progress(const loading_progress& progress)
+    {
+      m_snapshot.loading = progress.get_fraction();
+      if (progress.done && !m_resources_loaded) {
+        log::debug("controller: view resources loaded");
+        m_resources_loaded = true;
+        m_snapshot.record_frame_times = m_benchmarking;
+      }
+
+      // Paused worlds don't publish on their own
+      if (m_state == STATE_CONTROLLING && m_is_paused) {
+        publish_snapshot();
+      }
+    }
+
+    void on_events(event_vector_ptr events)
+    {
+      // Live input is ignored while replaying. Input from before we started controlling has no
+      // time origin to be recorded against, and there is nothing to control yet, so it's dropped.
+      if (m_replaying || m_input_start == async::timer::time_point()) {
+        return;
+      }
+
+      if (m_recorder.is_open() && !events->empty()) {
+        m_recorder.write(get_input_time(), *events);
+      }
+
+      record_input_latency(*events);
+      process_events(*events);
+    }
+
+    // Measures how long live input took to get from the window system to us. The oldest event in
+    // the batch waited the longest.
+    void record_input_latency(const event_vector& events)
+    {
+      if (events.empty() || events.front().time == event::clock::time_point()) {
+        return;
+      }
+
+      event::clock::duration latency = event::clock::now() - events.front().time;
+      m_input_latency.record(latency);
+      m_snapshot.metrics.input_latency = std::max(m_snapshot.metrics.input_latency,
+                                                  std::chrono::duration<float>(latency).count());
+    }
+
+    // Microseconds since we started controlling, for the input log
+    std::uint64_t get_input_time() const
+    {
+      std::chrono::microseconds t = std::chrono::duration_cast<std::chrono::microseconds>(async::timer::clock::now() - m_input_start);
+      return (t.count() > 0) ? t.count() : 0;
+    }
+
+    void schedule_replay()
+    {
+      if (m_replay_index >= m_replay.size()) {
+        // The replay is over, exit like ESCAPE would
+        log::debug("controller: replay finished");
+        quit();
+        return;
+      }
+
+      // Replayed ticks measure their lateness against the record's deadline
+      if (m_cmd_args.has_option(OPTION_REPLAY_FAST)) {
+        m_next_poll = async::timer::clock::now();
+        m_queue.post(async::make_callable([=](){ replay_next(); }));
+      } else {
+        m_next_poll = m_input_start + std::chrono::microseconds(m_replay[m_replay_index].time);
+        m_replay_timer.async_wait(m_next_poll, async::make_callable([=](){ replay_next(); }));
+      }
+    }
+
+    void replay_next()
+    {
+      // A view reopening stops the replay, set_up() resumes it. Ticks run with the timestep they
+      // had when recording, so the simulation goes through the same states.
+      if (m_state == STATE_CONTROLLING) {
+        const service::input_batch& batch = m_replay[m_replay_index++];
+        if (batch.type == service::INPUT_RECORD_TICK) {
+          m_replay_dt = batch.dt;
+          poll();
+        } else {
+          process_events(batch.events);
+        }
+        schedule_replay();
+      }
+    }
+
+    void process_events(const event_vector& events)
+    {
+      // Fold the whole batch first. Nothing below allocates unless a key that changes the
+      // controller state was pressed.
+      m_input.process(events);
+
+      const service::input_state::key_code_vector& presses = m_input.get_presses();
+      for (service::input_state::key_code_vector::const_iterator it = presses.begin(); it != presses.end(); it++) {
+        if (*it == KEY_F6) {
+          // F6 toggles stats
+          m_snapshot.stats_enabled = !m_snapshot.stats_enabled;
+          m_view.publish(m_snapshot);
+        } else if (*it == KEY_F7) {
+          // F7 cycles through the frame pacing modes
+          m_pacing.mode = static_cast<pacing_mode>((m_pacing.mode + 1) % PACING_MODE_COUNT);
+          m_view.async_set_frame_pacing(m_pacing);
+          log::debug(std::string("controller: frame pacing set to ") + get_pacing_mode_name(m_pacing.mode));
+        } else if (*it == KEY_ESCAPE) {
+          // ESCAPE exits the application. An interrupted benchmark is a failed one.
+          if (m_benchmarking) {
+            log::error("controller: benchmark interrupted");
+            m_benchmarking = false;
+            m_exit_status = EXIT_STATUS_FAILURE;
+          }
+          quit();
+        } else if (*it == KEY_SPACE) {
+          // SPACE pauses the simulation
+          m_is_paused = !m_is_paused;
+          if (m_is_paused) {
+            pause();
           } else {
-            // F1 through F5 change video modes
-            fill_view_settings_map();
-            auto it = s_view_settings.find(event.value);
-            if (it != s_view_settings.end()) {
-              m_settings = it->second;
-              m_queue.post(async::make_callable([=](){ tear_down(); }));
-              m_queue.post(async::make_callable([=](){ close_view(); }));
-              m_queue.post(async::make_callable([=](){ open_view(); }));
-            }
+            resume();
           }
-        } else if (event.type == EVENT_KEY_RELEASE) {
-          if (event.value == KEY_W || event.value == KEY_S) {
-            m_player.stop_moving_forward_back();
-          } else if (event.value == KEY_A || event.value == KEY_D) {
-            m_player.stop_strafing();
+        } else {
+          // F1 through F5 change video modes
+          fill_view_settings_map();
+          auto vit = s_view_settings.find(*it);
+          if (vit != s_view_settings.end()) {
+            change_video_mode(vit->second);
           }
-        } else if (event.type == EVENT_MOUSE_MOVE) {
-          // Yaw rotates the camera around the Y axis counter-clockwise. Mouse X coordinates increase
-          // to the right, so we use mouse motion to substract from yaw.
-          float d_yaw = 0.1f * (event.mouse_x - m_last_mouse_x);
-          m_last_mouse_x = event.mouse_x;
-          m_player.set_yaw(m_player.get_yaw() - d_yaw);
-
-          // Pitch rotates the camera around the X axis counter-clockwise. Mouse Y coordinates
-          // increase down, so we use mouse motion to add to yaw.
-          float d_pitch = 0.1f * (m_last_mouse_y - event.mouse_y);
-          m_last_mouse_y = event.mouse_y;
-          m_player.set_pitch(m_player.get_pitch() + d_pitch);
-
-          m_player.log_status();
         }
       }
+
+      // W and S move forward and backward, A and D strafe left and right. Holding both keys of a
+      // pair cancels the motion along that axis.
+      bool w = m_input.is_key_down(KEY_W);
+      bool s = m_input.is_key_down(KEY_S);
+      bool a = m_input.is_key_down(KEY_A);
+      bool d = m_input.is_key_down(KEY_D);
+      m_world.set_movement(m_player_entity, (w && !s ? world::MOVE_FORWARD : world::MOVE_NONE) |
+                                            (s && !w ? world::MOVE_BACKWARD : world::MOVE_NONE) |
+                                            (d && !a ? world::STRAFE_RIGHT : world::MOVE_NONE) |
+                                            (a && !d ? world::STRAFE_LEFT : world::MOVE_NONE));
+
+      float dx = m_input.get_mouse_dx();
+      float dy = m_input.get_mouse_dy();
+      if (dx != 0.0f || dy != 0.0f) {
+        // Yaw rotates the camera around the Y axis counter-clockwise. Mouse X coordinates increase
+        // to the right, so we use mouse motion to substract from yaw. Pitch rotates the camera
+        // around the X axis counter-clockwise. Mouse Y coordinates increase down, so we use mouse
+        // motion to add to yaw.
+        set_player_orientation(m_world.get_pitch(m_player_entity) - 0.1f * dy, m_world.get_yaw(m_player_entity) - 0.1f * dx);
+        log_player_status();
+      }
+
+      // While paused nothing else publishes, so show what input changed. Empty batches change
+      // nothing, and skipping them keeps an idle view from waking up for nothing.
+      if (m_is_paused && !events.empty() && m_state == STATE_CONTROLLING) {
+        publish_snapshot();
+      }
     }
 
-    void update_simulation()
+    // Writes the actors that moved to the scene mirror in one batch. Their transforms are brought
+    // up to date on the workers first, so the render thread only waits for the copies.
+    void update_scene()
     {
-      if (!m_is_paused) {
-        m_stop_watch.update();
-        float dt = m_stop_watch.get_dt();
-        m_player.update(dt);
+      m_workers.parallel_for(0, m_actors.size(), SCENE_GRAIN, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+          update_actor_pose(m_world, m_actors[i], m_actor_poses[i]);
+        }
+      });
+
+      scene_mirror::writer scene = m_scene.begin_update();
+      for (std::size_t i = 0; i < m_actors.size(); i++) {
+        if (m_actor_poses[i].moved) {
+          scene.set_transform(m_actor_nodes[i], m_actor_poses[i].transform);
+          m_actor_poses[i].moved = false;
+        }
       }
     }
 
+    // Ticks stop while paused. The next poll publishes an idle snapshot and doesn't schedule
+    // another one.
+    void pause()
+    {
+      log::debug("controller: pause");
+      m_pause_start = async::timer::clock::now();
+      m_pause_cpu_start = std::clock();
+    }
+
+    void resume()
+    {
+      if (log::is_enabled(log::DEBUG)) {
+        double seconds = std::chrono::duration<double>(async::timer::clock::now() - m_pause_start).count();
+        double cpu_seconds = static_cast<double>(std::clock() - m_pause_cpu_start) / CLOCKS_PER_SEC;
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(3) << "controller: resume after " << seconds << " s paused, process CPU "
+           << cpu_seconds << " s (" << std::setprecision(1) << ((seconds > 0.0) ? 100.0 * cpu_seconds / seconds : 0.0)
+           << "% of a core)";
+        log::debug(os.str());
+      }
+
+      // The pause must not show up as a long dt, nor mouse look during it as a smooth turn
+      m_stop_watch.update();
+      m_previous_camera = get_player_camera();
+      m_snapshot.idle = false;
+      m_next_poll = async::timer::clock::now();
+      if (m_state == STATE_CONTROLLING) {
+        schedule_poll();
+      }
+    }
+
+    // While replaying, ticks are driven by the log
+    void schedule_poll()
+    {
+      if (!m_poll_pending && !m_replaying) {
+        m_poll_pending = true;
+        m_next_poll = async::timer::clock::now();
+        m_queue.post(async::make_callable([=](){ poll(); }));
+      }
+    }
+
+    void publish_snapshot()
+    {
+      camera_state current = get_player_camera();
+      if (m_tick_step == 0.0f || m_is_paused) {
+        m_snapshot.camera = camera_update(current, current, 1.0f, 0.0f);
+      } else {
+        m_snapshot.camera = camera_update(m_previous_camera, current, m_accumulator / m_tick_step, m_tick_step);
+      }
+      m_snapshot.idle = m_is_paused;
+      m_view.publish(m_snapshot);
+      m_snapshot.metrics.input_latency = 0.0f;
+    }
+
+    // Changes the video mode in place if the view can, otherwise reopens the view with it
+    void change_video_mode(const view_settings& target)
+    {
+      open_args_ptr args = std::make_unique<open_args>();
+      args->settings = target;
+      args->handler = make_open_handler([=](bool is_changed, const view_settings& current_settings) {
+        on_change_video_mode_result(is_changed, current_settings, target);
+      });
+      m_view.async_change_video_mode(std::move(args));
+    }
+
+    void on_change_video_mode_result(bool is_changed, const view_settings& current_settings, const view_settings& target)
+    {
+      log::debug("controller: on_change_video_mode_result");
+      if (m_state == STATE_CONTROLLING) {
+        if (is_changed) {
+          m_settings = current_settings;
+          return;
+        }
+
+        m_settings = target;
+        m_queue.post(async::make_callable([=](){ tear_down(); }));
+        m_queue.post(async::make_callable([=](){ close_view(); }));
+        m_queue.post(async::make_callable([=](){ open_view(); }));
+      }
+    }
+
+    // Real time since the last tick, or the recorded one when replaying
+    float get_tick_dt()
+    {
+      // Keep the stop watch running while paused so that the pause doesn't show up as a long dt
+      m_stop_watch.update();
+      float dt = m_replaying ? m_replay_dt : m_stop_watch.get_dt();
+      if (m_recorder.is_open()) {
+        m_recorder.write_tick(get_input_time(), dt);
+      }
+      return dt;
+    }
+
+    void update_simulation(float dt)
+    {
+      if (m_is_paused) {
+        return;
+      }
+
+      if (m_tick_step == 0.0f) {
+        step_world(dt);
+        return;
+      }
+
+      // Fixed timestep: consume the real time that passed in steps of m_tick_step, keeping the
+      // remainder for the next tick
+      m_accumulator += std::min(dt, MAX_FRAME_TIME);
+      while (m_accumulator >= m_tick_step) {
+        m_previous_camera = get_player_camera();
+        step_world(m_tick_step);
+        m_accumulator -= m_tick_step;
+      }
+    }
+
+    // Advances the world dt seconds. The player follows the benchmark path if there is one.
+    void step_world(float dt)
+    {
+      if (m_benchmarking) {
+        m_benchmark_time += m_resources_loaded ? dt : 0.0f;
+        camera_keyframe k = m_benchmark_path.evaluate(m_benchmark_time);
+        m_world.set_position(m_player_entity, k.position);
+        m_world.set_movement(m_player_entity, world::MOVE_NONE);
+        set_player_orientation(k.pitch, k.yaw);
+      }
+
+      glm::vec3 start = m_world.get_position(m_player_entity);
+      m_world.update(dt, m_workers);
+
+      // The benchmark path goes wherever it likes, everybody else slides along the walls
+      if (!m_benchmarking && !m_collision.is_empty()) {
+        m_world.set_position(m_player_entity, slide(start, m_world.get_position(m_player_entity)));
+      }
+    }
+
+    // Turns the player. The camera rotation is rebuilt the next time the camera is read, once
+    // however many turns there were in between.
+    void set_player_orientation(float pitch, float yaw)
+    {
+      m_world.set_pitch(m_player_entity, pitch);
+      m_world.set_yaw(m_player_entity, yaw);
+    }
+
+    camera_state get_player_camera()
+    {
+      return m_player_camera.get(m_world, m_player_entity);
+    }
+
+    void log_player_status() const
+    {
+      // Don't pay for the formatting when nobody is going to see it
+      if (!log::is_enabled(log::DEBUG)) {
+        return;
+      }
+
+      glm::vec3 p = m_world.get_position(m_player_entity);
+      std::ostringstream os;
+      os << std::setprecision(2) << std::fixed << "Position: " << p.x << ", " << p.y << ", " << p.z
+         << ", pitch: " << m_world.get_pitch(m_player_entity) << ", yaw: " << m_world.get_yaw(m_player_entity);
+      log::debug(os.str());
+    }
+
+    // Moves the player capsule from start towards end, removing the part of the motion that goes
+    // into whatever it hits
+    glm::vec3 slide(const glm::vec3& start, const glm::vec3& end)
+    {
+      glm::vec3 position = start;
+      glm::vec3 motion = end - start;
+      for (unsigned int i = 0; i < MAX_SLIDE_ITERATIONS && glm::dot(motion, motion) > 0.0f; i++) {
+        collision::sweep_hit hit;
+        if (!m_collision.sweep_capsule(get_player_capsule(position), motion, hit)) {
+          return position + motion;
+        }
+        position += motion * hit.t;
+        motion *= 1.0f - hit.t;
+        motion -= hit.normal * glm::dot(motion, hit.normal);
+      }
+      return position;
+    }
+
+    void finish_benchmark()
+    {
+      log::debug("controller: benchmark finished");
+      m_benchmarking = false;
+      m_snapshot.record_frame_times = false;
+      m_view.publish(m_snapshot);
+      m_view.async_collect_frame_times([=](const render_frame_times& times) {
+        on_frame_times(times);
+      });
+    }
+
+    void on_frame_times(const render_frame_times& times)
+    {
+      frame_report report;
+      report.path_file = m_cmd_args.get_option_value(OPTION_BENCHMARK, "");
+      report.duration = m_benchmark_time;
+      report.metrics.push_back(frame_report_metric("logic_cpu", m_logic_cpu));
+      report.metrics.push_back(frame_report_metric("render_cpu", times.cpu));
+      report.metrics.push_back(frame_report_metric("frame_interval", times.interval));
+
+      if (!write_frame_report(m_cmd_args.get_option_value(OPTION_BENCHMARK_REPORT, "benchmark_report.json"), report)) {
+        m_exit_status = EXIT_STATUS_FAILURE;
+      } else if (m_cmd_args.has_option(OPTION_BENCHMARK_MAX_P99)) {
+        // The gate is on the frame interval, which is what the user sees
+        float max_p99 = m_cmd_args.get_float_option(OPTION_BENCHMARK_MAX_P99, 0.0f);
+        float p99 = std::chrono::duration<float, std::milli>(times.interval.get_percentile(99.0)).count();
+        if (times.interval.get_count() == 0 || p99 > max_p99) {
+          log::error("controller: benchmark frame interval p99 over the limit");
+          m_exit_status = EXIT_STATUS_BENCHMARK_TOO_SLOW;
+        }
+      }
+
+      // Exit like ESCAPE would
+      quit();
+    }
+
     void poll()
     {
+      m_poll_pending = false;
       if (m_state == STATE_CONTROLLING) {
+        async::timer::time_point start = async::timer::clock::now();
+        service::thread_cpu_clock::time_point cpu_start = service::thread_cpu_clock::now();
+        bool benchmarking = m_benchmarking && m_resources_loaded;
+
         // Update model
-        update_simulation();
+        update_simulation(get_tick_dt());
+        update_scene();
+
+        // Update view. The snapshot carries the duration of the previous tick, since this one
+        // isn't over yet.
+        m_snapshot.metrics.timer_lateness = std::chrono::duration<float>(start - m_next_poll).count();
+        publish_snapshot();
+        m_snapshot.metrics.tick_time = std::chrono::duration<float>(async::timer::clock::now() - start).count();
+
+        if (benchmarking) {
+          m_logic_cpu.record(service::thread_cpu_clock::now() - cpu_start);
+          if (m_benchmark_time >= m_benchmark_duration) {
+            finish_benchmark();
+          }
+        }
 
-        // Update view
-        glm::vec3 pos = m_player.get_position();
-        float pitch = m_player.get_pitch();
-        float yaw = m_player.get_yaw();
-        m_view.async_update_camera(pos.x, pos.y, pos.z, pitch, yaw);
+        // Paused worlds don't tick, resume() starts polling again. Replays tick from the log.
+        if (m_is_paused || m_replaying) {
+          return;
+        }
 
-        // We schedule the poll method every 15 milliseconds. In practice this gives us a dt of
-        // around 15.50 milliseconds (as returned by m_stop_watch.get_dt())
+        // With a variable timestep we schedule the poll method every 15 milliseconds. In practice
+        // this gives us a dt of around 15.50 milliseconds (as returned by m_stop_watch.get_dt()).
+        // With a fixed timestep we poll once per step, on deadlines that don't drift.
         m_state = STATE_CONTROLLING;
-        async::timer::time_point now = std::chrono::high_resolution_clock::now();
-        m_timer.async_wait(now + std::chrono::milliseconds(15), async::make_callable([=](){ poll(); }));
+        async::timer::time_point now = async::timer::clock::now();
+        if (m_tick_step == 0.0f) {
+          m_next_poll = now + std::chrono::milliseconds(15);
+        } else {
+          m_next_poll = std::max(m_next_poll + tick_duration(), now);
+        }
+        m_poll_pending = true;
+        m_timer.async_wait(m_next_poll, async::make_callable([=](){ poll(); }));
       }
     }
 
+    async::timer::duration tick_duration()
+    {
+      return std::chrono::duration_cast<async::timer::duration>(std::chrono::duration<float>(m_tick_step));
+    }
+
     void tear_down()
     {
       log::debug("controller: tear_down");
@@ -274,9 +907,33 @@ namespace bogart
     void fin_model()
     {
       log::debug("controller: fin_model");
+      if (m_input_latency.get_count() != 0) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(3) << "controller: input latency p50 "
+           << std::chrono::duration<float, std::milli>(m_input_latency.get_percentile(50.0)).count() << " ms, p99 "
+           << std::chrono::duration<float, std::milli>(m_input_latency.get_percentile(99.0)).count() << " ms";
+        log::debug(os.str());
+      }
+      if (m_replaying && log::is_enabled(log::DEBUG)) {
+        // Replays are deterministic, so two runs of the same log must print the same state
+        glm::vec3 p = m_world.get_position(m_player_entity);
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(4) << "controller: replay ended at position (" << p.x << ", " << p.y
+           << ", " << p.z << "), pitch " << m_world.get_pitch(m_player_entity) << ", yaw " << m_world.get_yaw(m_player_entity);
+        log::debug(os.str());
+      }
       if (m_state == STATE_OPEN_VIEW_WAIT) {
         m_state = STATE_INIT_MODEL_WAIT;
       }
+      m_is_finished = true;
+    }
+
+    // Closes the view and lets the application exit
+    void quit()
+    {
+      m_queue.post(async::make_callable([=](){ tear_down(); }));
+      m_queue.post(async::make_callable([=](){ close_view(); }));
+      m_queue.post(async::make_callable([=](){ fin_model(); }));
     }
 
     //----------------------------------------------------------------------------------------------
@@ -284,15 +941,46 @@ namespace bogart
     //----------------------------------------------------------------------------------------------
     async::message_queue& m_queue;
     view& m_view;
+    scene_mirror& m_scene;               // actors, as seen by the view
     service::cmd_line_args& m_cmd_args;
     async::timer m_timer;
-    fps_actor m_player;
+    async::timer m_replay_timer;
+    world::entity_world m_world;
+    async::worker_pool m_workers;        // runs chunks of the simulation tick
+    world::entity m_player_entity;
+    player_camera m_player_camera;       // of the player entity
+    std::vector<world::entity> m_actors;
+    std::vector<std::uint32_t> m_actor_nodes; // scene mirror node of each actor
+    std::vector<actor_pose> m_actor_poses; // transform of each actor's node
+    collision::bvh m_collision;          // empty if collisions are disabled
     view_settings m_settings; // desired view settings (may or may not be what is currently set on the view)
+    frame_pacing m_pacing;
     bool m_is_paused;
-    bool m_stats_enabled;
-    float m_last_mouse_x;
-    float m_last_mouse_y;
+    bool m_poll_pending;                 // whether a call to poll() is posted or scheduled
+    async::timer::time_point m_pause_start;
+    std::clock_t m_pause_cpu_start;      // process CPU time when the pause started
+    world_snapshot m_snapshot; // last snapshot published to the view
+    service::input_state m_input;
     stop_watch m_stop_watch;
+    float m_tick_step;                   // fixed timestep in seconds, zero for a variable timestep
+    float m_accumulator;                 // simulation time not consumed yet, in seconds
+    camera_state m_previous_camera;      // player state before the last fixed step
+    async::timer::time_point m_next_poll;
+    service::input_recorder m_recorder;
+    service::input_batch_vector m_replay;
+    size_t m_replay_index;               // next batch to replay
+    bool m_replaying;
+    float m_replay_dt;                   // timestep of the tick being replayed, in seconds
+    async::timer::time_point m_input_start; // time origin of recorded and replayed input
+    camera_path m_benchmark_path;
+    bool m_benchmarking;
+    float m_benchmark_time;              // simulation time spent on the benchmark path, in seconds
+    float m_benchmark_duration;          // in seconds
+    async::latency_histogram m_logic_cpu; // CPU time of each tick while benchmarking
+    async::latency_histogram m_input_latency; // time live input took to reach the logic thread
+    bool m_resources_loaded;             // whether the view finished loading its resources
+    std::atomic<int> m_exit_status;
+    std::atomic<bool> m_is_finished;     // set once the view is closed for good
     controller_state m_state;
   }; // class controller::controller_impl
 
@@ -302,8 +990,9 @@ namespace bogart
   controller::controller(
     async::message_queue& m_queue,
     view& view,
+    scene_mirror& scene,
     service::cmd_line_args& args) :
-    impl(std::make_unique<controller::controller_impl>(m_queue, view, args)) {
+    impl(std::make_unique<controller::controller_impl>(m_queue, view, scene, args)) {
 
   }
 
@@ -317,4 +1006,14 @@ namespace bogart
     impl->m_queue.post(async::make_callable([&i = *impl](){ i.open_view(); }));
     // Rest of the flow is scheduled from on_open_view_result(), after the window is opened
   }
+
+  int controller::get_exit_status() const
+  {
+    return impl->m_exit_status;
+  }
+
+  bool controller::is_finished() const
+  {
+    return impl->m_is_finished;
+  }
 } // namespace bogart
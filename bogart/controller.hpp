@@ -3,6 +3,7 @@
 
 #include "bogart/service/cmd_line_args.hpp"
 #include "bogart/async/message_queue.hpp"
+#include "bogart/scene_mirror.hpp"
 #include "bogart/view.hpp"
 
 #include <memory>
@@ -25,7 +26,7 @@ namespace bogart
     //----------------------------------------------------------------------------------------------
     //! Constructor
     //----------------------------------------------------------------------------------------------
-    controller(async::message_queue& logic_queue, view& view, service::cmd_line_args& args);
+    controller(async::message_queue& logic_queue, view& view, scene_mirror& scene, service::cmd_line_args& args);
 
     //----------------------------------------------------------------------------------------------
     //! Destructor
@@ -37,6 +38,18 @@ namespace bogart
     //----------------------------------------------------------------------------------------------
     void async_call();
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the status the process should exit with: non-zero if the view could not be
+    //!  opened or a benchmark failed.
+    //----------------------------------------------------------------------------------------------
+    int get_exit_status() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns true once the controller has closed the view for good (or failed to open
+    //!  it). The message queues may go quiet before that, for instance while the world is paused.
+    //----------------------------------------------------------------------------------------------
+    bool is_finished() const;
+
   private:
     class controller_impl;                            //!< implementation class (Pimpl idiom)
     std::unique_ptr<controller_impl> impl;            //!< pointer to implementation (Pimpl idiom)
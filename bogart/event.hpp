@@ -2,6 +2,7 @@
 #define EVENT_HPP
 
 #include <functional>
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -149,14 +150,22 @@ namespace bogart
 
   struct event
   {
+    typedef std::chrono::steady_clock clock;
+
     event() :
-      type(EVENT_KEY_PRESS), value(KEY_UNKNOWN), mouse_x(0.0f), mouse_y(0.0f)
+      type(EVENT_KEY_PRESS), value(KEY_UNKNOWN), mouse_x(0.0f), mouse_y(0.0f), time()
     {
 
     }
 
     event(event_type type, key_code value, float mouse_x, float mouse_y) :
-      type(type), value(value), mouse_x(mouse_x), mouse_y(mouse_y)
+      type(type), value(value), mouse_x(mouse_x), mouse_y(mouse_y), time()
+    {
+
+    }
+
+    event(event_type type, key_code value, float mouse_x, float mouse_y, clock::time_point time) :
+      type(type), value(value), mouse_x(mouse_x), mouse_y(mouse_y), time(time)
     {
 
     }
@@ -165,6 +174,7 @@ namespace bogart
     key_code value;
     float mouse_x;
     float mouse_y;
+    clock::time_point time; // when the window system handed us the event, if known
   };
 
   typedef std::vector<event> event_vector;
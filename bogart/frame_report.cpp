@@ -0,0 +1,108 @@
+#include "bogart/frame_report.hpp"
+#include "bogart/log/log.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    double to_ms(async::latency_histogram::duration d)
+    {
+      return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    bool ends_with(const std::string& s, const std::string& suffix)
+    {
+      return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Writes s as a JSON string literal, quotes included
+    void write_json_string(std::ofstream& out, const std::string& s)
+    {
+      out << '"';
+      for (std::string::const_iterator it = s.begin(); it != s.end(); it++) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c == '"' || c == '\\') {
+          out << '\\' << *it;
+        } else if (c < 0x20) {
+          std::ios::fmtflags flags = out.flags();
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+          out.flags(flags);
+          out << std::setfill(' ');
+        } else {
+          out << *it;
+        }
+      }
+      out << '"';
+    }
+
+    void write_csv(std::ofstream& out, const frame_report& report)
+    {
+      out << "metric,count,min_ms,mean_ms,stddev_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+      for (frame_report_metric_vector::const_iterator it = report.metrics.begin(); it != report.metrics.end(); it++) {
+        const async::latency_histogram& h = it->values;
+        out << it->name << ","
+            << h.get_count() << ","
+            << to_ms(h.get_min()) << ","
+            << to_ms(h.get_mean()) << ","
+            << to_ms(h.get_stddev()) << ","
+            << to_ms(h.get_percentile(50.0)) << ","
+            << to_ms(h.get_percentile(95.0)) << ","
+            << to_ms(h.get_percentile(99.0)) << ","
+            << to_ms(h.get_max()) << "\n";
+      }
+    }
+
+    void write_json(std::ofstream& out, const frame_report& report)
+    {
+      out << "{\n"
+          << "  \"path\": ";
+      write_json_string(out, report.path_file);
+      out << ",\n"
+          << "  \"duration_s\": " << report.duration << ",\n"
+          << "  \"metrics\": {";
+      for (frame_report_metric_vector::const_iterator it = report.metrics.begin(); it != report.metrics.end(); it++) {
+        const async::latency_histogram& h = it->values;
+        out << (it == report.metrics.begin() ? "\n" : ",\n") << "    ";
+        write_json_string(out, it->name);
+        out << ": {"
+            << "\"count\": " << h.get_count()
+            << ", \"min_ms\": " << to_ms(h.get_min())
+            << ", \"mean_ms\": " << to_ms(h.get_mean())
+            << ", \"stddev_ms\": " << to_ms(h.get_stddev())
+            << ", \"p50_ms\": " << to_ms(h.get_percentile(50.0))
+            << ", \"p95_ms\": " << to_ms(h.get_percentile(95.0))
+            << ", \"p99_ms\": " << to_ms(h.get_percentile(99.0))
+            << ", \"max_ms\": " << to_ms(h.get_max())
+            << "}";
+      }
+      out << "\n  }\n}\n";
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool write_frame_report(const std::string& path, const frame_report& report)
+  {
+    std::ofstream out(path.c_str(), std::ios::trunc);
+    if (!out) {
+      log::error(std::string("Could not open benchmark report for writing: ") + path);
+      return false;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    if (ends_with(path, ".csv")) {
+      write_csv(out, report);
+    } else {
+      write_json(out, report);
+    }
+
+    return static_cast<bool>(out);
+  }
+} // namespace bogart
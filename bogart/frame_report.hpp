@@ -0,0 +1,51 @@
+#ifndef FRAME_REPORT_HPP
+#define FRAME_REPORT_HPP
+
+#include "bogart/async/latency_histogram.hpp"
+
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+  struct frame_report_metric
+  {
+    frame_report_metric() : name(), values()
+    {
+
+    }
+
+    frame_report_metric(const std::string& name, const async::latency_histogram& values) :
+      name(name), values(values)
+    {
+
+    }
+
+    std::string name;
+    async::latency_histogram values;
+  };
+
+  typedef std::vector<frame_report_metric> frame_report_metric_vector;
+
+  struct frame_report
+  {
+    frame_report() : path_file(), duration(0.0f), metrics()
+    {
+
+    }
+
+    std::string path_file;              // camera path the benchmark ran
+    float duration;                     // in seconds of simulation time
+    frame_report_metric_vector metrics;
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Writes a benchmark report with the count, min, mean, standard deviation, p50, p95, p99
+  //!  and max of each metric, in milliseconds. Paths ending in ".csv" get a CSV file with one row
+  //!  per metric, any other path gets a JSON file.
+  //! @return false if the file can't be written.
+  //------------------------------------------------------------------------------------------------
+  bool write_frame_report(const std::string& path, const frame_report& report);
+} // namespace bogart
+
+#endif // FRAME_REPORT_HPP
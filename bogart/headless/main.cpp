@@ -0,0 +1,80 @@
+#include "bogart/service/cmd_line_args.hpp"
+#include "bogart/async/message_queue.hpp"
+#include "bogart/async/timer.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/controller.hpp"
+#include "bogart/null_view.hpp"
+#include "bogart/log/log.hpp"
+
+#include <iostream>
+#include <thread>
+
+// Runs the controller and the simulation without a window or OpenGL context, for example on a
+// build machine without a GPU. It takes the same options as bogart, and -headless-fps sets the
+// simulated frame rate. Runs only end when a benchmark or an input replay does:
+// $ cd bogart/build/bogart/headless
+// $ ./bogart_headless -content-dir ../../../resources -tick-rate 60 -benchmark ../../../resources/paths/sponza_flythrough.path
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  bogart::service::cmd_line_args args(argc, argv);
+
+  // Set log level
+  if (args.has_option("-debug")) {
+    bogart::log::set_log_level(bogart::log::DEBUG);
+  }
+
+  // Select timer backend
+  if (args.get_option_value("-timer-backend", "") == "timerfd") {
+    bogart::async::set_timer_backend(bogart::async::TIMER_BACKEND_TIMERFD);
+  }
+
+  // Create message queues
+  bogart::async::message_queue render_queue;
+  bogart::async::message_queue logic_queue;
+
+  // Trade some spinning for timing accuracy if requested
+  if (args.has_option("-high-precision")) {
+    bogart::async::set_timer_high_precision(true);
+    render_queue.set_high_precision(true);
+    logic_queue.set_high_precision(true);
+  }
+
+  // The scene the controller writes and the view consumes
+  bogart::scene_mirror scene;
+
+  // View and controller
+  bogart::null_view view(render_queue, logic_queue, scene, args);
+  bogart::controller controller(logic_queue, view, scene, args);
+  controller.async_call();
+
+  // Start the logic thread. The queues go quiet while the world is paused, so each loop keeps
+  // running until the controller is done and then drains what is left.
+  std::thread logic_thread([&]() {
+    do {
+      logic_queue.run(std::chrono::seconds(1));
+    } while (!controller.is_finished());
+  });
+
+  // Run render loop
+  do {
+    render_queue.run(std::chrono::seconds(1));
+  } while (!controller.is_finished());
+
+  logic_thread.join();
+
+  bogart::null_view_stats stats = view.get_stats();
+  std::cout << "headless view: " << stats.frames << " frames, "
+            << stats.publishes << " snapshots published, "
+            << stats.opens << " opens, "
+            << stats.set_ups << " set ups, "
+            << stats.tear_downs << " tear downs, "
+            << stats.closes << " closes, "
+            << stats.video_mode_changes << " video mode changes, "
+            << stats.subscriptions << " subscriptions, "
+            << stats.collects << " frame time collections\n"
+            << "scene sync: " << stats.scene_syncs << " nodes, "
+            << (stats.frames ? static_cast<double>(stats.scene_syncs) / stats.frames : 0.0) << " per frame, "
+            << stats.max_scene_sync << " max per frame\n";
+
+  return controller.get_exit_status();
+}
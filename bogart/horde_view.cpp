@@ -0,0 +1,928 @@
+#include "bogart/service/resolution_scaler.hpp"
+#include "bogart/service/thread_cpu_clock.hpp"
+#include "bogart/service/content_dir.hpp"
+#include "bogart/async/triple_buffer.hpp"
+#include "bogart/async/timer.hpp"
+#include "bogart/view_resources.hpp"
+#include "bogart/resource_streamer.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/perf_overlay.hpp"
+#include "bogart/log/log.hpp"
+#include "bogart/horde_view.hpp"
+#include "Horde3DUtils.h"
+#include "Horde3D.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+#include <functional>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace bogart
+{
+  //----------------------------------------------------------------------------------------------
+  //! Constants
+  //----------------------------------------------------------------------------------------------
+  const std::string OPTION_DYNAMIC_RESOLUTION = "-dynamic-resolution";
+  const std::string OPTION_MIN_RESOLUTION     = "-min-resolution-scale";
+  const std::chrono::milliseconds PUMP_IDLE_WAIT(50); // how often the event pump checks if it's done while there's no window
+  const std::chrono::milliseconds LOAD_BUDGET(4);     // time per frame the render thread spends handing files to the engine
+  const unsigned int IO_THREADS               = 2;     // threads reading resource files
+  const float LOADING_BAR_WIDTH               = 0.6f;
+  const float LOADING_BAR_HEIGHT              = 0.03f;
+  const float LOADING_BAR_TOP                 = 0.6f;
+
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    typedef std::chrono::steady_clock clock;
+
+    enum view_state
+    {
+      STATE_OPEN_WAIT = 0,
+      STATE_SET_UP_WAIT,
+      STATE_RENDER,
+      STATE_FAILED
+    };
+
+    //----------------------------------------------------------------------------------------------
+    //! Functions
+    //----------------------------------------------------------------------------------------------
+    struct stamped_snapshot
+    {
+      stamped_snapshot() : snapshot(), time()
+      {
+
+      }
+
+      world_snapshot snapshot;
+      clock::time_point time; // when the snapshot was published
+    };
+
+    // Normalized linear interpolation of rotations, which is close enough to a slerp for the small
+    // angles between two ticks and needs no trigonometry
+    glm::quat nlerp(const glm::quat& a, const glm::quat& b, float alpha)
+    {
+      // q and -q are the same rotation, take the short way
+      glm::quat c = (glm::dot(a, b) < 0.0f) ? -b : b;
+      return glm::normalize(a * (1.0f - alpha) + c * alpha);
+    }
+
+    // With -dynamic-resolution <milliseconds> the scene is rendered at a fraction of the window
+    // resolution that keeps frames around that long
+    std::unique_ptr<service::resolution_scaler> make_resolution_scaler(const service::cmd_line_args& args)
+    {
+      float target = args.get_float_option(OPTION_DYNAMIC_RESOLUTION, 0.0f);
+      if (target <= 0.0f) {
+        return nullptr;
+      }
+
+      float min_scale = std::min(std::max(args.get_float_option(OPTION_MIN_RESOLUTION, 0.5f), 0.1f), 1.0f);
+      return std::make_unique<service::resolution_scaler>(target / 1000.0f, min_scale);
+    }
+
+    // The calls resource_streamer makes, on Horde3D
+    class horde_resource_engine : public resource_engine
+    {
+    public:
+      virtual int query_unloaded(int index)
+      {
+        return h3dQueryUnloadedResource(index);
+      }
+
+      virtual std::string get_name(int res)
+      {
+        return h3dGetResName(res);
+      }
+
+      virtual void load(int res, const char* data, int size)
+      {
+        h3dLoadResource(res, data, size);
+      }
+    };
+
+    // A model of the view. Its nodes are added as soon as its scene graph is loaded, and stay
+    // inactive until its geometry is loaded too, since drawing a model without it reads from no
+    // vertex buffer. Materials and textures may arrive after it's shown.
+    struct view_model
+    {
+      view_model() : node(0), flags(0), shown(false)
+      {
+
+      }
+
+      H3DNode node;
+      int flags;                         // of the nodes once they are shown
+      bool shown;
+    };
+
+    // Whether the geometry of every model under node is loaded
+    bool is_geometry_loaded(H3DNode node)
+    {
+      int count = h3dFindNodes(node, "", H3DNodeTypes::Model);
+      for (int i = 0; i < count; i++) {
+        if (!h3dIsResLoaded(h3dGetNodeParamI(h3dGetNodeFindResult(i), H3DModel::GeoResI))) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // Adds the nodes of the model once res is loaded and shows them once their geometry is. Returns
+    // true on the call that added them.
+    bool attach_model(H3DRes res, view_model& model)
+    {
+      bool added = false;
+      if (!model.node && h3dIsResLoaded(res)) {
+        model.node = h3dAddNodes(H3DRootNode, res);
+        h3dSetNodeFlags(model.node, H3DNodeFlags::Inactive, true);
+        added = true;
+      }
+
+      if (model.node && !model.shown && is_geometry_loaded(model.node)) {
+        h3dSetNodeFlags(model.node, model.flags, true);
+        model.shown = true;
+      }
+
+      return added;
+    }
+
+    std::string format_settings(const view_settings& settings)
+    {
+      std::ostringstream os;
+      os << settings.window_width << " x "
+         << settings.window_height
+         << (settings.fullscreen? " fullscreen" : " windowed");
+      return os.str();
+    }
+
+  } // Anonymous namespace
+
+  class horde_view::horde_view_impl
+  {
+  public:
+    horde_view_impl(async::message_queue& render_queue,
+              async::message_queue& logic_queue,
+              async::message_queue& main_queue,
+              scene_mirror& scene,
+              service::system& system,
+              service::cmd_line_args& cmd_args) :
+      render_queue(render_queue),
+      logic_queue(logic_queue),
+      main_queue(main_queue),
+      scene(scene),
+      scene_updates(),
+      scene_nodes(),
+      streamer_engine(),
+      streamer(streamer_engine, IO_THREADS),
+      pipeline_sized(false),
+      actors_shown(false),
+      system(system),
+      cmd_args(cmd_args),
+      camera_node(0),
+      skybox(),
+      light(0),
+      terrain(),
+      settings(),
+      snapshots(),
+      frame_times(),
+      last_frame_start(),
+      previous_frame_start(),
+      pacing(),
+      next_frame(),
+      frame_timer(render_queue),
+      frame_timed(false),
+      overlay(render_queue, logic_queue),
+      scaler(make_resolution_scaler(cmd_args)),
+      redraw(false),
+      parked(false),
+      park_mutex(),
+      window_open(false),
+      window_mutex(),
+      m_event_handler(),
+      handler_mutex(),
+      state(STATE_OPEN_WAIT)
+    {
+
+    }
+
+    // Runs on the main thread
+    bool open_window(const view_settings& target)
+    {
+      std::unique_lock<std::mutex> lock(window_mutex);
+      if (system.open_window(target.window_width, target.window_height, target.fullscreen)) {
+        settings = target;
+      } else if (settings.window_width != 0) {
+        system.open_window(settings.window_width, settings.window_height, settings.fullscreen);
+      }
+
+      window_open = system.is_window_open();
+      return window_open;
+    }
+
+    // Runs on the main thread
+    void close_window()
+    {
+      std::unique_lock<std::mutex> lock(window_mutex);
+      system.close_window();
+      window_open = false;
+    }
+
+    // Runs f on the main thread, which owns the window, and waits for its result
+    bool call_on_main(const std::function<bool ()>& f)
+    {
+      std::promise<bool> done;
+      std::future<bool> result = done.get_future();
+      post_to_main(async::make_callable([&f, &done]() { done.set_value(f()); }));
+      return result.get();
+    }
+
+    // Posts r to the main thread, waking up the event pump if it's waiting for events. Thread-safe.
+    void post_to_main(async::runnable_ptr r)
+    {
+      main_queue.post(std::move(r));
+      std::unique_lock<std::mutex> lock(window_mutex);
+      if (window_open) {
+        system.wake_up();
+      }
+    }
+
+    void open(open_args_ptr args)
+    {
+      log::debug("view:: open");
+      if (state == STATE_OPEN_WAIT) {
+        // Open the window on the main thread and render to it from this one
+        const view_settings& target = args->settings;
+        if (!call_on_main([&]() { return open_window(target); })) {
+          log::debug(std::string("Could not set video mode to ") + format_settings(args->settings));
+          state = STATE_OPEN_WAIT;
+          logic_queue.post(async::make_callable([args = std::move(args)]() {
+            args->handler->on_open(false, view_settings());
+          }));
+          return;
+        }
+        log::debug(std::string("Successfully set video mode to ") + format_settings(args->settings));
+        system.bind_context();
+        apply_pacing();
+
+        // Initialize the renderer
+        if (!h3dInit()) {
+          h3dutDumpMessages();
+          system.unbind_context();
+          call_on_main([&]() { close_window(); return true; });
+          state = STATE_OPEN_WAIT;
+          logic_queue.post(async::make_callable([args = std::move(args)]() {
+            args->handler->on_open(false, view_settings());
+          }));
+          return;
+        }
+        log::debug("Successfully initialized Horde3D");
+
+        // Set options
+        h3dSetOption(H3DOptions::LoadTextures, 1);
+        h3dSetOption(H3DOptions::TexCompression, 0);
+        h3dSetOption(H3DOptions::MaxAnisotropy, 4);
+        h3dSetOption(H3DOptions::ShadowMapSize, 2048);
+        h3dSetOption(H3DOptions::FastAnimation, 0);
+
+        // Start loading resources. They are handed to the engine a slice per frame.
+        add_resources();
+        streamer.start(service::get_content_dir(cmd_args));
+        pipeline_sized = false;
+
+        // Finish successfully
+        state = STATE_SET_UP_WAIT;
+        logic_queue.post(async::make_callable([s = settings, args = std::move(args)]() {
+          args->handler->on_open(true, s);
+        }));
+      }
+    }
+
+    void set_up()
+    {
+      log::debug("view:: set_up");
+      if (state == STATE_SET_UP_WAIT) {
+        // Create camera
+        camera_node = h3dAddCameraNode(H3DRootNode, "GameCamera", get_pipeline());
+        set_up_viewport();
+
+        // Create light
+        H3DRes light_source_res = get_resource(RESOURCE_LIGHT_MATERIAL);
+        light = h3dAddLightNode(H3DRootNode, "Light1", light_source_res, "LIGHTING", "SHADOWMAP");
+        h3dSetNodeTransform(light, 0.0f, 18.0f, 0.0f, -90, 0, 0, 1, 1, 1);
+        h3dSetNodeParamF(light, H3DLight::RadiusF, 0, 200);
+        h3dSetNodeParamF(light, H3DLight::FovF, 0, 90);
+        h3dSetNodeParamI(light, H3DLight::ShadowMapCountI, 3);
+        h3dSetNodeParamF(light, H3DLight::ShadowSplitLambdaF, 0, 0.9f);
+        h3dSetNodeParamF(light, H3DLight::ShadowMapBiasF, 0, 0.001f);
+        h3dSetNodeParamF(light, H3DLight::ColorF3, 0, 0.9f);
+        h3dSetNodeParamF(light, H3DLight::ColorF3, 1, 0.7f);
+        h3dSetNodeParamF(light, H3DLight::ColorF3, 2, 0.75f);
+
+        // Models are added as their resources arrive. Until all of them have, we draw a loading bar.
+        attach_models();
+
+        // Start rendering loop, unless a frame of the last one is still waiting for the cap. That
+        // frame will find us in STATE_RENDER and carry on.
+        previous_frame_start = clock::time_point();
+        state = STATE_RENDER;
+        {
+          // A loop parked before the last tear down must not be restarted next to this one
+          std::unique_lock<std::mutex> lock(park_mutex);
+          parked = false;
+        }
+        if (!frame_timed) {
+          render_queue.post(async::make_callable([=]() { render(); }));
+        }
+      }
+    }
+
+    // Adds the skybox and terrain as their resources arrive. Scene mirror nodes follow in
+    // sync_scene().
+    void attach_models()
+    {
+      // Create Skybox
+      skybox.flags = H3DNodeFlags::NoCastShadow;
+      if (attach_model(get_resource(RESOURCE_SKYBOX), skybox)) {
+        h3dSetNodeTransform(skybox.node, 0, 0, 0, 0, 0, 0, 210, 50, 210);
+      }
+
+      // Create terrain
+      if (attach_model(get_resource(RESOURCE_SPONZA_MODEL), terrain)) {
+        h3dSetNodeTransform(terrain.node, 0, 0, 0, 0, 0, 0, 1, 1, 1);
+      }
+
+      // The pipeline may have been loaded after the viewport was set up
+      if (!pipeline_sized && h3dIsResLoaded(get_pipeline())) {
+        set_up_viewport();
+        pipeline_sized = true;
+      }
+    }
+
+    // Gives the streamer its slice of this frame and tells the controller how far it got
+    void stream_resources()
+    {
+      if (!streamer.is_loading()) {
+        return;
+      }
+
+      streamer.update(LOAD_BUDGET);
+      loading_progress progress = streamer.get_progress();
+      if (m_loading_handler) {
+        loading_handler h = m_loading_handler;
+        logic_queue.post(async::make_callable([h, progress]() { h(progress); }));
+      }
+      if (progress.done) {
+        log::debug("Successfully loaded view resources");
+      }
+    }
+
+    // With dynamic resolution the scene is drawn into a render target and then stretched over the
+    // window, otherwise it's drawn straight into the window
+    H3DRes get_pipeline() const
+    {
+      return get_resource(scaler ? RESOURCE_SCALED_PIPELINE : RESOURCE_FORWARD_PIPELINE);
+    }
+
+    // Fits the camera to the window size and the pipeline render targets to the scaled size.
+    // Horde3D renders into a render target at the target's own size, so the scaled viewport is the
+    // size of the render target. The camera viewport stays the window, which is where the final
+    // pass stretches the scene to.
+    void set_up_viewport()
+    {
+      float scale = scaler ? scaler->get_scale() : 1.0f;
+      int width = std::max(1, static_cast<int>(settings.window_width * scale + 0.5f));
+      int height = std::max(1, static_cast<int>(settings.window_height * scale + 0.5f));
+      h3dSetNodeParamI(camera_node, H3DCamera::ViewportXI, 0);
+      h3dSetNodeParamI(camera_node, H3DCamera::ViewportYI, 0);
+      h3dSetNodeParamI(camera_node, H3DCamera::ViewportWidthI, settings.window_width);
+      h3dSetNodeParamI(camera_node, H3DCamera::ViewportHeightI, settings.window_height);
+      h3dSetupCameraView(camera_node, 70.0f, (float) settings.window_width / settings.window_height, 0.1f, 1000.0f);
+      h3dResizePipelineBuffers(get_pipeline(), width, height);
+    }
+
+    // Feeds the work time of the last frame to the resolution scaler and applies its decision
+    void scale_resolution(float frame_time)
+    {
+      if (scaler && scaler->update(frame_time)) {
+        set_up_viewport();
+        if (log::is_enabled(log::DEBUG)) {
+          std::ostringstream os;
+          os << "Changed resolution scale to " << scaler->get_scale() << " after frames with "
+             << frame_time * 1000.0f << " ms of work";
+          log::debug(os.str());
+        }
+      }
+    }
+
+    void change_video_mode(open_args_ptr args)
+    {
+      log::debug("view:: change_video_mode");
+      clock::time_point start = clock::now();
+
+      // Resizing a window keeps the OpenGL context, so the renderer, its resources and the scene
+      // stay as they are. Going into or out of fullscreen needs a new window.
+      const view_settings& target = args->settings;
+      bool in_place = (state == STATE_RENDER && !settings.fullscreen && !target.fullscreen &&
+                       call_on_main([&]() { return system.resize_window(target.window_width, target.window_height); }));
+      if (in_place) {
+        settings = args->settings;
+        if (scaler) {
+          scaler->reset();
+        }
+        set_up_viewport();
+        if (log::is_enabled(log::DEBUG)) {
+          std::ostringstream os;
+          os << "Changed video mode to " << format_settings(settings) << " in "
+             << std::chrono::duration<double, std::milli>(clock::now() - start).count() << " ms";
+          log::debug(os.str());
+        }
+      }
+
+      logic_queue.post(async::make_callable([in_place, s = settings, args = std::move(args)]() {
+        args->handler->on_open(in_place, s);
+      }));
+    }
+
+    void render()
+    {
+      if (state == STATE_RENDER) {
+        clock::time_point frame_start = clock::now();
+        service::thread_cpu_clock::time_point cpu_start = service::thread_cpu_clock::now();
+        stream_resources();
+        attach_models();
+
+        // Pick the newest world snapshot. An idle world that hasn't changed since the last frame
+        // doesn't need drawing, so we stop until something happens instead.
+        bool fresh = snapshots.update() || redraw;
+        redraw = false;
+        if (snapshots.get_read_buffer().snapshot.idle && !fresh && park()) {
+          return;
+        }
+        const stamped_snapshot& latest = snapshots.get_read_buffer();
+        bool record = latest.snapshot.record_frame_times;
+
+        if (latest.snapshot.loading < 1.0f) {
+          show_loading_screen(latest.snapshot.loading);
+        }
+
+        // Show stats if enabled
+        overlay.set_visible(latest.snapshot.stats_enabled);
+        if (latest.snapshot.stats_enabled) {
+          H3DRes font_mat_res = get_resource(RESOURCE_FONT_MATERIAL);
+          H3DRes panel_mat_res = get_resource(RESOURCE_PANEL_MATERIAL);
+          if (font_mat_res && panel_mat_res) {
+            h3dutShowFrameStats(font_mat_res, panel_mat_res, H3DUTMaxStatMode);
+            overlay.show(latest.snapshot.metrics, (float) settings.window_width / settings.window_height,
+                         font_mat_res, panel_mat_res);
+          }
+        }
+
+        // Render the scene from the camera
+        sync_scene();
+        apply_camera(latest.snapshot.camera, latest.time);
+        if (h3dIsResLoaded(get_pipeline())) {
+          h3dRender(camera_node);
+        }
+        // Tell the engine that we have finished rendering the frame (used for stats generation)
+        h3dFinalizeFrame();
+        // Remove all overlays
+        h3dClearOverlays();
+        // Display rendered frame. Without vsync the swap only waits for the GPU to catch up, which
+        // is part of the work of the frame. With it, it also waits for the vertical blank.
+        clock::time_point work_end = clock::now();
+        system.swap_buffers();
+        if (pacing.mode == PACING_UNCAPPED || pacing.mode == PACING_CAP) {
+          work_end = clock::now();
+        }
+        // Write all messages to log file
+        h3dutDumpMessages();
+
+        // The resolution follows the work of the frame, not the time the pacing adds to it
+        scale_resolution(std::chrono::duration<float>(work_end - frame_start).count());
+
+        // Account for the time since the previous frame, which is unknown right after a wait
+        if (previous_frame_start != clock::time_point()) {
+          overlay.record_frame(std::chrono::duration<float>(frame_start - previous_frame_start).count());
+        }
+        previous_frame_start = frame_start;
+
+        // Measure the frame. The first recorded frame has no interval, because the previous one
+        // may have been rendered long before (for example, right after set_up).
+        if (record) {
+          frame_times.cpu.record(service::thread_cpu_clock::now() - cpu_start);
+          if (last_frame_start != clock::time_point()) {
+            frame_times.interval.record(frame_start - last_frame_start);
+          }
+          last_frame_start = frame_start;
+        } else {
+          last_frame_start = clock::time_point();
+        }
+
+        // Explicitly stay in STATE_RENDER and schedule next rendering loop. Under a cap the next
+        // frame waits on a timer, so the render queue keeps running handlers in the meantime.
+        state = STATE_RENDER;
+        if (get_frame_cap_deadline(frame_start)) {
+          frame_timed = true;
+          frame_timer.async_wait(next_frame, async::make_callable([=]() {
+            frame_timed = false;
+            render();
+          }));
+        } else {
+          render_queue.post(async::make_callable([=]() { render(); }));
+        }
+      }
+    }
+
+    // Sets the swap interval for the pacing mode. Needs the context bound to this thread.
+    void apply_pacing()
+    {
+      int interval = 0;
+      if (pacing.mode == PACING_VSYNC) {
+        interval = 1;
+      } else if (pacing.mode == PACING_ADAPTIVE_VSYNC) {
+        interval = system.has_adaptive_vsync() ? -1 : 1;
+        if (interval > 0) {
+          log::debug("Adaptive vsync is not supported, using vsync");
+        }
+      }
+
+      system.set_swap_interval(interval);
+      next_frame = clock::time_point();
+      overlay.set_pacing(pacing);
+    }
+
+    void set_frame_pacing(const frame_pacing& p)
+    {
+      pacing = p;
+      if (state != STATE_OPEN_WAIT) {
+        apply_pacing();
+      }
+    }
+
+    // With a CPU frame cap, moves next_frame to the moment the next frame may start and returns
+    // true. The deadlines don't drift, but a late frame pushes them back instead of making the next
+    // frames catch up.
+    bool get_frame_cap_deadline(clock::time_point frame_start)
+    {
+      if (pacing.mode != PACING_CAP || pacing.fps_cap <= 0.0f) {
+        return false;
+      }
+
+      clock::duration period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(1.0f / pacing.fps_cap));
+      next_frame = (next_frame == clock::time_point()) ? frame_start + period : next_frame + period;
+      next_frame = std::max(next_frame, clock::now());
+      return true;
+    }
+
+    // Stops the render loop until the next snapshot or input. Returns false, without stopping, if
+    // there's a new snapshot already or resources are still loading.
+    bool park()
+    {
+      std::unique_lock<std::mutex> lock(park_mutex);
+      if (snapshots.update() || streamer.is_loading()) {
+        return false;
+      }
+
+      parked = true;
+      // The time spent parked says nothing about how long frames take
+      previous_frame_start = clock::time_point();
+      next_frame = clock::time_point();
+      return true;
+    }
+
+    // Restarts the render loop if it's parked. Thread-safe.
+    void unpark(bool redraw_frame)
+    {
+      std::unique_lock<std::mutex> lock(park_mutex);
+      if (parked) {
+        parked = false;
+        render_queue.post(async::make_callable([=]() {
+          redraw = redraw_frame;
+          render();
+        }));
+      }
+    }
+
+    // Main thread loop: waits for window events and hands them to the controller as soon as they
+    // arrive, and runs the window operations the render thread asks for
+    void run_event_pump(const std::function<bool ()>& is_done)
+    {
+      while (!is_done()) {
+        main_queue.poll();
+        if (system.is_window_open()) {
+          forward_events(system.wait_events());
+          // The window may need to be redrawn, which an idle render loop wouldn't do
+          unpark(true);
+        } else {
+          main_queue.run_until(clock::now() + PUMP_IDLE_WAIT);
+        }
+      }
+      main_queue.poll();
+    }
+
+    void forward_events(event_vector_ptr e)
+    {
+      if (e->empty()) {
+        return;
+      }
+
+      event_handler h;
+      {
+        std::unique_lock<std::mutex> lock(handler_mutex);
+        h = m_event_handler;
+      }
+
+      if (h) {
+        // Lambdas are immutable by default. We need to make the lambda mutable to be able to
+        // move the unique_ptr we have captured inside it to the handler's parameter.
+        logic_queue.post(async::make_callable([h, e = std::move(e)]() mutable {
+          h(std::move(e));
+        }));
+      }
+    }
+
+    // Draws a progress bar in the middle of the screen, once the overlay materials are loaded
+    void show_loading_screen(float fraction)
+    {
+      H3DRes font_mat_res = get_resource(RESOURCE_FONT_MATERIAL);
+      H3DRes panel_mat_res = get_resource(RESOURCE_PANEL_MATERIAL);
+      if (!h3dIsResLoaded(font_mat_res) || !h3dIsResLoaded(panel_mat_res)) {
+        return;
+      }
+
+      float aspect = (float) settings.window_width / settings.window_height;
+      float left = 0.5f * (aspect - LOADING_BAR_WIDTH);
+      float right = left + LOADING_BAR_WIDTH * std::min(std::max(fraction, 0.0f), 1.0f);
+      float bottom = LOADING_BAR_TOP + LOADING_BAR_HEIGHT;
+      float background[16] = { left, LOADING_BAR_TOP, 0.0f, 1.0f,   left, bottom, 0.0f, 0.0f,
+                               left + LOADING_BAR_WIDTH, bottom, 1.0f, 0.0f,   left + LOADING_BAR_WIDTH, LOADING_BAR_TOP, 1.0f, 1.0f };
+      float bar[16] = { left, LOADING_BAR_TOP, 0.0f, 1.0f,   left, bottom, 0.0f, 0.0f,
+                        right, bottom, 1.0f, 0.0f,   right, LOADING_BAR_TOP, 1.0f, 1.0f };
+      h3dShowOverlays(background, 4, 0.2f, 0.2f, 0.2f, 0.8f, panel_mat_res, 0);
+      h3dShowOverlays(bar, 4, 0.9f, 0.9f, 0.9f, 1.0f, panel_mat_res, 0);
+
+      char text[32];
+      std::snprintf(text, sizeof(text), "Loading %3.0f%%", fraction * 100.0f);
+      h3dutShowText(text, left, LOADING_BAR_TOP - 0.05f, 0.03f, 1.0f, 1.0f, 1.0f, font_mat_res);
+    }
+
+    void tear_down()
+    {
+      if (state == STATE_RENDER) {
+        for (std::vector<H3DNode>::const_iterator it = scene_nodes.begin(); it != scene_nodes.end(); it++) {
+          if (*it) {
+            h3dRemoveNode(*it);
+          }
+        }
+        scene_nodes.clear();
+        scene.mark_all_dirty();
+        if (terrain.node) {
+          h3dRemoveNode(terrain.node);
+        }
+        if (skybox.node) {
+          h3dRemoveNode(skybox.node);
+        }
+        terrain = view_model();
+        skybox = view_model();
+        actors_shown = false;
+        h3dRemoveNode(light);
+        h3dRemoveNode(camera_node);
+        camera_node = 0;
+
+        state = STATE_SET_UP_WAIT;
+      }
+    }
+
+    void close()
+    {
+      if (state == STATE_SET_UP_WAIT)
+      {
+        streamer.cancel();
+        h3dRelease();
+        log::debug("Successfully finalized Horde3D");
+        system.unbind_context();
+        call_on_main([&]() { close_window(); return true; });
+        log::debug("Successfully closed window");
+        state = STATE_OPEN_WAIT;
+      }
+    }
+
+    // Applies the nodes of the scene mirror that changed since the last frame to the engine, in a
+    // single pass. Nodes are created the first time they show up.
+    void sync_scene()
+    {
+      // Changes stay in the mirror until the actor scene graph is loaded
+      H3DRes actor_res = get_resource(RESOURCE_ACTOR_MODEL);
+      if (!h3dIsResLoaded(actor_res)) {
+        return;
+      }
+
+      scene.collect(scene_updates);
+      for (scene_node_update_vector::const_iterator it = scene_updates.begin(); it != scene_updates.end(); it++) {
+        if (it->node >= scene_nodes.size()) {
+          scene_nodes.resize(it->node + 1, 0);
+        }
+
+        H3DNode& node = scene_nodes[it->node];
+        if (!node) {
+          node = h3dAddNodes(H3DRootNode, actor_res);
+        }
+        h3dSetNodeTransMat(node, glm::value_ptr(it->transform));
+        bool hidden = (it->flags & SCENE_NODE_HIDDEN) || !actors_shown;
+        h3dSetNodeFlags(node, hidden ? H3DNodeFlags::Inactive : 0, true);
+      }
+
+      // Actors stay inactive until their geometry arrives. Then every node is synced again to show
+      // them.
+      if (!actors_shown && !scene_nodes.empty() && scene_nodes.front() && is_geometry_loaded(scene_nodes.front())) {
+        actors_shown = true;
+        scene.mark_all_dirty();
+      }
+
+      overlay.record_scene_sync(static_cast<unsigned int>(scene_updates.size()),
+                                static_cast<unsigned int>(scene_nodes.size()));
+    }
+
+    void apply_camera(const camera_update& camera, clock::time_point camera_time)
+    {
+      // Interpolate between the two last simulation states, advancing alpha with the time that
+      // passed since the snapshot was published. Once alpha reaches the current state, or with a
+      // variable timestep, we use the transform the logic thread computed as is.
+      if (camera.step > 0.0f) {
+        float dt = std::chrono::duration<float>(clock::now() - camera_time).count();
+        float alpha = std::min(camera.alpha + dt / camera.step, 1.0f);
+        if (alpha < 1.0f) {
+          glm::mat4 m = glm::mat4_cast(nlerp(camera.previous.orientation, camera.current.orientation, alpha));
+          m[3] = glm::vec4(glm::mix(camera.previous.position, camera.current.position, alpha), 1.0f);
+          h3dSetNodeTransMat(camera_node, glm::value_ptr(m));
+          return;
+        }
+      }
+
+      h3dSetNodeTransMat(camera_node, glm::value_ptr(camera.current.transform));
+    }
+
+    void subscribe_to_loading(const loading_handler& handler)
+    {
+      m_loading_handler = handler;
+    }
+
+    void subscribe_to_events(const event_handler& handler)
+    {
+      std::unique_lock<std::mutex> lock(handler_mutex);
+      m_event_handler = handler;
+    }
+
+    void collect_frame_times(const frame_times_handler& handler)
+    {
+      logic_queue.post(async::make_callable([handler, times = frame_times]() {
+        handler(times);
+      }));
+      frame_times = render_frame_times();
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    async::message_queue& render_queue;
+    async::message_queue& logic_queue;
+    async::message_queue& main_queue;    // runs on the main thread, which owns the window
+    scene_mirror& scene;
+    scene_node_update_vector scene_updates; // reused every frame
+    std::vector<H3DNode> scene_nodes;    // engine node of each scene mirror node, 0 if not created
+    horde_resource_engine streamer_engine; // must outlive the streamer
+    resource_streamer streamer;
+    bool pipeline_sized;                 // whether the pipeline buffers were sized since it loaded
+    bool actors_shown;                   // whether the actor geometry is loaded
+    service::system& system;
+    service::cmd_line_args& cmd_args;
+    H3DNode camera_node;
+    view_model skybox;
+    H3DNode light;
+    view_model terrain;
+    view_settings settings; // last view settings that were succesfully set, if any
+    async::triple_buffer<stamped_snapshot> snapshots; // written by the logic thread
+    render_frame_times frame_times;
+    clock::time_point last_frame_start;  // start of the last recorded frame, if any
+    clock::time_point previous_frame_start; // start of the previous frame, if it's known
+    frame_pacing pacing;
+    clock::time_point next_frame;        // earliest start of the next frame under a cap, if known
+    async::timer frame_timer;            // starts the next frame under a cap
+    bool frame_timed;                    // the next frame waits for frame_timer
+    perf_overlay overlay;
+    std::unique_ptr<service::resolution_scaler> scaler; // null without dynamic resolution
+    bool redraw;                         // draw the next frame even if the world is idle
+    bool parked;                         // the render loop stopped because the world is idle
+    std::mutex park_mutex;
+    bool window_open;
+    std::mutex window_mutex;             // keeps the window open while waking up the event pump
+    loading_handler m_loading_handler;
+    event_handler m_event_handler;       // set from the logic thread, used by the event pump
+    std::mutex handler_mutex;
+    view_state state;
+  }; // class horde_view::horde_view_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  horde_view::horde_view(
+    async::message_queue& render_queue,
+    async::message_queue& logic_queue,
+    async::message_queue& main_queue,
+    scene_mirror& scene,
+    service::system& system,
+    service::cmd_line_args& args) :
+    impl(std::make_unique<horde_view::horde_view_impl>(render_queue, logic_queue, main_queue, scene, system, args)) {
+
+  }
+
+  horde_view::~horde_view() {
+
+  }
+
+  void horde_view::async_open(open_args_ptr args)
+  {
+    // Lambdas are immutable by default. We need to make the lambda mutable to be able to move the
+    // unique_ptr we have captured inside it to set_up's parameter.
+    impl->render_queue.post(async::make_callable([=, args = std::move(args)]() mutable {
+      impl->open(std::move(args));
+    }));
+  }
+
+  void horde_view::async_set_up()
+  {
+    impl->render_queue.post(async::make_callable([=](){ impl->set_up(); }));
+  }
+
+  void horde_view::async_tear_down()
+  {
+    impl->render_queue.post(async::make_callable([=]() { impl->tear_down(); }));
+  }
+
+  void horde_view::async_close()
+  {
+    impl->render_queue.post(async::make_callable([=]() { impl->close(); }));
+  }
+
+  void horde_view::async_change_video_mode(open_args_ptr args)
+  {
+    impl->render_queue.post(async::make_callable([=, args = std::move(args)]() mutable {
+      impl->change_video_mode(std::move(args));
+    }));
+  }
+
+  void horde_view::async_subscribe_to_events(const event_handler& handler)
+  {
+    impl->subscribe_to_events(handler);
+  }
+
+  void horde_view::async_set_frame_pacing(const frame_pacing& pacing)
+  {
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->set_frame_pacing(pacing);
+    }));
+  }
+
+  void horde_view::async_subscribe_to_loading(const loading_handler& handler)
+  {
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->subscribe_to_loading(handler);
+    }));
+  }
+
+  void horde_view::publish(const world_snapshot& snapshot)
+  {
+    stamped_snapshot& s = impl->snapshots.get_write_buffer();
+    s.snapshot = snapshot;
+    s.time = clock::now();
+    impl->snapshots.publish();
+    impl->unpark(false);
+  }
+
+  void horde_view::run_event_pump(const std::function<bool ()>& is_done)
+  {
+    impl->run_event_pump(is_done);
+  }
+
+  void horde_view::wake_event_pump()
+  {
+    impl->post_to_main(async::make_callable([]() {}));
+  }
+
+  void horde_view::async_collect_frame_times(const frame_times_handler& handler)
+  {
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->collect_frame_times(handler);
+    }));
+  }
+} // namespace bogart
@@ -0,0 +1,81 @@
+#ifndef HORDE_VIEW_HPP
+#define HORDE_VIEW_HPP
+
+#include "bogart/service/cmd_line_args.hpp"
+#include "bogart/async/message_queue.hpp"
+#include "bogart/service/system.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/view.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class horde_view
+  //! @ingroup bogart
+  //!
+  //! View that renders the world with Horde3D in a window opened through service::system.
+  //!
+  //! Rendering runs on the thread that runs render_queue, which owns the OpenGL context. The window
+  //! belongs to the main thread, which must call run_event_pump(): it waits for window events and
+  //! hands them to the controller as soon as they arrive, and opens, resizes and closes the window
+  //! when the render thread asks it to through main_queue.
+  //!
+  //! Every frame, the nodes of the scene mirror that changed since the previous one are applied to
+  //! the engine in a single pass before rendering.
+  //!
+  //! Thread-safety: all public methods are thread-safe.
+  //------------------------------------------------------------------------------------------------
+  class horde_view : public view
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    horde_view(async::message_queue& render_queue,
+               async::message_queue& logic_queue,
+               async::message_queue& main_queue,
+               scene_mirror& scene,
+               service::system& system,
+               service::cmd_line_args& args);
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor
+    //----------------------------------------------------------------------------------------------
+    virtual ~horde_view();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    virtual void async_open(open_args_ptr args);
+    virtual void async_set_up();
+    virtual void async_tear_down();
+    virtual void async_close();
+    virtual void async_change_video_mode(open_args_ptr args);
+    virtual void async_subscribe_to_events(const event_handler& handler);
+    virtual void async_set_frame_pacing(const frame_pacing& pacing);
+    virtual void async_subscribe_to_loading(const loading_handler& handler);
+    virtual void publish(const world_snapshot& snapshot);
+    virtual void async_collect_frame_times(const frame_times_handler& handler);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Runs the event pump until is_done returns true. Must be called from the main thread.
+    //!  is_done is checked after every batch of events, and at least every 50 ms while there's
+    //!  no window, so it should only become true once the window is closed.
+    //----------------------------------------------------------------------------------------------
+    void run_event_pump(const std::function<bool ()>& is_done);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Makes run_event_pump() check is_done again, even if it's waiting for events.
+    //----------------------------------------------------------------------------------------------
+    void wake_event_pump();
+
+  private:
+    class horde_view_impl;                      //!< implementation class (Pimpl idiom)
+    std::unique_ptr<horde_view_impl> impl;      //!< pointer to implementation (Pimpl idiom)
+  }; // class horde_view
+} // namespace bogart
+
+#endif // HORDE_VIEW_HPP
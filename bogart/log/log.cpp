@@ -22,6 +22,10 @@ namespace log
     level = l;
   }
 
+  bool is_enabled(log_level l) {
+    return l <= level;
+  }
+
   void error(const std::string& message) {
     log_message(ERROR, message);
   }
@@ -15,6 +15,7 @@ namespace log
   };
 
   void set_log_level(log_level level);
+  bool is_enabled(log_level level);
   void error(const std::string& message);
   void error(const char* message);
   void debug(const std::string& message);
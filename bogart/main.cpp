@@ -1,15 +1,23 @@
 #include "bogart/service/cmd_line_args.hpp"
 #include "bogart/async/message_queue.hpp"
+#include "bogart/async/timer.hpp"
 #include "bogart/service/system.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/horde_view.hpp"
 #include "bogart/controller.hpp"
 #include "bogart/log/log.hpp"
-#include "bogart/view.hpp"
 
+#include <atomic>
 #include <thread>
 
 // Call like this:
 // $ cd bogart/build/bogart
 // $ ./bogart -width 1920 -height 1080 -fullscreen -content-dir ../../resources
+//
+// Or like this to run the release-gate benchmark and write benchmark_report.json:
+// $ ./bogart -content-dir ../../resources -tick-rate 60 -benchmark ../../resources/paths/sponza_flythrough.path
+//
+// bogart_headless runs the same controller without a window or OpenGL context.
 int main(int argc, char** argv) {
   // Parse command line arguments
   bogart::service::cmd_line_args args(argc, argv);
@@ -19,25 +27,57 @@ int main(int argc, char** argv) {
     bogart::log::set_log_level(bogart::log::DEBUG);
   }
 
-  // Initialize system
-  bogart::service::system system;
+  // Select timer backend
+  if (args.get_option_value("-timer-backend", "") == "timerfd") {
+    bogart::async::set_timer_backend(bogart::async::TIMER_BACKEND_TIMERFD);
+  }
 
   // Create message queues
   bogart::async::message_queue render_queue;
   bogart::async::message_queue logic_queue;
+  bogart::async::message_queue main_queue;
+
+  // Trade some spinning for timing accuracy if requested
+  if (args.has_option("-high-precision")) {
+    bogart::async::set_timer_high_precision(true);
+    render_queue.set_high_precision(true);
+    logic_queue.set_high_precision(true);
+  }
+
+  // The scene the controller writes and the view renders
+  bogart::scene_mirror scene;
+
+  // Initialize system
+  bogart::service::system system;
 
   // View and controller
-  bogart::view view(render_queue, logic_queue, system, args);
-  bogart::controller controller(logic_queue, view, args);
+  bogart::horde_view view(render_queue, logic_queue, main_queue, scene, system, args);
+  bogart::controller controller(logic_queue, view, scene, args);
   controller.async_call();
 
-  // Start the logic thread
-  std::thread logic_thread(&bogart::async::message_queue::run, &logic_queue, std::chrono::seconds(1));
+  // Start the logic thread. The queues go quiet while the world is paused, so each loop keeps
+  // running until the controller is done and then drains what is left.
+  std::thread logic_thread([&]() {
+    do {
+      logic_queue.run(std::chrono::seconds(1));
+    } while (!controller.is_finished());
+  });
+
+  // Render on a thread of its own and keep the main thread, which owns the window, pumping events
+  // so that input reaches the logic thread as soon as it arrives rather than once per frame
+  std::atomic<bool> render_done(false);
+  std::thread render_thread([&]() {
+    do {
+      render_queue.run(std::chrono::seconds(1));
+    } while (!controller.is_finished());
+    render_done = true;
+    view.wake_event_pump();
+  });
 
-  // Run render loop
-  render_queue.run(std::chrono::seconds(1));
+  view.run_event_pump([&]() { return render_done.load(); });
+  render_thread.join();
 
   logic_thread.join();
 
-  return 0;
+  return controller.get_exit_status();
 }
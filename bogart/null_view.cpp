@@ -0,0 +1,366 @@
+#include "bogart/service/thread_cpu_clock.hpp"
+#include "bogart/async/triple_buffer.hpp"
+#include "bogart/async/timer.hpp"
+#include "bogart/null_view.hpp"
+#include "bogart/log/log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace bogart
+{
+  //----------------------------------------------------------------------------------------------
+  //! Constants
+  //----------------------------------------------------------------------------------------------
+  const std::string OPTION_HEADLESS_FPS       = "-headless-fps";
+
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    typedef async::timer::clock clock;
+
+    enum view_state
+    {
+      STATE_OPEN_WAIT = 0,
+      STATE_SET_UP_WAIT,
+      STATE_RENDER
+    };
+
+    // Returns the time between frames, or zero to render as fast as possible
+    clock::duration get_frame_period_from_cmd_args(const service::cmd_line_args& args)
+    {
+      float fps = args.get_float_option(OPTION_HEADLESS_FPS, 60.0f);
+      if (fps <= 0.0f) {
+        return clock::duration::zero();
+      }
+      return std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(1.0f / fps));
+    }
+  } // Anonymous namespace
+
+  class null_view::null_view_impl
+  {
+  public:
+    null_view_impl(async::message_queue& render_queue,
+                   async::message_queue& logic_queue,
+                   scene_mirror& scene,
+                   service::cmd_line_args& cmd_args) :
+      render_queue(render_queue),
+      logic_queue(logic_queue),
+      scene(scene),
+      scene_updates(),
+      frame_timer(render_queue),
+      display_period(get_frame_period_from_cmd_args(cmd_args)),
+      frame_period(display_period),
+      next_frame(),
+      frame_pending(false),
+      parked(false),
+      park_mutex(),
+      snapshots(),
+      frame_times(),
+      last_frame_start(),
+      settings(),
+      opens(0),
+      set_ups(0),
+      tear_downs(0),
+      closes(0),
+      video_mode_changes(0),
+      subscriptions(0),
+      publishes(0),
+      collects(0),
+      frames(0),
+      scene_syncs(0),
+      max_scene_sync(0),
+      state(STATE_OPEN_WAIT)
+    {
+
+    }
+
+    void open(open_args_ptr args)
+    {
+      log::debug("null_view:: open");
+      if (state == STATE_OPEN_WAIT) {
+        state = STATE_SET_UP_WAIT;
+        settings = args->settings;
+        logic_queue.post(async::make_callable([args = std::move(args)]() {
+          args->handler->on_open(true, args->settings);
+        }));
+      }
+    }
+
+    void set_up()
+    {
+      log::debug("null_view:: set_up");
+      if (state == STATE_SET_UP_WAIT) {
+        state = STATE_RENDER;
+        next_frame = clock::now();
+
+        // A frame of a previous set up may still be pending, in which case it goes on with the loop
+        if (!frame_pending) {
+          frame_pending = true;
+          render_queue.post(async::make_callable([=]() { render(); }));
+        }
+      }
+    }
+
+    void render()
+    {
+      frame_pending = false;
+      if (state == STATE_RENDER) {
+        clock::time_point frame_start = clock::now();
+        service::thread_cpu_clock::time_point cpu_start = service::thread_cpu_clock::now();
+
+        // Pick the newest world snapshot, which is all horde_view needs from the logic thread. Like
+        // horde_view, we stop while the world is idle and unchanged, until the next snapshot.
+        bool fresh = snapshots.update();
+        bool record = snapshots.get_read_buffer().record_frame_times;
+        if (snapshots.get_read_buffer().idle && !fresh && park()) {
+          return;
+        }
+        frames++;
+
+        // Take the changes of the scene mirror like horde_view does, without an engine to give
+        // them to
+        scene.collect(scene_updates);
+        scene_syncs += scene_updates.size();
+        if (scene_updates.size() > max_scene_sync) {
+          max_scene_sync = scene_updates.size();
+        }
+
+        if (record) {
+          frame_times.cpu.record(service::thread_cpu_clock::now() - cpu_start);
+          if (last_frame_start != clock::time_point()) {
+            frame_times.interval.record(frame_start - last_frame_start);
+          }
+          last_frame_start = frame_start;
+        } else {
+          last_frame_start = clock::time_point();
+        }
+
+        // Schedule the next frame on deadlines that don't drift
+        frame_pending = true;
+        if (frame_period == clock::duration::zero()) {
+          render_queue.post(async::make_callable([=]() { render(); }));
+        } else {
+          next_frame = std::max(next_frame + frame_period, clock::now());
+          frame_timer.async_wait(next_frame, async::make_callable([=]() { render(); }));
+        }
+      }
+    }
+
+    // Stops the frame loop until publish() unparks it, unless there's a new snapshot already
+    bool park()
+    {
+      std::unique_lock<std::mutex> lock(park_mutex);
+      if (snapshots.update()) {
+        return false;
+      }
+      parked = true;
+      return true;
+    }
+
+    void unpark()
+    {
+      if (!frame_pending) {
+        render();
+      }
+    }
+
+    void tear_down()
+    {
+      if (state == STATE_RENDER) {
+        // horde_view loses its nodes here and creates them again on the next set up
+        scene.mark_all_dirty();
+        state = STATE_SET_UP_WAIT;
+      }
+    }
+
+    void close()
+    {
+      if (state == STATE_SET_UP_WAIT) {
+        state = STATE_OPEN_WAIT;
+      }
+    }
+
+    void change_video_mode(open_args_ptr args)
+    {
+      log::debug("null_view:: change_video_mode");
+      bool in_place = (state == STATE_RENDER && !settings.fullscreen && !args->settings.fullscreen);
+      if (in_place) {
+        settings = args->settings;
+      }
+      logic_queue.post(async::make_callable([in_place, s = settings, args = std::move(args)]() {
+        args->handler->on_open(in_place, s);
+      }));
+    }
+
+    void subscribe_to_events(const event_handler& handler)
+    {
+      m_event_handler = handler;
+    }
+
+    // There's no display to synchronize with, so only a CPU cap changes the simulated frame rate
+    void set_frame_pacing(const frame_pacing& pacing)
+    {
+      if (pacing.mode == PACING_CAP && pacing.fps_cap > 0.0f) {
+        frame_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(1.0f / pacing.fps_cap));
+      } else {
+        frame_period = display_period;
+      }
+    }
+
+    void collect_frame_times(const frame_times_handler& handler)
+    {
+      logic_queue.post(async::make_callable([handler, times = frame_times]() {
+        handler(times);
+      }));
+      frame_times = render_frame_times();
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    async::message_queue& render_queue;
+    async::message_queue& logic_queue;
+    scene_mirror& scene;
+    scene_node_update_vector scene_updates; // reused every frame
+    async::timer frame_timer;
+    clock::duration display_period;     // from -headless-fps, zero to render as fast as possible
+    clock::duration frame_period;       // display_period, or the period of a CPU frame cap
+    clock::time_point next_frame;
+    bool frame_pending;                 // whether a call to render() is scheduled
+    bool parked;                        // whether the frame loop stopped for an idle world
+    std::mutex park_mutex;              // protects parked
+    async::triple_buffer<world_snapshot> snapshots; // written by the logic thread
+    render_frame_times frame_times;
+    clock::time_point last_frame_start; // start of the last recorded frame, if any
+    view_settings settings;             // settings of the last successful open or change
+    std::atomic<unsigned long> opens;
+    std::atomic<unsigned long> set_ups;
+    std::atomic<unsigned long> tear_downs;
+    std::atomic<unsigned long> closes;
+    std::atomic<unsigned long> video_mode_changes;
+    std::atomic<unsigned long> subscriptions;
+    std::atomic<unsigned long> publishes;
+    std::atomic<unsigned long> collects;
+    std::atomic<unsigned long> frames;
+    std::atomic<unsigned long> scene_syncs;
+    std::atomic<unsigned long> max_scene_sync;
+    event_handler m_event_handler;      // never called, there is no input to forward
+    view_state state;
+  }; // class null_view::null_view_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  null_view::null_view(
+    async::message_queue& render_queue,
+    async::message_queue& logic_queue,
+    scene_mirror& scene,
+    service::cmd_line_args& args) :
+    impl(std::make_unique<null_view::null_view_impl>(render_queue, logic_queue, scene, args)) {
+
+  }
+
+  null_view::~null_view() {
+
+  }
+
+  void null_view::async_open(open_args_ptr args)
+  {
+    impl->opens++;
+    impl->render_queue.post(async::make_callable([=, args = std::move(args)]() mutable {
+      impl->open(std::move(args));
+    }));
+  }
+
+  void null_view::async_set_up()
+  {
+    impl->set_ups++;
+    impl->render_queue.post(async::make_callable([=](){ impl->set_up(); }));
+  }
+
+  void null_view::async_tear_down()
+  {
+    impl->tear_downs++;
+    impl->render_queue.post(async::make_callable([=]() { impl->tear_down(); }));
+  }
+
+  void null_view::async_close()
+  {
+    impl->closes++;
+    impl->render_queue.post(async::make_callable([=]() { impl->close(); }));
+  }
+
+  void null_view::async_change_video_mode(open_args_ptr args)
+  {
+    impl->video_mode_changes++;
+    impl->render_queue.post(async::make_callable([=, args = std::move(args)]() mutable {
+      impl->change_video_mode(std::move(args));
+    }));
+  }
+
+  void null_view::async_subscribe_to_events(const event_handler& handler)
+  {
+    impl->subscriptions++;
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->subscribe_to_events(handler);
+    }));
+  }
+
+  void null_view::async_set_frame_pacing(const frame_pacing& pacing)
+  {
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->set_frame_pacing(pacing);
+    }));
+  }
+
+  // There are no resources to load, so loading is always done
+  void null_view::async_subscribe_to_loading(const loading_handler& handler)
+  {
+    impl->logic_queue.post(async::make_callable([=]() {
+      handler(loading_progress());
+    }));
+  }
+
+  void null_view::publish(const world_snapshot& snapshot)
+  {
+    impl->publishes++;
+    impl->snapshots.get_write_buffer() = snapshot;
+    impl->snapshots.publish();
+
+    std::unique_lock<std::mutex> lock(impl->park_mutex);
+    if (impl->parked) {
+      impl->parked = false;
+      impl->render_queue.post(async::make_callable([=]() { impl->unpark(); }));
+    }
+  }
+
+  void null_view::async_collect_frame_times(const frame_times_handler& handler)
+  {
+    impl->collects++;
+    impl->render_queue.post(async::make_callable([=]() {
+      impl->collect_frame_times(handler);
+    }));
+  }
+
+  null_view_stats null_view::get_stats() const
+  {
+    null_view_stats ret;
+    ret.opens = impl->opens;
+    ret.set_ups = impl->set_ups;
+    ret.tear_downs = impl->tear_downs;
+    ret.closes = impl->closes;
+    ret.video_mode_changes = impl->video_mode_changes;
+    ret.subscriptions = impl->subscriptions;
+    ret.publishes = impl->publishes;
+    ret.collects = impl->collects;
+    ret.frames = impl->frames;
+    ret.scene_syncs = impl->scene_syncs;
+    ret.max_scene_sync = impl->max_scene_sync;
+    return ret;
+  }
+} // namespace bogart
@@ -0,0 +1,99 @@
+#ifndef NULL_VIEW_HPP
+#define NULL_VIEW_HPP
+
+#include "bogart/service/cmd_line_args.hpp"
+#include "bogart/async/message_queue.hpp"
+#include "bogart/scene_mirror.hpp"
+#include "bogart/view.hpp"
+
+#include <memory>
+
+namespace bogart
+{
+  // Number of calls a null_view received, by kind, number of frames it simulated and number of
+  // scene mirror nodes it synced
+  struct null_view_stats
+  {
+    null_view_stats() :
+      opens(0),
+      set_ups(0),
+      tear_downs(0),
+      closes(0),
+      video_mode_changes(0),
+      subscriptions(0),
+      publishes(0),
+      collects(0),
+      frames(0),
+      scene_syncs(0),
+      max_scene_sync(0)
+    {
+
+    }
+
+    unsigned long opens;
+    unsigned long set_ups;
+    unsigned long tear_downs;
+    unsigned long closes;
+    unsigned long video_mode_changes;
+    unsigned long subscriptions;
+    unsigned long publishes;
+    unsigned long collects;
+    unsigned long frames;
+    unsigned long scene_syncs;    // in all frames
+    unsigned long max_scene_sync; // in a single frame
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @class null_view
+  //! @ingroup bogart
+  //!
+  //! View for headless runs. It needs neither a window nor an OpenGL context, so it runs on
+  //! machines without a GPU. Opening always succeeds with the requested settings, video mode
+  //! changes succeed under the same conditions as in horde_view, and while set up it runs a frame
+  //! loop on the render queue at -headless-fps frames per second (60 by default, 0 means as fast
+  //! as possible), or at the frame cap if PACING_CAP is set. Every frame picks the newest snapshot,
+  //! takes the changes of the scene mirror, records frame times when asked to and posts an empty
+  //! event batch to the subscriber, like horde_view does, so the controller and the async layer
+  //! see the same traffic as in production. While the world is idle the loop stops until the next
+  //! snapshot.
+  //!
+  //! Thread-safety: all public methods are thread-safe.
+  //------------------------------------------------------------------------------------------------
+  class null_view : public view
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    null_view(async::message_queue& render_queue,
+              async::message_queue& logic_queue,
+              scene_mirror& scene,
+              service::cmd_line_args& args);
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor
+    //----------------------------------------------------------------------------------------------
+    virtual ~null_view();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    virtual void async_open(open_args_ptr args);
+    virtual void async_set_up();
+    virtual void async_tear_down();
+    virtual void async_close();
+    virtual void async_change_video_mode(open_args_ptr args);
+    virtual void async_subscribe_to_events(const event_handler& handler);
+    virtual void async_set_frame_pacing(const frame_pacing& pacing);
+    virtual void async_subscribe_to_loading(const loading_handler& handler);
+    virtual void publish(const world_snapshot& snapshot);
+    virtual void async_collect_frame_times(const frame_times_handler& handler);
+    null_view_stats get_stats() const;
+
+  private:
+    class null_view_impl;                       //!< implementation class (Pimpl idiom)
+    std::unique_ptr<null_view_impl> impl;       //!< pointer to implementation (Pimpl idiom)
+  }; // class null_view
+} // namespace bogart
+
+#endif // NULL_VIEW_HPP
@@ -0,0 +1,292 @@
+#include "bogart/allocation_counter.hpp"
+#include "bogart/perf_overlay.hpp"
+#include "Horde3DUtils.h"
+#include "Horde3D.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    typedef std::chrono::steady_clock clock;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const unsigned int GRAPH_FRAMES = 120;
+    const unsigned int LINE_COUNT = 9;
+    const unsigned int LINE_LENGTH = 80;
+    const float REFRESH_PERIOD = 0.25f;       // seconds between updates of the numbers
+
+    // Layout, in overlay coordinates: the height of the screen is 1
+    const float LEFT = 0.03f;
+    const float TOP = 0.42f;
+    const float WIDTH = 0.62f;
+    const float MARGIN = 0.01f;
+    const float GRAPH_HEIGHT = 0.12f;
+    const float GRAPH_RANGE = 0.05f;          // frame time at the top of the graph, in seconds
+    const float FONT_SIZE = 0.025f;
+    const float LINE_HEIGHT = 0.03f;
+    const float BAR_WIDTH = (WIDTH - 2.0f * MARGIN) / GRAPH_FRAMES;
+
+    // Bars are grouped by color, so that each group is a single h3dShowOverlays() call
+    const unsigned int COLOR_COUNT = 3;
+    const float BUDGETS[COLOR_COUNT] = { 1.0f / 60.0f, 1.0f / 30.0f, 1e9f };
+    const float COLORS[COLOR_COUNT][3] = { { 0.3f, 0.9f, 0.3f }, { 0.9f, 0.8f, 0.2f }, { 0.9f, 0.25f, 0.2f } };
+
+    float to_ms(std::chrono::nanoseconds d)
+    {
+      return std::chrono::duration<float, std::milli>(d).count();
+    }
+
+    float mean_wait_ms(const async::message_queue_stats& s)
+    {
+      return s.handlers ? to_ms(s.total_wait) / s.handlers : 0.0f;
+    }
+
+    // Appends a quad to verts, which must have room for 16 more floats
+    float* add_quad(float* verts, float x0, float y0, float x1, float y1)
+    {
+      const float quad[16] = { x0, y0, 0.0f, 1.0f,   x0, y1, 0.0f, 0.0f,
+                               x1, y1, 1.0f, 0.0f,   x1, y0, 1.0f, 1.0f };
+      return std::copy(quad, quad + 16, verts);
+    }
+  } // Anonymous namespace
+
+  class perf_overlay::perf_overlay_impl
+  {
+  public:
+    perf_overlay_impl(async::message_queue& render_queue, async::message_queue& logic_queue) :
+      render_queue(render_queue),
+      logic_queue(logic_queue),
+      frame_times(),
+      next_frame(0),
+      last_allocations(get_allocation_count()),
+      window_start(clock::now()),
+      window_frames(0),
+      window_frame_time(0.0),
+      window_frame_time_squares(0.0),
+      pacing(),
+      window_synced(0),
+      max_synced(0),
+      scene_nodes(0),
+      window_allocations(0),
+      max_frame_time(0.0f),
+      max_tick_time(0.0f),
+      max_lateness(0.0f),
+      max_input_latency(0.0f),
+      max_show_time(0.0f),
+      visible(false),
+      lines(),
+      verts()
+    {
+      std::fill(frame_times, frame_times + GRAPH_FRAMES, 0.0f);
+      for (unsigned int i = 0; i < LINE_COUNT; i++) {
+        lines[i][0] = '\0';
+      }
+    }
+
+    void record_frame(float frame_time)
+    {
+      frame_times[next_frame] = frame_time;
+      next_frame = (next_frame + 1) % GRAPH_FRAMES;
+
+      unsigned long allocations = get_allocation_count();
+      window_allocations += allocations - last_allocations;
+      last_allocations = allocations;
+      window_frames++;
+      window_frame_time += frame_time;
+      window_frame_time_squares += static_cast<double>(frame_time) * frame_time;
+      max_frame_time = std::max(max_frame_time, frame_time);
+    }
+
+    // Queue stats cost a clock read per handler, so the queues only collect them while they're shown
+    void set_visible(bool v)
+    {
+      if (v != visible) {
+        visible = v;
+        render_queue.set_stats_enabled(visible);
+        logic_queue.set_stats_enabled(visible);
+      }
+    }
+
+    void set_pacing(const frame_pacing& p)
+    {
+      pacing = p;
+    }
+
+    void record_scene_sync(unsigned int synced, unsigned int node_count)
+    {
+      window_synced += synced;
+      max_synced = std::max(max_synced, synced);
+      scene_nodes = node_count;
+    }
+
+    void show(const logic_metrics& logic, float aspect, H3DRes font_material, H3DRes panel_material)
+    {
+      clock::time_point start = clock::now();
+      max_tick_time = std::max(max_tick_time, logic.tick_time);
+      max_lateness = std::max(max_lateness, logic.timer_lateness);
+      max_input_latency = std::max(max_input_latency, logic.input_latency);
+      if (std::chrono::duration<float>(start - window_start).count() >= REFRESH_PERIOD) {
+        refresh(start);
+      }
+
+      // Keep clear of the right edge on narrow screens
+      float left = std::min(LEFT, aspect - WIDTH);
+      float graph_bottom = TOP + MARGIN + GRAPH_HEIGHT;
+      float bottom = graph_bottom + MARGIN + LINE_COUNT * LINE_HEIGHT + MARGIN;
+
+      // Background and budget lines
+      add_quad(verts, left, TOP, left + WIDTH, bottom);
+      h3dShowOverlays(verts, 4, 0.0f, 0.0f, 0.0f, 0.6f, panel_material, 0);
+      float* v = verts;
+      for (unsigned int c = 0; c + 1 < COLOR_COUNT; c++) {
+        float y = graph_bottom - GRAPH_HEIGHT * std::min(BUDGETS[c] / GRAPH_RANGE, 1.0f);
+        v = add_quad(v, left + MARGIN, y - 0.001f, left + WIDTH - MARGIN, y + 0.001f);
+      }
+      h3dShowOverlays(verts, static_cast<int>((v - verts) / 4), 1.0f, 1.0f, 1.0f, 0.3f, panel_material, 0);
+
+      // Frame time graph, oldest frame on the left
+      for (unsigned int c = 0; c < COLOR_COUNT; c++) {
+        float low = (c == 0) ? 0.0f : BUDGETS[c - 1];
+        v = verts;
+        for (unsigned int i = 0; i < GRAPH_FRAMES; i++) {
+          float t = frame_times[(next_frame + i) % GRAPH_FRAMES];
+          if (t > low && t <= BUDGETS[c]) {
+            float x = left + MARGIN + i * BAR_WIDTH;
+            float h = GRAPH_HEIGHT * std::min(t / GRAPH_RANGE, 1.0f);
+            v = add_quad(v, x, graph_bottom - h, x + 0.8f * BAR_WIDTH, graph_bottom);
+          }
+        }
+        if (v != verts) {
+          h3dShowOverlays(verts, static_cast<int>((v - verts) / 4), COLORS[c][0], COLORS[c][1], COLORS[c][2], 1.0f, panel_material, 0);
+        }
+      }
+
+      // Numbers
+      for (unsigned int i = 0; i < LINE_COUNT; i++) {
+        float y = graph_bottom + MARGIN + i * LINE_HEIGHT;
+        h3dutShowText(lines[i], left + MARGIN, y, FONT_SIZE, 1.0f, 1.0f, 1.0f, font_material);
+      }
+
+      max_show_time = std::max(max_show_time, std::chrono::duration<float>(clock::now() - start).count());
+    }
+
+    // Formats the numbers of the window that just ended and starts a new one
+    void refresh(clock::time_point now)
+    {
+      async::message_queue_stats render = render_queue.collect_stats();
+      async::message_queue_stats logic = logic_queue.collect_stats();
+      float frames = static_cast<float>(std::max(window_frames, 1u));
+      double mean = window_frame_time / frames;
+      double stddev = std::sqrt(std::max(window_frame_time_squares / frames - mean * mean, 0.0));
+
+      std::snprintf(lines[0], LINE_LENGTH, "frame     max %6.2f ms  input max %6.2f ms",
+                    max_frame_time * 1000.0f, max_input_latency * 1000.0f);
+      std::snprintf(lines[1], LINE_LENGTH, "tick      max %6.2f ms  late max %6.2f ms",
+                    max_tick_time * 1000.0f, max_lateness * 1000.0f);
+      std::snprintf(lines[2], LINE_LENGTH, "render q  depth %3u/%3u  wait %6.3f/%6.3f ms",
+                    static_cast<unsigned int>(render.depth), static_cast<unsigned int>(render.max_depth),
+                    mean_wait_ms(render), to_ms(render.max_wait));
+      std::snprintf(lines[3], LINE_LENGTH, "logic q   depth %3u/%3u  wait %6.3f/%6.3f ms",
+                    static_cast<unsigned int>(logic.depth), static_cast<unsigned int>(logic.max_depth),
+                    mean_wait_ms(logic), to_ms(logic.max_wait));
+      std::snprintf(lines[4], LINE_LENGTH, "allocs    %8.1f / frame", window_allocations / frames);
+      std::snprintf(lines[5], LINE_LENGTH, "overlay   max %6.3f ms", max_show_time * 1000.0f);
+      if (pacing.mode == PACING_CAP) {
+        std::snprintf(lines[6], LINE_LENGTH, "interval  mean %6.2f sd %6.3f ms  cap %.0f fps",
+                      mean * 1000.0, stddev * 1000.0, pacing.fps_cap);
+      } else {
+        std::snprintf(lines[6], LINE_LENGTH, "interval  mean %6.2f sd %6.3f ms  %s",
+                      mean * 1000.0, stddev * 1000.0, get_pacing_mode_name(pacing.mode));
+      }
+      std::snprintf(lines[7], LINE_LENGTH, "scene     synced %7.1f / frame  max %u of %u",
+                    window_synced / frames, max_synced, scene_nodes);
+      std::snprintf(lines[8], LINE_LENGTH, "queues: depth now/max, wait mean/max");
+
+      window_start = now;
+      window_frames = 0;
+      window_frame_time = 0.0;
+      window_frame_time_squares = 0.0;
+      window_allocations = 0;
+      window_synced = 0;
+      max_synced = 0;
+      max_frame_time = 0.0f;
+      max_tick_time = 0.0f;
+      max_lateness = 0.0f;
+      max_input_latency = 0.0f;
+      max_show_time = 0.0f;
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    async::message_queue& render_queue;
+    async::message_queue& logic_queue;
+    float frame_times[GRAPH_FRAMES];          // ring buffer of frame times in seconds
+    unsigned int next_frame;                  // oldest frame time, next one to be overwritten
+    unsigned long last_allocations;           // allocation count at the last frame
+    clock::time_point window_start;
+    unsigned int window_frames;
+    double window_frame_time;                 // sum of the frame times of the window, in seconds
+    double window_frame_time_squares;
+    frame_pacing pacing;
+    unsigned long window_synced;              // scene nodes synced in the window
+    unsigned int max_synced;                  // in a single frame of the window
+    unsigned int scene_nodes;
+    unsigned long window_allocations;
+    float max_frame_time;
+    float max_tick_time;
+    float max_lateness;
+    float max_input_latency;
+    float max_show_time;
+    bool visible;
+    char lines[LINE_COUNT][LINE_LENGTH];
+    float verts[GRAPH_FRAMES * 16];           // room for one quad per bar
+  }; // class perf_overlay::perf_overlay_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  perf_overlay::perf_overlay(async::message_queue& render_queue, async::message_queue& logic_queue) :
+    impl(std::make_unique<perf_overlay::perf_overlay_impl>(render_queue, logic_queue)) {
+
+  }
+
+  perf_overlay::~perf_overlay() {
+
+  }
+
+  void perf_overlay::record_frame(float frame_time)
+  {
+    impl->record_frame(frame_time);
+  }
+
+  void perf_overlay::set_visible(bool visible)
+  {
+    impl->set_visible(visible);
+  }
+
+  void perf_overlay::set_pacing(const frame_pacing& pacing)
+  {
+    impl->set_pacing(pacing);
+  }
+
+  void perf_overlay::record_scene_sync(unsigned int synced, unsigned int node_count)
+  {
+    impl->record_scene_sync(synced, node_count);
+  }
+
+  void perf_overlay::show(const logic_metrics& logic, float aspect, int font_material, int panel_material)
+  {
+    impl->show(logic, aspect, font_material, panel_material);
+  }
+} // namespace bogart
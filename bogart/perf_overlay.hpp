@@ -0,0 +1,81 @@
+#ifndef PERF_OVERLAY_HPP
+#define PERF_OVERLAY_HPP
+
+#include "bogart/async/message_queue.hpp"
+#include "bogart/view.hpp"
+
+#include <memory>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class perf_overlay
+  //! @ingroup bogart
+  //!
+  //! Performance overlay shown with F6 below the Horde3D frame stats. It draws a graph of the
+  //! interval of the last frames against the 60 and 30 Hz budgets, and lists the mean and standard
+  //! deviation of the frame interval under the current pacing mode, the scene nodes synced per
+  //! frame, the logic tick duration, the timer lateness of the tick, the depth and wait times of
+  //! the render and logic queues, the allocations per frame and what the overlay itself costs. The
+  //! numbers are the worst (or the mean, for waits and allocations) of the last quarter of a
+  //! second, so that they can be read.
+  //!
+  //! show() does not allocate: text is formatted into fixed buffers, and only when the numbers are
+  //! refreshed.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class perf_overlay
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    perf_overlay(async::message_queue& render_queue, async::message_queue& logic_queue);
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor
+    //----------------------------------------------------------------------------------------------
+    ~perf_overlay();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Accounts for a frame. Call once per frame, whether the overlay is shown or not.
+    //! @param frame_time time since the start of the previous frame, in seconds
+    //----------------------------------------------------------------------------------------------
+    void record_frame(float frame_time);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Sets the frame pacing to list with the frame interval statistics.
+    //----------------------------------------------------------------------------------------------
+    void set_pacing(const frame_pacing& pacing);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Accounts for the scene sync of a frame: synced nodes out of a scene of node_count.
+    //----------------------------------------------------------------------------------------------
+    void record_scene_sync(unsigned int synced, unsigned int node_count);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Tells the overlay whether it's shown. The queues only collect the stats it lists
+    //!  while it is. Call once per frame.
+    //----------------------------------------------------------------------------------------------
+    void set_visible(bool visible);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Adds the overlays for this frame. Call before h3dRender(), which draws them in the
+    //!  overlay stage of the pipeline.
+    //! @param aspect aspect ratio of the viewport, which is the width of the overlay space
+    //----------------------------------------------------------------------------------------------
+    void show(const logic_metrics& logic, float aspect, int font_material, int panel_material);
+
+  private:
+    class perf_overlay_impl;                            //!< implementation class (Pimpl idiom)
+    std::unique_ptr<perf_overlay_impl> impl;            //!< pointer to implementation (Pimpl idiom)
+  }; // class perf_overlay
+} // namespace bogart
+
+#endif // PERF_OVERLAY_HPP
@@ -0,0 +1,32 @@
+#include "bogart/player_camera.hpp"
+
+#include <glm/trigonometric.hpp>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  player_camera::player_camera() : m_state(), m_pitch(0.0f), m_yaw(0.0f), m_valid(false)
+  {
+
+  }
+
+  const camera_state& player_camera::get(const world::entity_world& w, world::entity e)
+  {
+    float pitch = w.get_pitch(e);
+    float yaw = w.get_yaw(e);
+    if (!m_valid || pitch != m_pitch || yaw != m_yaw) {
+      m_state.orientation = glm::angleAxis(glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                            glm::angleAxis(glm::radians(pitch), glm::vec3(1.0f, 0.0f, 0.0f));
+      m_state.transform = glm::mat4_cast(m_state.orientation);
+      m_pitch = pitch;
+      m_yaw = yaw;
+      m_valid = true;
+    }
+
+    m_state.position = w.get_position(e);
+    m_state.transform[3] = glm::vec4(m_state.position, 1.0f);
+    return m_state;
+  }
+} // namespace bogart
@@ -0,0 +1,44 @@
+#ifndef PLAYER_CAMERA_HPP
+#define PLAYER_CAMERA_HPP
+
+#include "bogart/world/entity_world.hpp"
+#include "bogart/view.hpp"
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class player_camera
+  //! @ingroup bogart
+  //!
+  //! Camera of an entity of the world, at its position and looking along its pitch and yaw. The
+  //! rotation is cached and only rebuilt when it's read after the entity turned, so turning several
+  //! times between two reads (one input batch each) builds it once, and steps in which the entity
+  //! doesn't turn build none. Moving only updates the translation.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class player_camera
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    player_camera();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the camera of entity e of w. The orientation is a rotation of pitch degrees
+    //!  around X and then yaw around Y, the same one Horde3D builds from Euler angles (pitch, yaw,
+    //!  0).
+    //----------------------------------------------------------------------------------------------
+    const camera_state& get(const world::entity_world& w, world::entity e);
+
+  private:
+    camera_state m_state;              // last camera returned, its rotation is that of m_pitch, m_yaw
+    float m_pitch;                     // In degrees
+    float m_yaw;                       // In degrees
+    bool m_valid;                      // false until the rotation is first built
+  }; // class player_camera
+} // namespace bogart
+
+#endif // PLAYER_CAMERA_HPP
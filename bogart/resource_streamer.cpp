@@ -0,0 +1,262 @@
+#include "bogart/service/content_dir.hpp"
+#include "bogart/resource_streamer.hpp"
+#include "bogart/log/log.hpp"
+
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <set>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    struct read_request
+    {
+      read_request() : res(0), name(), content_dir(), generation(0)
+      {
+
+      }
+
+      read_request(int res, const std::string& name, const std::string& content_dir, unsigned int generation) :
+        res(res), name(name), content_dir(content_dir), generation(generation)
+      {
+
+      }
+
+      int res;
+      std::string name;
+      std::string content_dir;
+      unsigned int generation;    // of the start() call that issued the request
+    };
+
+    struct read_result
+    {
+      read_result() : res(0), name(), data(), found(false), generation(0)
+      {
+
+      }
+
+      int res;
+      std::string name;
+      std::vector<char> data;
+      bool found;
+      unsigned int generation;
+    };
+
+    // Reads a whole file from the first content directory that has it
+    bool read_file(const std::string& content_dir, const std::string& name, std::vector<char>& data)
+    {
+      std::string path;
+      if (!service::find_content_file(content_dir, name, path)) {
+        return false;
+      }
+
+      std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+      if (!in) {
+        return false;
+      }
+      data.resize(static_cast<std::size_t>(in.tellg()));
+      in.seekg(0);
+      return static_cast<bool>(in.read(data.data(), data.size()));
+    }
+  } // Anonymous namespace
+
+  class resource_streamer::resource_streamer_impl
+  {
+  public:
+    resource_streamer_impl(resource_engine& engine, unsigned int io_threads) :
+      engine(engine),
+      threads(),
+      requests(),
+      results(),
+      mtx(),
+      more(),
+      stopping(false),
+      content_dir(),
+      requested(),
+      progress(),
+      failures(0),
+      generation(0)
+    {
+      for (unsigned int i = 0; i < std::max(io_threads, 1u); i++) {
+        threads.push_back(std::thread([this]() { io_loop(); }));
+      }
+    }
+
+    ~resource_streamer_impl()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        stopping = true;
+        more.notify_all();
+      }
+
+      for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); it++) {
+        it->join();
+      }
+    }
+
+    void io_loop()
+    {
+      while (true) {
+        read_request request;
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          more.wait(lock, [this]() { return stopping || !requests.empty(); });
+          if (stopping) {
+            return;
+          }
+          request = std::move(requests.front());
+          requests.pop_front();
+        }
+
+        read_result result;
+        result.res = request.res;
+        result.name = std::move(request.name);
+        result.generation = request.generation;
+        result.found = read_file(request.content_dir, result.name, result.data);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        results.push_back(std::move(result));
+      }
+    }
+
+    // Queues reads for the unloaded resources we haven't asked for yet
+    void request_unloaded()
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      int res = 0;
+      for (int i = 0; (res = engine.query_unloaded(i)) != 0; i++) {
+        if (requested.insert(res).second) {
+          requests.push_back(read_request(res, engine.get_name(res), content_dir, generation));
+          progress.total++;
+        }
+      }
+      more.notify_all();
+    }
+
+    bool pop_result(read_result& result)
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      while (!results.empty()) {
+        result = std::move(results.front());
+        results.pop_front();
+        // Reads issued before a cancel() are for resources that may not exist anymore
+        if (result.generation == generation) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    void update(clock::duration budget)
+    {
+      if (progress.done) {
+        return;
+      }
+
+      clock::time_point start = clock::now();
+      read_result result;
+      while (pop_result(result)) {
+        if (!result.found) {
+          log::error(std::string("Could not find resource file: ") + result.name);
+          failures++;
+        }
+        // Without data the engine uses its default for the resource
+        engine.load(result.res, result.found ? result.data.data() : 0, static_cast<int>(result.data.size()));
+        progress.loaded++;
+
+        if (clock::now() - start >= budget) {
+          break;
+        }
+      }
+
+      request_unloaded();
+      if (progress.loaded == progress.total) {
+        progress.done = true;
+        if (failures) {
+          log::error("There were some errors loading resources from disk. See log for details. "
+                     "Continuing anyway");
+        }
+      }
+    }
+
+    void cancel()
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      generation++;
+      requests.clear();
+      results.clear();
+      requested.clear();
+      progress = loading_progress();
+      failures = 0;
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    resource_engine& engine;
+    std::vector<std::thread> threads;
+    std::deque<read_request> requests;
+    std::deque<read_result> results;
+    std::mutex mtx;                       // protects requests, results, stopping and generation
+    std::condition_variable more;         // signals requests to the I/O threads
+    bool stopping;
+    std::string content_dir;
+    std::set<int> requested;              // resources read or being read since start()
+    loading_progress progress;
+    unsigned int failures;
+    unsigned int generation;
+  }; // class resource_streamer::resource_streamer_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  resource_streamer::resource_streamer(resource_engine& engine, unsigned int io_threads) :
+    impl(std::make_unique<resource_streamer::resource_streamer_impl>(engine, io_threads))
+  {
+
+  }
+
+  resource_streamer::~resource_streamer()
+  {
+
+  }
+
+  void resource_streamer::start(const std::string& content_dir)
+  {
+    impl->cancel();
+    impl->content_dir = content_dir;
+    impl->progress.done = false;
+    impl->request_unloaded();
+  }
+
+  void resource_streamer::update(clock::duration budget)
+  {
+    impl->update(budget);
+  }
+
+  void resource_streamer::cancel()
+  {
+    impl->cancel();
+  }
+
+  bool resource_streamer::is_loading() const
+  {
+    return !impl->progress.done;
+  }
+
+  loading_progress resource_streamer::get_progress() const
+  {
+    return impl->progress;
+  }
+} // namespace bogart
@@ -0,0 +1,110 @@
+#ifndef RESOURCE_STREAMER_HPP
+#define RESOURCE_STREAMER_HPP
+
+#include "bogart/view.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class resource_engine
+  //! @ingroup bogart
+  //!
+  //! The engine calls resource_streamer makes. Resources are engine handles, 0 being none. The
+  //! view implements them on Horde3D, tests can implement them on anything else.
+  //------------------------------------------------------------------------------------------------
+  class resource_engine
+  {
+  public:
+    resource_engine() {}
+    virtual ~resource_engine() {}
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Returns the index-th resource that isn't loaded, or 0 if there are no more, like
+    //!  h3dQueryUnloadedResource().
+    //----------------------------------------------------------------------------------------------
+    virtual int query_unloaded(int index) = 0;
+
+    virtual std::string get_name(int res) = 0;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Loads a resource from size bytes at data. Null data loads the engine default.
+    //!  Loading may add the resources it references.
+    //----------------------------------------------------------------------------------------------
+    virtual void load(int res, const char* data, int size) = 0;
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @class resource_streamer
+  //! @ingroup bogart
+  //!
+  //! Loads the engine resources that aren't loaded yet without blocking the render thread for
+  //! long. Files are read on background I/O threads, and update() hands the buffered bytes to
+  //! resource_engine::load() in slices of a given duration, so that the render thread can keep drawing
+  //! frames in between. Loading a resource may add the resources it references (the geometry and
+  //! materials of a scene graph, the textures of a material...), which are picked up and read in
+  //! turn, so the total of the progress can grow while loading.
+  //!
+  //! Files are looked up in the content directories the same way h3dutLoadResourcesFromDisk()
+  //! does: several directories can be given separated by '|', and the first one that has the file
+  //! wins. Resources whose files can't be found are loaded with no data, which makes the engine
+  //! use its default for them.
+  //!
+  //! Reads are handed to the engine in the order they finish. A resource is never loaded before the
+  //! one that referenced it, since it isn't requested until that one is loaded.
+  //!
+  //! Thread-safety: all methods must be called from the thread that owns the engine.
+  //------------------------------------------------------------------------------------------------
+  class resource_streamer
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    typedef std::chrono::steady_clock clock;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //! @param engine Must outlive the streamer.
+    //! @param io_threads Threads to read files on. Zero is taken as one.
+    //----------------------------------------------------------------------------------------------
+    resource_streamer(resource_engine& engine, unsigned int io_threads);
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor. Waits for the reads in progress to end.
+    //----------------------------------------------------------------------------------------------
+    ~resource_streamer();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Starts loading every resource that isn't loaded, from content_dir.
+    //----------------------------------------------------------------------------------------------
+    void start(const std::string& content_dir);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Hands the files read so far to the engine until budget runs out (at least one file
+    //!  per call), and starts reading the resources they added. Call once per frame.
+    //----------------------------------------------------------------------------------------------
+    void update(clock::duration budget);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Drops everything that is queued or being read. Call before releasing the engine.
+    //----------------------------------------------------------------------------------------------
+    void cancel();
+
+    bool is_loading() const;
+    loading_progress get_progress() const;
+
+  private:
+    class resource_streamer_impl;                   //!< implementation class (Pimpl idiom)
+    std::unique_ptr<resource_streamer_impl> impl;   //!< pointer to implementation (Pimpl idiom)
+  }; // class resource_streamer
+} // namespace bogart
+
+#endif // RESOURCE_STREAMER_HPP
@@ -0,0 +1,107 @@
+#include "bogart/scene_mirror.hpp"
+
+namespace bogart
+{
+  class scene_mirror::scene_mirror_impl
+  {
+  public:
+    scene_mirror_impl() : transforms(), flags(), dirty(), dirty_nodes(), mtx()
+    {
+
+    }
+
+    void mark_dirty(std::uint32_t node)
+    {
+      if (!dirty[node]) {
+        dirty[node] = 1;
+        dirty_nodes.push_back(node);
+      }
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! Member variables
+    //----------------------------------------------------------------------------------------------
+    std::vector<glm::mat4> transforms;
+    std::vector<std::uint32_t> flags;
+    std::vector<std::uint8_t> dirty;
+    std::vector<std::uint32_t> dirty_nodes;     // nodes with their dirty bit set, in no order
+    std::mutex mtx;
+  }; // class scene_mirror::scene_mirror_impl
+
+  //------------------------------------------------------------------------------------------------
+  //! Private member functions.
+  //------------------------------------------------------------------------------------------------
+  scene_mirror::writer::writer(scene_mirror_impl& impl) : impl(&impl), lock(impl.mtx)
+  {
+
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  scene_mirror::scene_mirror() : impl(std::make_unique<scene_mirror::scene_mirror_impl>())
+  {
+
+  }
+
+  scene_mirror::~scene_mirror()
+  {
+
+  }
+
+  scene_mirror::writer scene_mirror::begin_update()
+  {
+    return writer(*impl);
+  }
+
+  std::uint32_t scene_mirror::writer::add_node(const glm::mat4& transform, std::uint32_t flags)
+  {
+    std::uint32_t node = static_cast<std::uint32_t>(impl->transforms.size());
+    impl->transforms.push_back(transform);
+    impl->flags.push_back(flags);
+    impl->dirty.push_back(0);
+    impl->mark_dirty(node);
+    return node;
+  }
+
+  void scene_mirror::writer::set_transform(std::uint32_t node, const glm::mat4& transform)
+  {
+    if (impl->transforms[node] != transform) {
+      impl->transforms[node] = transform;
+      impl->mark_dirty(node);
+    }
+  }
+
+  void scene_mirror::writer::set_flags(std::uint32_t node, std::uint32_t flags)
+  {
+    if (impl->flags[node] != flags) {
+      impl->flags[node] = flags;
+      impl->mark_dirty(node);
+    }
+  }
+
+  std::size_t scene_mirror::get_node_count()
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    return impl->transforms.size();
+  }
+
+  void scene_mirror::collect(scene_node_update_vector& updates)
+  {
+    updates.clear();
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    for (std::vector<std::uint32_t>::const_iterator it = impl->dirty_nodes.begin(); it != impl->dirty_nodes.end(); it++) {
+      updates.push_back(scene_node_update(*it, impl->transforms[*it], impl->flags[*it]));
+      impl->dirty[*it] = 0;
+    }
+    impl->dirty_nodes.clear();
+  }
+
+  void scene_mirror::mark_all_dirty()
+  {
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    for (std::uint32_t node = 0; node < impl->dirty.size(); node++) {
+      impl->mark_dirty(node);
+    }
+  }
+} // namespace bogart
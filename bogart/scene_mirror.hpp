@@ -0,0 +1,118 @@
+#ifndef SCENE_MIRROR_HPP
+#define SCENE_MIRROR_HPP
+
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bogart
+{
+  //------------------------------------------------------------------------------------------------
+  //! Flags of scene mirror nodes
+  //------------------------------------------------------------------------------------------------
+  const std::uint32_t SCENE_NODE_HIDDEN = 0x1;
+
+  // A node that changed since the last sync, as handed to the render thread
+  struct scene_node_update
+  {
+    scene_node_update() : node(0), transform(1.0f), flags(0)
+    {
+
+    }
+
+    scene_node_update(std::uint32_t node, const glm::mat4& transform, std::uint32_t flags) :
+      node(node), transform(transform), flags(flags)
+    {
+
+    }
+
+    std::uint32_t node;
+    glm::mat4 transform;
+    std::uint32_t flags;
+  };
+
+  typedef std::vector<scene_node_update> scene_node_update_vector;
+
+  //------------------------------------------------------------------------------------------------
+  //! @class scene_mirror
+  //! @ingroup bogart
+  //!
+  //! Copy of the dynamic part of the scene kept on the application side. The logic thread writes
+  //! it, and the render thread syncs the engine with it once per frame. Nodes are numbered from
+  //! zero in the order they are added, and their transforms, flags and dirty bits are kept in
+  //! contiguous arrays. Writing a node with the values it already has doesn't make it dirty, so
+  //! nodes that don't change cost nothing to sync.
+  //!
+  //! The logic thread writes a whole batch through the writer that begin_update() returns, which
+  //! holds the lock until it goes out of scope. The render thread takes the lock once per frame in
+  //! collect(), which only copies the dirty nodes out, and talks to the engine after releasing it.
+  //!
+  //! Thread-safety: all public methods are thread-safe. A writer must only be used from the thread
+  //! that got it, and that thread must not call other methods of the mirror while it holds it.
+  //------------------------------------------------------------------------------------------------
+  class scene_mirror
+  {
+    class scene_mirror_impl;
+
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! @class writer
+    //!
+    //! Write access to the mirror. Holds the lock of the mirror from begin_update() until it is
+    //! destroyed, also when a write throws.
+    //----------------------------------------------------------------------------------------------
+    class writer
+    {
+    public:
+      writer(writer&& other) = default;
+
+      std::uint32_t add_node(const glm::mat4& transform, std::uint32_t flags);
+      void set_transform(std::uint32_t node, const glm::mat4& transform);
+      void set_flags(std::uint32_t node, std::uint32_t flags);
+
+    private:
+      friend class scene_mirror;
+      explicit writer(scene_mirror_impl& impl);
+
+      scene_mirror_impl* impl;
+      std::unique_lock<std::mutex> lock;
+    }; // class writer
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    scene_mirror();
+
+    //----------------------------------------------------------------------------------------------
+    //! Destructor
+    //----------------------------------------------------------------------------------------------
+    ~scene_mirror();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    writer begin_update();
+    std::size_t get_node_count();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Replaces the contents of updates with the nodes that changed since the last call,
+    //!  and clears their dirty bits. Reusing the same vector every frame avoids allocations.
+    //----------------------------------------------------------------------------------------------
+    void collect(scene_node_update_vector& updates);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Makes every node dirty, so that the next collect() returns all of them. For views
+    //!  that lost their engine nodes, for example on a tear down.
+    //----------------------------------------------------------------------------------------------
+    void mark_all_dirty();
+
+  private:
+    std::unique_ptr<scene_mirror_impl> impl;    //!< pointer to implementation (Pimpl idiom)
+  }; // class scene_mirror
+} // namespace bogart
+
+#endif // SCENE_MIRROR_HPP
@@ -1,5 +1,7 @@
 #include "bogart/service/cmd_line_args.hpp"
 
+#include <sstream>
+
 namespace bogart
 {
 namespace service
@@ -32,5 +34,14 @@ namespace service
 
     return default_value;
   }
+
+  float cmd_line_args::get_float_option(const std::string& option, float default_value) const
+  {
+    float ret = default_value;
+    std::stringstream ss;
+    ss << get_option_value(option, "");
+    ss >> ret;
+    return ss ? ret : default_value;
+  }
 }
 }
@@ -17,6 +17,9 @@ namespace service
     bool has_option(const std::string& option) const;
     std::string get_option_value(const std::string& option, const std::string& default_value) const;
 
+    // Value of option as a number, or default_value if it's missing or not a number
+    float get_float_option(const std::string& option, float default_value) const;
+
   private:
     std::map<std::string, std::string> options;
   };
@@ -0,0 +1,96 @@
+#include "bogart/service/content_dir.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const std::string OPTION_CONTENT_DIR = "-content-dir";
+
+    bool is_readable(const std::string& path)
+    {
+      std::ifstream in(path.c_str(), std::ios::binary);
+      return static_cast<bool>(in);
+    }
+
+    // Absolute path of an existing file or directory, with no links, '.' or '..' in it
+    bool get_real_path(const std::string& path, std::string& real_path)
+    {
+      char* p = realpath(path.empty() ? "." : path.c_str(), nullptr);
+      if (p == nullptr) {
+        return false;
+      }
+      real_path = p;
+      std::free(p);
+      return true;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  std::string get_content_dir(const cmd_line_args& args)
+  {
+    return args.get_option_value(OPTION_CONTENT_DIR, "");
+  }
+
+  bool find_content_file(const std::string& content_dir, const std::string& name, std::string& path)
+  {
+    if (!name.empty() && name[0] == '/') {
+      if (!is_readable(name)) {
+        return false;
+      }
+      path = name;
+      return true;
+    }
+
+    std::stringstream dirs(content_dir);
+    std::string dir;
+    do {
+      std::getline(dirs, dir, '|');
+      std::string candidate = dir.empty() ? name : dir + "/" + name;
+      if (is_readable(candidate)) {
+        path = candidate;
+        return true;
+      }
+    } while (dirs);
+
+    return false;
+  }
+
+  bool is_in_content_dir(const std::string& content_dir, const std::string& path)
+  {
+    std::string real_path;
+    if (!get_real_path(path, real_path)) {
+      return false;
+    }
+
+    std::stringstream dirs(content_dir);
+    std::string dir;
+    do {
+      std::getline(dirs, dir, '|');
+      std::string real_dir;
+      if (!get_real_path(dir, real_dir)) {
+        continue;
+      }
+      std::string prefix = (real_dir == "/") ? real_dir : real_dir + "/";
+      if (real_path == real_dir || real_path.compare(0, prefix.size(), prefix) == 0) {
+        return true;
+      }
+    } while (dirs);
+
+    return false;
+  }
+} // namespace service
+} // namespace bogart
@@ -0,0 +1,33 @@
+#ifndef CONTENT_DIR_HPP
+#define CONTENT_DIR_HPP
+
+#include "bogart/service/cmd_line_args.hpp"
+
+#include <string>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! @brief Returns the value of -content-dir: one directory, or several separated by '|' that are
+  //!  searched in order. Empty if the option is missing.
+  //------------------------------------------------------------------------------------------------
+  std::string get_content_dir(const cmd_line_args& args);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Finds name in the first directory of content_dir that has it. Absolute names and an
+  //!  empty content_dir are taken as they are.
+  //! @return false if no directory has a file called name. path is left unchanged in that case.
+  //------------------------------------------------------------------------------------------------
+  bool find_content_file(const std::string& content_dir, const std::string& name, std::string& path);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Whether the directory path is one of the directories of content_dir or is inside one of
+  //!  them. Directories that don't exist are in none. An empty content_dir is the working directory.
+  //------------------------------------------------------------------------------------------------
+  bool is_in_content_dir(const std::string& content_dir, const std::string& path);
+} // namespace service
+} // namespace bogart
+
+#endif // CONTENT_DIR_HPP
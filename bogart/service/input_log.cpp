@@ -0,0 +1,161 @@
+#include "bogart/service/input_log.hpp"
+#include "bogart/log/log.hpp"
+
+#include <cstring>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const char MAGIC[4] = { 'B', 'G', 'I', 'L' };
+    const std::uint32_t VERSION = 2;
+
+    template<typename T>
+    void write_value(std::ofstream& out, T value)
+    {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool read_value(std::ifstream& in, T& value)
+    {
+      return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  input_recorder::input_recorder() : out()
+  {
+
+  }
+
+  input_recorder::~input_recorder()
+  {
+    close();
+  }
+
+  bool input_recorder::open(const std::string& path)
+  {
+    close();
+    out.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      log::error(std::string("Could not open input log for writing: ") + path);
+      return false;
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    write_value(out, VERSION);
+    return static_cast<bool>(out);
+  }
+
+  bool input_recorder::is_open() const
+  {
+    return out.is_open();
+  }
+
+  void input_recorder::write(std::uint64_t time, const event_vector& events)
+  {
+    if (!out.is_open()) {
+      return;
+    }
+
+    write_value(out, static_cast<std::uint8_t>(INPUT_RECORD_EVENTS));
+    write_value(out, time);
+    write_value(out, static_cast<std::uint32_t>(events.size()));
+    for (event_vector::const_iterator it = events.begin(); it != events.end(); it++) {
+      write_value(out, static_cast<std::uint8_t>(it->type));
+      write_value(out, static_cast<std::uint16_t>(it->value));
+      write_value(out, it->mouse_x);
+      write_value(out, it->mouse_y);
+    }
+  }
+
+  void input_recorder::write_tick(std::uint64_t time, float dt)
+  {
+    if (!out.is_open()) {
+      return;
+    }
+
+    write_value(out, static_cast<std::uint8_t>(INPUT_RECORD_TICK));
+    write_value(out, time);
+    write_value(out, dt);
+  }
+
+  void input_recorder::close()
+  {
+    if (out.is_open()) {
+      out.close();
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool load_input_log(const std::string& path, input_batch_vector& batches)
+  {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+      log::error(std::string("Could not open input log: ") + path);
+      return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !read_value(in, version) || version != VERSION) {
+      log::error(std::string("Not a valid input log: ") + path);
+      return false;
+    }
+
+    std::uint8_t record_type = 0;
+    std::uint32_t count = 0;
+    while (read_value(in, record_type)) {
+      input_batch batch;
+      batch.type = static_cast<input_record_type>(record_type);
+      if (!read_value(in, batch.time)) {
+        log::error(std::string("Truncated input log: ") + path);
+        return false;
+      }
+
+      if (batch.type == INPUT_RECORD_TICK) {
+        if (!read_value(in, batch.dt)) {
+          log::error(std::string("Truncated input log: ") + path);
+          return false;
+        }
+        batches.push_back(batch);
+        continue;
+      }
+
+      if (batch.type != INPUT_RECORD_EVENTS || !read_value(in, count)) {
+        log::error(std::string("Truncated or corrupt input log: ") + path);
+        return false;
+      }
+
+      for (std::uint32_t i = 0; i < count; i++) {
+        std::uint8_t type = 0;
+        std::uint16_t key = 0;
+        float x = 0.0f;
+        float y = 0.0f;
+        if (!read_value(in, type) || !read_value(in, key) || !read_value(in, x) || !read_value(in, y)) {
+          log::error(std::string("Truncated input log: ") + path);
+          return false;
+        }
+        batch.events.push_back(event(static_cast<event_type>(type), static_cast<key_code>(key), x, y));
+      }
+      batches.push_back(batch);
+    }
+
+    return true;
+  }
+} // namespace service
+} // namespace bogart
@@ -0,0 +1,80 @@
+#ifndef INPUT_LOG_HPP
+#define INPUT_LOG_HPP
+
+#include "bogart/event.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Input logs store the event batches produced by system::poll_events() and the timestep of every
+  //! logic tick, in the order they happened, so that a session can be replayed exactly. The format
+  //! is binary, in the byte order of the machine that wrote it:
+  //!
+  //!   header: "BGIL" magic, uint32 version
+  //!   record: uint8 type, uint64 time in microseconds since the start of the recording, followed
+  //!           by the payload of the type
+  //!   events: uint32 event count, followed by the events
+  //!   event:  uint8 type, uint16 key, float mouse_x, float mouse_y
+  //!   tick:   float dt in seconds
+  //------------------------------------------------------------------------------------------------
+  enum input_record_type
+  {
+    INPUT_RECORD_EVENTS = 0,
+    INPUT_RECORD_TICK
+  };
+
+  struct input_batch
+  {
+    input_batch() : type(INPUT_RECORD_EVENTS), time(0), dt(0.0f), events()
+    {
+
+    }
+
+    input_record_type type;
+    std::uint64_t time; // microseconds since the start of the recording
+    float dt;           // timestep of a tick, in seconds
+    event_vector events;
+  };
+
+  typedef std::vector<input_batch> input_batch_vector;
+
+  //------------------------------------------------------------------------------------------------
+  //! @class input_recorder
+  //! @ingroup service
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class input_recorder
+  {
+  public:
+    input_recorder();
+    ~input_recorder();
+
+    bool open(const std::string& path);
+    bool is_open() const;
+    void write(std::uint64_t time, const event_vector& events);
+    void write_tick(std::uint64_t time, float dt);
+    void close();
+
+  private:
+    std::ofstream out;
+  }; // class input_recorder
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Reads a whole input log into memory.
+  //! @return false if the file can't be opened or is not a valid input log. Batches read before
+  //!  an error are kept.
+  //------------------------------------------------------------------------------------------------
+  bool load_input_log(const std::string& path, input_batch_vector& batches);
+} // namespace service
+} // namespace bogart
+
+#endif // INPUT_LOG_HPP
@@ -0,0 +1,86 @@
+#include "bogart/service/input_state.hpp"
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const size_t INITIAL_PRESS_CAPACITY = 16;
+
+    bool is_valid(key_code key)
+    {
+      return (key >= 0 && key <= KEY_LAST);
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  input_state::input_state() :
+    keys(),
+    presses(),
+    mouse_x(0.0f),
+    mouse_y(0.0f),
+    mouse_dx(0.0f),
+    mouse_dy(0.0f)
+  {
+    presses.reserve(INITIAL_PRESS_CAPACITY);
+  }
+
+  void input_state::process(const event_vector& events)
+  {
+    presses.clear();
+    mouse_dx = 0.0f;
+    mouse_dy = 0.0f;
+
+    for (event_vector::const_iterator it = events.begin(); it != events.end(); it++) {
+      if (it->type == EVENT_MOUSE_MOVE) {
+        mouse_dx += it->mouse_x - mouse_x;
+        mouse_dy += it->mouse_y - mouse_y;
+        mouse_x = it->mouse_x;
+        mouse_y = it->mouse_y;
+      } else if (is_valid(it->value)) {
+        if (it->type == EVENT_KEY_PRESS) {
+          keys.set(it->value);
+          presses.push_back(it->value);
+        } else if (it->type == EVENT_KEY_RELEASE) {
+          keys.reset(it->value);
+        }
+      }
+    }
+  }
+
+  void input_state::reset_mouse(float x, float y)
+  {
+    mouse_x = x;
+    mouse_y = y;
+  }
+
+  bool input_state::is_key_down(key_code key) const
+  {
+    return is_valid(key) && keys.test(key);
+  }
+
+  const input_state::key_code_vector& input_state::get_presses() const
+  {
+    return presses;
+  }
+
+  float input_state::get_mouse_dx() const
+  {
+    return mouse_dx;
+  }
+
+  float input_state::get_mouse_dy() const
+  {
+    return mouse_dy;
+  }
+} // namespace service
+} // namespace bogart
@@ -0,0 +1,71 @@
+#ifndef INPUT_STATE_HPP
+#define INPUT_STATE_HPP
+
+#include "bogart/event.hpp"
+
+#include <bitset>
+#include <vector>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class input_state
+  //! @ingroup service
+  //!
+  //! Folds batches of input events into the state the controller acts on: which keys are held
+  //! down, the total mouse motion of the batch and the keys that were pressed during the batch, in
+  //! order. A 1000 Hz mouse produces dozens of motion events per batch, and the controller only
+  //! needs their sum.
+  //!
+  //! process() does not allocate once the list of presses has grown to the largest number of
+  //! presses seen in a batch.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class input_state
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Types
+    //----------------------------------------------------------------------------------------------
+    typedef std::vector<key_code> key_code_vector;
+
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    input_state();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Starts a new batch and applies the events in it.
+    //----------------------------------------------------------------------------------------------
+    void process(const event_vector& events);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Sets the mouse position the motion of the next batch is measured from.
+    //----------------------------------------------------------------------------------------------
+    void reset_mouse(float x, float y);
+
+    bool is_key_down(key_code key) const;
+    const key_code_vector& get_presses() const; //!< keys pressed in the last batch, in order
+    float get_mouse_dx() const;                  //!< mouse motion in the last batch
+    float get_mouse_dy() const;                  //!< mouse motion in the last batch
+
+  private:
+    std::bitset<KEY_LAST + 1> keys;
+    key_code_vector presses;
+    float mouse_x;
+    float mouse_y;
+    float mouse_dx;
+    float mouse_dy;
+  }; // class input_state
+} // namespace service
+} // namespace bogart
+
+#endif // INPUT_STATE_HPP
@@ -0,0 +1,105 @@
+#include "bogart/service/resolution_scaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const float SCALE_STEP = 0.05f;
+    const float SMOOTHING = 0.1f;            // weight of a new frame in the average
+    const float OVER_BUDGET = 1.05f;         // frames slower than this times the target are over
+    const float UNDER_BUDGET = 0.8f;         // frames faster than this times the target are under
+    const unsigned int OVER_FRAMES = 8;      // frames over budget before the scale drops
+    const unsigned int UNDER_FRAMES = 60;    // frames under budget before the scale grows
+    const unsigned int SETTLE_FRAMES = 15;   // frames ignored after a change
+    const unsigned int MIN_SAMPLES = 4;      // frames averaged before acting on the average
+
+    float quantize_down(float scale)
+    {
+      return std::floor(scale / SCALE_STEP + 1e-3f) * SCALE_STEP;
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  resolution_scaler::resolution_scaler(float target_frame_time, float min_scale, float max_scale) :
+    target_frame_time(target_frame_time),
+    min_scale(min_scale),
+    max_scale(std::max(min_scale, max_scale)),
+    scale(this->max_scale),
+    average(0.0f),
+    samples(0),
+    settle_frames(0),
+    over_frames(0),
+    under_frames(0)
+  {
+
+  }
+
+  bool resolution_scaler::update(float frame_time)
+  {
+    if (settle_frames > 0) {
+      settle_frames--;
+      return false;
+    }
+
+    average = (samples == 0) ? frame_time : average + SMOOTHING * (frame_time - average);
+    samples++;
+    if (samples < MIN_SAMPLES) {
+      return false;
+    }
+
+    over_frames = (average > OVER_BUDGET * target_frame_time) ? over_frames + 1 : 0;
+    under_frames = (average < UNDER_BUDGET * target_frame_time) ? under_frames + 1 : 0;
+
+    float new_scale = scale;
+    if (over_frames >= OVER_FRAMES) {
+      // The cost of a frame grows with the number of pixels, so we scale both sides by the square
+      // root of how far over budget we are. At least one step, so that we always make progress.
+      float wanted = quantize_down(scale * std::sqrt(target_frame_time / average));
+      new_scale = std::max(min_scale, std::min(wanted, scale - SCALE_STEP));
+    } else if (under_frames >= UNDER_FRAMES) {
+      new_scale = std::min(max_scale, scale + SCALE_STEP);
+    }
+
+    if (std::fabs(new_scale - scale) < 1e-4f) {
+      return false;
+    }
+
+    scale = new_scale;
+    reset();
+    settle_frames = SETTLE_FRAMES;
+    return true;
+  }
+
+  void resolution_scaler::reset()
+  {
+    average = 0.0f;
+    samples = 0;
+    settle_frames = 0;
+    over_frames = 0;
+    under_frames = 0;
+  }
+
+  float resolution_scaler::get_scale() const
+  {
+    return scale;
+  }
+
+  float resolution_scaler::get_average_frame_time() const
+  {
+    return (samples == 0) ? 0.0f : average;
+  }
+} // namespace service
+} // namespace bogart
@@ -0,0 +1,65 @@
+#ifndef RESOLUTION_SCALER_HPP
+#define RESOLUTION_SCALER_HPP
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class resolution_scaler
+  //! @ingroup service
+  //!
+  //! Picks the fraction of the window resolution the scene is rendered at so that frames take about
+  //! as long as a target frame time. Frame times are smoothed, and the two directions have
+  //! different thresholds and delays: the scale drops soon after frames go over budget, but only
+  //! grows back after a long run of frames well under it. After every change the next few frames
+  //! are ignored while the render targets are reallocated and the average settles. Scales are
+  //! multiples of 0.05, so a small error in the estimate doesn't reallocate the render targets.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class resolution_scaler
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //! @param target_frame_time in seconds
+    //----------------------------------------------------------------------------------------------
+    resolution_scaler(float target_frame_time, float min_scale = 0.5f, float max_scale = 1.0f);
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Accounts for one frame.
+    //! @param frame_time in seconds
+    //! @return true if the scale changed
+    //----------------------------------------------------------------------------------------------
+    bool update(float frame_time);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Forgets the measured frame times but keeps the scale, for instance after the window
+    //!  is resized.
+    //----------------------------------------------------------------------------------------------
+    void reset();
+
+    float get_scale() const;
+    float get_average_frame_time() const;    //!< smoothed frame time in seconds, zero if unknown
+
+  private:
+    float target_frame_time;
+    float min_scale;
+    float max_scale;
+    float scale;
+    float average;
+    unsigned int samples;                    //!< frames in the average
+    unsigned int settle_frames;              //!< frames left to ignore after a change
+    unsigned int over_frames;                //!< consecutive frames over budget
+    unsigned int under_frames;               //!< consecutive frames well under budget
+  }; // class resolution_scaler
+} // namespace service
+} // namespace bogart
+
+#endif // RESOLUTION_SCALER_HPP
@@ -206,7 +206,7 @@ namespace service
         }
 
         if (events) {
-          events->push_back(event(event_type, key_code, 0.0f, 0.0f));
+          events->push_back(event(event_type, key_code, 0.0f, 0.0f, event::clock::now()));
         }
       }
     }
@@ -214,7 +214,7 @@ namespace service
     void mouse_move_callback(GLFWwindow*, double x, double y)
     {
       if (events) {
-        events->push_back(event(EVENT_MOUSE_MOVE, KEY_UNKNOWN, x, y));
+        events->push_back(event(EVENT_MOUSE_MOVE, KEY_UNKNOWN, x, y, event::clock::now()));
       }
     }
 
@@ -268,16 +268,41 @@ namespace service
       glfwSetCursorPosCallback(window, mouse_move_callback);
       // Hide mouse cursor and center it
       glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+
+    return (window != NULL);
+  }
+
+  bool system::is_window_open()
+  {
+    return (window != NULL);
+  }
+
+  void system::bind_context()
+  {
+    if (window) {
       // Make OpenGL context current in the calling thread
       glfwMakeContextCurrent(window);
-      // Disable vertical synchronization (results in a noticeable fps gain). This needs to be done
-      // after calling glfwMakeContextCurrent, since it acts on the current context, and the context
-      // created with glfwCreateWindow is not current until we make it explicitly so with
-      // glfwMakeContextCurrent
-      glfwSwapInterval(0);
     }
+  }
 
-    return (window != NULL);
+  void system::set_swap_interval(int interval)
+  {
+    // This acts on the current context, so it only works after bind_context()
+    if (window) {
+      glfwSwapInterval(interval);
+    }
+  }
+
+  bool system::has_adaptive_vsync()
+  {
+    return window && (glfwExtensionSupported("GLX_EXT_swap_control_tear") ||
+                      glfwExtensionSupported("WGL_EXT_swap_control_tear"));
+  }
+
+  void system::unbind_context()
+  {
+    glfwMakeContextCurrent(NULL);
   }
 
   void system::close_window()
@@ -288,6 +313,17 @@ namespace service
     }
   }
 
+  bool system::resize_window(unsigned int width, unsigned int height)
+  {
+    // GLFW 3.1 can't move a window between windowed and fullscreen mode
+    if (!window || glfwGetWindowMonitor(window)) {
+      return false;
+    }
+
+    glfwSetWindowSize(window, width, height);
+    return true;
+  }
+
   event_vector_ptr system::poll_events()
   {
     events = std::make_unique<event_vector>();
@@ -295,6 +331,18 @@ namespace service
     return std::move(events);
   }
 
+  event_vector_ptr system::wait_events()
+  {
+    events = std::make_unique<event_vector>();
+    glfwWaitEvents();
+    return std::move(events);
+  }
+
+  void system::wake_up()
+  {
+    glfwPostEmptyEvent();
+  }
+
   void system::swap_buffers()
   {
     if (window) {
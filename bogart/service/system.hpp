@@ -7,15 +7,42 @@ namespace bogart
 {
 namespace service
 {
-  // Thread-safety: methods in this class can only be called from the main thread
+  // Thread-safety: methods in this class can only be called from the main thread, except for
+  // wake_up(), and bind_context(), unbind_context(), set_swap_interval(), has_adaptive_vsync() and
+  // swap_buffers(), which can be called from the thread that renders.
   class system
   {
   public:
     system();
     ~system();
+
+    // Opens the window. Its OpenGL context isn't current on any thread until bind_context() is
+    // called. Close the window only after unbind_context().
     bool open_window(unsigned int width, unsigned int heigth, bool fullscreen);
     void close_window();
+    bool is_window_open();
+
+    // Makes the OpenGL context of the window current in the calling thread, or in none
+    void bind_context();
+    void unbind_context();
+
+    // Sets how many vertical blanks swap_buffers() waits for: 0 disables vsync, and a negative value
+    // enables adaptive vsync (it swaps at once if the frame missed the blank), which is only
+    // available if has_adaptive_vsync(). Both act on the context bound to the calling thread.
+    void set_swap_interval(int interval);
+    bool has_adaptive_vsync();
+
+    // Resizes the open window in place, keeping its OpenGL context. Only windowed mode windows can
+    // be resized, fullscreen ones need to be closed and opened again.
+    bool resize_window(unsigned int width, unsigned int height);
     event_vector_ptr poll_events();
+
+    // Like poll_events(), but blocks until there is at least one event, the window needs to be
+    // redrawn or wake_up() is called
+    event_vector_ptr wait_events();
+
+    // Makes a wait_events() call in progress return. Must only be called while the window is open.
+    void wake_up();
     void swap_buffers();
   }; // class system
 } // namespace service
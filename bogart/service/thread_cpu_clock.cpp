@@ -0,0 +1,19 @@
+#include "bogart/service/thread_cpu_clock.hpp"
+
+#include <time.h>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  thread_cpu_clock::time_point thread_cpu_clock::now()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return time_point(duration(static_cast<rep>(ts.tv_sec) * 1000000000 + ts.tv_nsec));
+  }
+} // namespace service
+} // namespace bogart
@@ -0,0 +1,33 @@
+#ifndef THREAD_CPU_CLOCK_HPP
+#define THREAD_CPU_CLOCK_HPP
+
+#include <chrono>
+
+namespace bogart
+{
+namespace service
+{
+  //------------------------------------------------------------------------------------------------
+  //! @class thread_cpu_clock
+  //! @ingroup service
+  //!
+  //! Clock that measures the CPU time consumed by the calling thread, with the same interface as
+  //! the std::chrono clocks. Time points of different threads can't be compared.
+  //!
+  //! Thread-safety: all public methods are thread-safe.
+  //------------------------------------------------------------------------------------------------
+  class thread_cpu_clock
+  {
+  public:
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<thread_cpu_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now();
+  }; // class thread_cpu_clock
+} // namespace service
+} // namespace bogart
+
+#endif // THREAD_CPU_CLOCK_HPP
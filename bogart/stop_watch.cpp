@@ -9,7 +9,7 @@ namespace bogart
   //------------------------------------------------------------------------------------------------
   namespace
   {
-    typedef std::chrono::high_resolution_clock clock;
+    typedef std::chrono::steady_clock clock;
     typedef clock::time_point time_point;
     typedef std::chrono::duration<float> duration;
   } // Anonymous namespace
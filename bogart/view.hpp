@@ -2,9 +2,15 @@
 #define VIEW_HPP
 
 #include "bogart/service/cmd_line_args.hpp"
+#include "bogart/async/latency_histogram.hpp"
 #include "bogart/async/message_queue.hpp"
-#include "bogart/service/system.hpp"
+#include "bogart/event.hpp"
 
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <functional>
 #include <memory>
 
 namespace bogart
@@ -27,6 +33,153 @@ namespace bogart
     bool fullscreen;
   };
 
+  // How the view spaces its frames. PACING_ADAPTIVE_VSYNC waits for vertical blank like
+  // PACING_VSYNC, but swaps right away if the frame missed it, trading a torn frame for not waiting
+  // a whole refresh. Views that can't do it fall back to PACING_VSYNC. PACING_CAP sleeps on the CPU
+  // so that frames start at most fps_cap times per second.
+  enum pacing_mode
+  {
+    PACING_UNCAPPED = 0,
+    PACING_VSYNC,
+    PACING_ADAPTIVE_VSYNC,
+    PACING_CAP,
+    PACING_MODE_COUNT
+  };
+
+  struct frame_pacing
+  {
+    frame_pacing() : mode(PACING_UNCAPPED), fps_cap(60.0f)
+    {
+
+    }
+
+    frame_pacing(pacing_mode mode, float fps_cap) : mode(mode), fps_cap(fps_cap)
+    {
+
+    }
+
+    pacing_mode mode;
+    float fps_cap;    // frames per second, only used by PACING_CAP
+  };
+
+  inline const char* get_pacing_mode_name(pacing_mode mode)
+  {
+    static const char* const names[PACING_MODE_COUNT] = { "uncapped", "vsync", "adaptive vsync", "cap" };
+    return (mode < PACING_MODE_COUNT) ? names[mode] : "unknown";
+  }
+
+  // Pose of the camera. The transform is computed once per tick on the logic thread, so that the
+  // view can hand it to the engine as is. Position and orientation are there for interpolation.
+  struct camera_state
+  {
+    camera_state() : position(0.0f), orientation(1.0f, 0.0f, 0.0f, 0.0f), transform(1.0f)
+    {
+
+    }
+
+    camera_state(const glm::vec3& position, const glm::quat& orientation, const glm::mat4& transform) :
+      position(position), orientation(orientation), transform(transform)
+    {
+
+    }
+
+    glm::vec3 position;
+    glm::quat orientation;
+    glm::mat4 transform; // node transform of the camera: translation times rotation
+  };
+
+  // The two last simulation states and how far the simulation time is between them. The view
+  // keeps advancing alpha with real time until the next update arrives, and draws the camera at
+  // the interpolated state. A step of zero means the simulation has a variable timestep, in which
+  // case the view draws the current state as is.
+  struct camera_update
+  {
+    camera_update() : previous(), current(), alpha(1.0f), step(0.0f)
+    {
+
+    }
+
+    camera_update(const camera_state& previous, const camera_state& current, float alpha, float step) :
+      previous(previous), current(current), alpha(alpha), step(step)
+    {
+
+    }
+
+    camera_state previous;
+    camera_state current;
+    float alpha; // In [0, 1]
+    float step;  // In seconds
+  };
+
+  // Timings of the last tick of the logic thread, for the performance overlay
+  struct logic_metrics
+  {
+    logic_metrics() : tick_time(0.0f), timer_lateness(0.0f), input_latency(0.0f)
+    {
+
+    }
+
+    float tick_time;      // wall time the tick took, in seconds
+    float timer_lateness; // time from the tick deadline to the start of the tick, in seconds
+    float input_latency;  // longest time from the window system to the logic thread of the input
+                          // since the previous snapshot, in seconds
+  };
+
+  // Latest state of the world as seen by the view. The controller publishes a new snapshot on every
+  // tick, and the view picks the newest one right before rendering each frame.
+  struct world_snapshot
+  {
+    world_snapshot() : camera(), metrics(), stats_enabled(false), record_frame_times(false), idle(false), loading(0.0f)
+    {
+
+    }
+
+    camera_update camera;
+    logic_metrics metrics;
+    bool stats_enabled;
+    bool record_frame_times; // the view measures the frames it renders while this is set
+    bool idle;               // nothing changes until the next snapshot, so the view may stop
+                             // drawing until then or until there is input
+    float loading;           // share of the view resources that are loaded, the view shows a
+                             // loading screen while it's below 1
+  };
+
+  // Progress of the resources the view loads in the background. The total grows as loaded
+  // resources reveal the ones they reference, so the share of loaded ones can go down.
+  struct loading_progress
+  {
+    loading_progress() : loaded(0), total(0), done(true)
+    {
+
+    }
+
+    float get_fraction() const
+    {
+      return (done || total == 0) ? 1.0f : static_cast<float>(loaded) / total;
+    }
+
+    unsigned int loaded;
+    unsigned int total;
+    bool done;
+  };
+
+  typedef std::function<void (const loading_progress& progress)> loading_handler;
+
+  // Frame times measured by the render thread: the CPU time it spent on each frame and the wall
+  // time between the starts of consecutive frames
+  struct render_frame_times
+  {
+    render_frame_times() : cpu(), interval()
+    {
+
+    }
+
+    async::latency_histogram cpu;
+    async::latency_histogram interval;
+  };
+
+  typedef std::function<void (const render_frame_times& times)> frame_times_handler;
+
   class open_handler
   {
   public:
@@ -71,38 +224,59 @@ namespace bogart
   //! @class view
   //! @ingroup bogart
   //!
+  //! Interface the controller uses to show the world. horde_view renders it in a window with
+  //! Horde3D; null_view runs without a window or OpenGL context.
+  //!
   //! Thread-safety: all public methods are thread-safe.
   //------------------------------------------------------------------------------------------------
   class view
   {
   public:
     //----------------------------------------------------------------------------------------------
-    //! Constructor
+    //! Destructor
     //----------------------------------------------------------------------------------------------
-    view(async::message_queue& render_queue,
-         async::message_queue& logic_queue,
-         service::system& system,
-         service::cmd_line_args& args);
+    virtual ~view() {}
 
     //----------------------------------------------------------------------------------------------
-    //! Destructor
+    //! Member functions
     //----------------------------------------------------------------------------------------------
-    ~view();
+    virtual void async_open(open_args_ptr args) = 0;
+    virtual void async_set_up() = 0;
+    virtual void async_tear_down() = 0;
+    virtual void async_close() = 0;
 
     //----------------------------------------------------------------------------------------------
-    //! Member functions
+    //! @brief Changes the video mode of a set up view in place, keeping the renderer, resources
+    //!  and scene. The handler gets false and the settings still in effect if that's not possible
+    //!  (for example to go into or out of fullscreen), in which case the caller has to tear down,
+    //!  close and open the view again.
     //----------------------------------------------------------------------------------------------
-    void async_open(open_args_ptr args);
-    void async_set_up();
-    void async_tear_down();
-    void async_close();
-    void async_update_camera(float x, float y, float z, float rx, float ry);
-    void async_set_stats_enabled(bool enable);
-    void async_subscribe_to_events(const event_handler& handler);
+    virtual void async_change_video_mode(open_args_ptr args) = 0;
+    virtual void async_subscribe_to_events(const event_handler& handler) = 0;
 
-  private:
-    class view_impl;                            //!< implementation class (Pimpl idiom)
-    std::unique_ptr<view_impl> impl;            //!< pointer to implementation (Pimpl idiom)
+    //----------------------------------------------------------------------------------------------
+    //! @brief Sets how frames are paced. Can be called at any time, the view applies it as soon as
+    //!  it has a window.
+    //----------------------------------------------------------------------------------------------
+    virtual void async_set_frame_pacing(const frame_pacing& pacing) = 0;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Sets the handler that gets the progress of resource loading, on the logic thread.
+    //!  The view starts loading when it's opened and may be set up and render before it's done.
+    //----------------------------------------------------------------------------------------------
+    virtual void async_subscribe_to_loading(const loading_handler& handler) = 0;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Publishes the latest world snapshot. Lock-free, doesn't post anything to the render
+    //!  thread. Must always be called from the same thread.
+    //----------------------------------------------------------------------------------------------
+    virtual void publish(const world_snapshot& snapshot) = 0;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Hands the frame times recorded so far to handler, on the logic thread, and clears
+    //!  them.
+    //----------------------------------------------------------------------------------------------
+    virtual void async_collect_frame_times(const frame_times_handler& handler) = 0;
   }; // class view
 } // namespace bogart
 
@@ -1,5 +1,4 @@
 #include "bogart/view_resources.hpp"
-#include "Horde3DUtils.h"
 #include "Horde3D.h"
 
 #include <vector>
@@ -52,11 +51,13 @@ namespace bogart
     {
       if (resource_definitions.empty()) {
         add_resource(RESOURCE_FORWARD_PIPELINE, H3DResTypes::Pipeline,   "pipelines/forward.pipeline.xml");
+        add_resource(RESOURCE_SCALED_PIPELINE , H3DResTypes::Pipeline,   "pipelines/scaled.pipeline.xml");
         add_resource(RESOURCE_FONT_MATERIAL   , H3DResTypes::Material,   "overlays/font.material.xml");
         add_resource(RESOURCE_PANEL_MATERIAL  , H3DResTypes::Material,   "overlays/panel.material.xml");
         add_resource(RESOURCE_LIGHT_MATERIAL  , H3DResTypes::Material,   "materials/light.material.xml");
         add_resource(RESOURCE_SKYBOX          , H3DResTypes::SceneGraph, "models/skybox/skybox.scene.xml");
         add_resource(RESOURCE_SPONZA_MODEL    , H3DResTypes::SceneGraph, "models/sponza/sponza.scene.xml");
+        add_resource(RESOURCE_ACTOR_MODEL     , H3DResTypes::SceneGraph, "models/man/man.scene.xml");
       }
     }
   }
@@ -64,7 +65,7 @@ namespace bogart
   //----------------------------------------------------------------------------------------------
   //! Public functions
   //----------------------------------------------------------------------------------------------
-  bool load_resources(const std::string& content_dir)
+  void add_resources()
   {
     fill_resource_definitions();
 
@@ -72,7 +73,6 @@ namespace bogart
     for (resource_definition_it it = resource_definitions.begin(); it != resource_definitions.end(); it++) {
       resources[it->id] = h3dAddResource(it->type, it->path.c_str(), 0);
     }
-    return h3dutLoadResourcesFromDisk(content_dir.c_str());
   }
 
   int get_resource(res_id id)
@@ -14,16 +14,21 @@ namespace bogart
   //! Constants
   //------------------------------------------------------------------------------------------------
   const res_id RESOURCE_FORWARD_PIPELINE                    =  0x000;
+  const res_id RESOURCE_SCALED_PIPELINE                     =  0x001;
   const res_id RESOURCE_FONT_MATERIAL                       =  0x010;
   const res_id RESOURCE_PANEL_MATERIAL                      =  0x020;
   const res_id RESOURCE_LIGHT_MATERIAL                      =  0x030;
   const res_id RESOURCE_SKYBOX                              =  0x040;
   const res_id RESOURCE_SPONZA_MODEL                        =  0x050;
+  const res_id RESOURCE_ACTOR_MODEL                         =  0x060;
 
   //------------------------------------------------------------------------------------------------
   //! Free functions
   //------------------------------------------------------------------------------------------------
-  bool load_resources(const std::string& path);
+  //------------------------------------------------------------------------------------------------
+  //! @brief Adds the view resources to the engine, unloaded. A resource_streamer loads them.
+  //------------------------------------------------------------------------------------------------
+  void add_resources();
   int get_resource(res_id id);
 } // namespace bogart
 
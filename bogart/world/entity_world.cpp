@@ -0,0 +1,196 @@
+#include "bogart/world/entity_world.hpp"
+#include "bogart/async/worker_pool.hpp"
+
+#include <cassert>
+
+namespace bogart
+{
+namespace world
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const std::size_t UPDATE_GRAIN = 4096; // entities per chunk of a parallel update
+
+    float cap_pitch(float pitch)
+    {
+      return (pitch > 90.0f) ? 90.0f : ((pitch < -90.0f) ? -90.0f : pitch);
+    }
+
+    template<typename T>
+    void swap_remove(std::vector<T>& v, std::size_t i)
+    {
+      v[i] = v.back();
+      v.pop_back();
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public member functions.
+  //------------------------------------------------------------------------------------------------
+  entity_world::entity_world() :
+    movement(),
+    index_to_entity(),
+    entity_to_index(),
+    free_entities()
+  {
+
+  }
+
+  void entity_world::reserve(std::size_t count)
+  {
+    movement.x.reserve(count);
+    movement.y.reserve(count);
+    movement.z.reserve(count);
+    movement.pitch.reserve(count);
+    movement.yaw.reserve(count);
+    movement.velocity.reserve(count);
+    movement.movement.reserve(count);
+    index_to_entity.reserve(count);
+    entity_to_index.reserve(count);
+  }
+
+  entity entity_world::spawn(const glm::vec3& position, float pitch, float yaw, float velocity)
+  {
+    entity e;
+    if (free_entities.empty()) {
+      e = static_cast<entity>(entity_to_index.size());
+      entity_to_index.push_back(INVALID_ENTITY);
+    } else {
+      e = free_entities.back();
+      free_entities.pop_back();
+    }
+
+    entity_to_index[e] = static_cast<std::uint32_t>(index_to_entity.size());
+    index_to_entity.push_back(e);
+    movement.x.push_back(position.x);
+    movement.y.push_back(position.y);
+    movement.z.push_back(position.z);
+    movement.pitch.push_back(cap_pitch(pitch));
+    movement.yaw.push_back(yaw);
+    movement.velocity.push_back(velocity);
+    movement.movement.push_back(0);
+    return e;
+  }
+
+  void entity_world::destroy(entity e)
+  {
+    if (!is_alive(e)) {
+      return;
+    }
+
+    // Move the last entity into the slot of the destroyed one
+    std::size_t i = entity_to_index[e];
+    entity_to_index[index_to_entity.back()] = static_cast<std::uint32_t>(i);
+    swap_remove(index_to_entity, i);
+    swap_remove(movement.x, i);
+    swap_remove(movement.y, i);
+    swap_remove(movement.z, i);
+    swap_remove(movement.pitch, i);
+    swap_remove(movement.yaw, i);
+    swap_remove(movement.velocity, i);
+    swap_remove(movement.movement, i);
+    entity_to_index[e] = INVALID_ENTITY;
+    free_entities.push_back(e);
+  }
+
+  bool entity_world::is_alive(entity e) const
+  {
+    return e < entity_to_index.size() && entity_to_index[e] != INVALID_ENTITY;
+  }
+
+  std::size_t entity_world::size() const
+  {
+    return index_to_entity.size();
+  }
+
+  glm::vec3 entity_world::get_position(entity e) const
+  {
+    std::size_t i = get_index(e);
+    return glm::vec3(movement.x[i], movement.y[i], movement.z[i]);
+  }
+
+  float entity_world::get_pitch(entity e) const
+  {
+    return movement.pitch[get_index(e)];
+  }
+
+  float entity_world::get_yaw(entity e) const
+  {
+    return movement.yaw[get_index(e)];
+  }
+
+  float entity_world::get_velocity(entity e) const
+  {
+    return movement.velocity[get_index(e)];
+  }
+
+  unsigned int entity_world::get_movement(entity e) const
+  {
+    return movement.movement[get_index(e)];
+  }
+
+  void entity_world::set_position(entity e, const glm::vec3& position)
+  {
+    std::size_t i = get_index(e);
+    movement.x[i] = position.x;
+    movement.y[i] = position.y;
+    movement.z[i] = position.z;
+  }
+
+  void entity_world::set_pitch(entity e, float pitch)
+  {
+    movement.pitch[get_index(e)] = cap_pitch(pitch);
+  }
+
+  void entity_world::set_yaw(entity e, float yaw)
+  {
+    movement.yaw[get_index(e)] = yaw;
+  }
+
+  void entity_world::set_velocity(entity e, float velocity)
+  {
+    movement.velocity[get_index(e)] = velocity;
+  }
+
+  void entity_world::set_movement(entity e, unsigned int flags)
+  {
+    movement.movement[get_index(e)] = static_cast<std::uint8_t>(flags);
+  }
+
+  void entity_world::update(float dt)
+  {
+    update_movement(movement, 0, size(), dt);
+  }
+
+  void entity_world::update(float dt, async::worker_pool& workers)
+  {
+    // Entities are independent and each kernel gives the same results on any subrange, so this
+    // matches update(dt) bit for bit
+    workers.parallel_for(0, size(), UPDATE_GRAIN, [this, dt](std::size_t begin, std::size_t end) {
+      update_movement(movement, begin, end, dt);
+    });
+  }
+
+  movement_components& entity_world::get_movement_components()
+  {
+    return movement;
+  }
+
+  const movement_components& entity_world::get_movement_components() const
+  {
+    return movement;
+  }
+
+  std::size_t entity_world::get_index(entity e) const
+  {
+    assert(is_alive(e));
+    return entity_to_index[e];
+  }
+} // namespace world
+} // namespace bogart
@@ -0,0 +1,95 @@
+#ifndef ENTITY_WORLD_HPP
+#define ENTITY_WORLD_HPP
+
+#include "bogart/world/movement_system.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bogart
+{
+namespace async
+{
+  class worker_pool;
+} // namespace async
+
+namespace world
+{
+  typedef std::uint32_t entity;
+
+  const entity INVALID_ENTITY = 0xffffffff;
+
+  //------------------------------------------------------------------------------------------------
+  //! @class entity_world
+  //! @ingroup world
+  //!
+  //! Storage for simulated entities. Components live in contiguous arrays (see
+  //! movement_components) with no gaps: destroying an entity moves the last one into its slot. An
+  //! entity handle is stable for the lifetime of the entity, and is reused after it is destroyed.
+  //!
+  //! The state lives inline in this object rather than behind a pointer, and update() runs each
+  //! system over all entities in one tight loop.
+  //!
+  //! Thread-safety: calling methods in this class from different threads on different instances is
+  //! safe. Calling methods in this class from different threads on the same instance is not safe.
+  //------------------------------------------------------------------------------------------------
+  class entity_world
+  {
+  public:
+    //----------------------------------------------------------------------------------------------
+    //! Constructor
+    //----------------------------------------------------------------------------------------------
+    entity_world();
+
+    //----------------------------------------------------------------------------------------------
+    //! Member functions
+    //----------------------------------------------------------------------------------------------
+    void reserve(std::size_t count);
+    entity spawn(const glm::vec3& position, float pitch, float yaw, float velocity);
+    void destroy(entity e);
+    bool is_alive(entity e) const;
+    std::size_t size() const;
+
+    glm::vec3 get_position(entity e) const;
+    float get_pitch(entity e) const;
+    float get_yaw(entity e) const;
+    float get_velocity(entity e) const;
+    unsigned int get_movement(entity e) const;
+    void set_position(entity e, const glm::vec3& position);
+    void set_pitch(entity e, float pitch);
+    void set_yaw(entity e, float yaw);
+    void set_velocity(entity e, float velocity);
+    void set_movement(entity e, unsigned int flags);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Runs the systems over all entities for dt seconds.
+    //----------------------------------------------------------------------------------------------
+    void update(float dt);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Like update(dt), splitting the entities in chunks that run on workers. The results
+    //!  are identical to those of update(dt) whatever the number of threads.
+    //----------------------------------------------------------------------------------------------
+    void update(float dt, async::worker_pool& workers);
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief Direct access to the component arrays, for systems. Entity e is at index
+    //!  get_index(e). Adding or destroying entities invalidates indices.
+    //----------------------------------------------------------------------------------------------
+    movement_components& get_movement_components();
+    const movement_components& get_movement_components() const;
+    std::size_t get_index(entity e) const;
+
+  private:
+    movement_components movement;
+    std::vector<entity> index_to_entity;
+    std::vector<std::uint32_t> entity_to_index; // INVALID_ENTITY for free handles
+    std::vector<entity> free_entities;
+  }; // class entity_world
+} // namespace world
+} // namespace bogart
+
+#endif // ENTITY_WORLD_HPP
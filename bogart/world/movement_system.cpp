@@ -0,0 +1,369 @@
+#include "bogart/world/movement_system.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOGART_X86_KERNELS
+#endif
+
+namespace bogart
+{
+namespace world
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions and types.
+  //!
+  //! Every kernel computes, for each entity:
+  //!
+  //!   q = round(angle / 90), r = (angle - 90 q) * Pi / 180, which is in [-Pi/4, Pi/4]
+  //!   sin(r) and cos(r) with the Cephes minimax polynomials
+  //!   sin(angle) and cos(angle) from sin(r), cos(r) and the quadrant q
+  //!   f = (forward - backward) * velocity * dt, s = (right - left) * velocity * dt
+  //!   x += cos(yaw) s - sin(yaw) f, y += sin(pitch) f, z -= cos(yaw) f + sin(yaw) s
+  //!
+  //! with the same operations in the same order, so that all kernels agree to the bit. Reducing
+  //! in degrees keeps the reduction exact for any angle below 2^24 / 90 turns.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const float INV_90 = 1.0f / 90.0f;
+    const float DEG_TO_RAD = 0.017453292f; // = Pi / 180
+    const float SIN_C1 = -1.6666654611e-1f;
+    const float SIN_C2 = 8.3321608736e-3f;
+    const float SIN_C3 = -1.9515295891e-4f;
+    const float COS_C1 = 4.166664568298827e-2f;
+    const float COS_C2 = -1.388731625493765e-3f;
+    const float COS_C3 = 2.443315711809948e-5f;
+
+    std::atomic<int> s_kernel(MOVEMENT_KERNEL_SCALAR);
+
+    //----------------------------------------------------------------------------------------------
+    //! Scalar kernel
+    //----------------------------------------------------------------------------------------------
+
+    // Rounds to the nearest integer, ties to even, like the SIMD conversions do
+    int round_to_int(float f)
+    {
+#ifdef BOGART_X86_KERNELS
+      return _mm_cvtss_si32(_mm_set_ss(f));
+#else
+      return static_cast<int>(std::lrint(f));
+#endif
+    }
+
+    std::uint32_t to_bits(float f)
+    {
+      std::uint32_t u;
+      std::memcpy(&u, &f, sizeof(u));
+      return u;
+    }
+
+    float from_bits(std::uint32_t u)
+    {
+      float f;
+      std::memcpy(&f, &u, sizeof(f));
+      return f;
+    }
+
+    inline void sincos_deg(float degrees, float& s, float& c)
+    {
+      int q = round_to_int(degrees * INV_90);
+      float r = (degrees - static_cast<float>(q) * 90.0f) * DEG_TO_RAD;
+      float z = r * r;
+
+      float ps = SIN_C3;
+      ps = ps * z + SIN_C2;
+      ps = ps * z + SIN_C1;
+      float sr = ps * z * r + r;
+
+      float pc = COS_C3;
+      pc = pc * z + COS_C2;
+      pc = pc * z + COS_C1;
+      float cr = pc * z * z - 0.5f * z + 1.0f;
+
+      // Rotate by q quarter turns with the same masks the SIMD kernels use. The quadrant is random
+      // from one entity to the next, so branching on it would mispredict half of the time.
+      std::uint32_t u = static_cast<std::uint32_t>(q);
+      std::uint32_t swap = 0u - (u & 1u);
+      std::uint32_t sin_bits = to_bits(sr);
+      std::uint32_t cos_bits = to_bits(cr);
+      s = from_bits(((cos_bits & swap) | (sin_bits & ~swap)) ^ ((u & 2u) << 30));
+      c = from_bits(((sin_bits & swap) | (cos_bits & ~swap)) ^ (((u + 1u) & 2u) << 30));
+    }
+
+    void update_scalar(movement_components& c, std::size_t begin, std::size_t end, float dt)
+    {
+      float* x = c.x.data();
+      float* y = c.y.data();
+      float* z = c.z.data();
+      const float* pitch = c.pitch.data();
+      const float* yaw = c.yaw.data();
+      const float* velocity = c.velocity.data();
+      const std::uint8_t* movement = c.movement.data();
+
+      for (std::size_t i = begin; i < end; i++) {
+        // Idle entities don't move, so they don't need any trigonometry
+        int m = movement[i];
+        if (m == MOVE_NONE) {
+          continue;
+        }
+
+        float sin_yaw, cos_yaw, sin_pitch, cos_pitch;
+        sincos_deg(yaw[i], sin_yaw, cos_yaw);
+        sincos_deg(pitch[i], sin_pitch, cos_pitch);
+
+        float forward = static_cast<float>(m & MOVE_FORWARD) - static_cast<float>((m & MOVE_BACKWARD) >> 1);
+        float strafe = static_cast<float>((m & STRAFE_RIGHT) >> 2) - static_cast<float>((m & STRAFE_LEFT) >> 3);
+        float step = velocity[i] * dt;
+        float f = forward * step;
+        float s = strafe * step;
+
+        x[i] = x[i] + (cos_yaw * s - sin_yaw * f);
+        y[i] = y[i] + sin_pitch * f;
+        z[i] = z[i] - (cos_yaw * f + sin_yaw * s);
+      }
+    }
+
+#ifdef BOGART_X86_KERNELS
+    //----------------------------------------------------------------------------------------------
+    //! SSE kernel
+    //----------------------------------------------------------------------------------------------
+
+    // The SSE helpers are also used by the AVX kernel. They must be inlined there, otherwise every
+    // call pays for a transition between VEX and legacy SSE code.
+    #define BOGART_SSE_HELPER inline __attribute__((always_inline))
+
+    // Sign masks that rotate sin and cos by q quarter turns, see sincos_deg()
+    BOGART_SSE_HELPER void quadrant_masks(__m128i q, __m128i& swap, __m128i& sin_sign, __m128i& cos_sign)
+    {
+      const __m128i one = _mm_set1_epi32(1);
+      const __m128i two = _mm_set1_epi32(2);
+      swap = _mm_cmpeq_epi32(_mm_and_si128(q, one), one);
+      sin_sign = _mm_slli_epi32(_mm_and_si128(q, two), 30);
+      cos_sign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30);
+    }
+
+    // Axis factors of four movement bytes
+    BOGART_SSE_HELPER void movement_axes(const std::uint8_t* m, __m128& forward, __m128& strafe)
+    {
+      std::int32_t packed;
+      __builtin_memcpy(&packed, m, sizeof(packed));
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i one = _mm_set1_epi32(1);
+      __m128i flags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+      __m128 fw = _mm_cvtepi32_ps(_mm_and_si128(flags, one));
+      __m128 bw = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(flags, 1), one));
+      __m128 rt = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(flags, 2), one));
+      __m128 lt = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(flags, 3), one));
+      forward = _mm_sub_ps(fw, bw);
+      strafe = _mm_sub_ps(rt, lt);
+    }
+
+    BOGART_SSE_HELPER void sincos_deg_sse(__m128 degrees, __m128& s, __m128& c)
+    {
+      __m128i q = _mm_cvtps_epi32(_mm_mul_ps(degrees, _mm_set1_ps(INV_90)));
+      __m128 r = _mm_mul_ps(_mm_sub_ps(degrees, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(90.0f))), _mm_set1_ps(DEG_TO_RAD));
+      __m128 z = _mm_mul_ps(r, r);
+
+      __m128 ps = _mm_set1_ps(SIN_C3);
+      ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(SIN_C2));
+      ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(SIN_C1));
+      __m128 sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), r), r);
+
+      __m128 pc = _mm_set1_ps(COS_C3);
+      pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(COS_C2));
+      pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(COS_C1));
+      __m128 cr = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(pc, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+
+      __m128i swap, sin_sign, cos_sign;
+      quadrant_masks(q, swap, sin_sign, cos_sign);
+      __m128 swap_ps = _mm_castsi128_ps(swap);
+      s = _mm_or_ps(_mm_and_ps(swap_ps, cr), _mm_andnot_ps(swap_ps, sr));
+      c = _mm_or_ps(_mm_and_ps(swap_ps, sr), _mm_andnot_ps(swap_ps, cr));
+      s = _mm_xor_ps(s, _mm_castsi128_ps(sin_sign));
+      c = _mm_xor_ps(c, _mm_castsi128_ps(cos_sign));
+    }
+
+    void update_sse(movement_components& c, std::size_t begin, std::size_t end, float dt)
+    {
+      float* x = c.x.data();
+      float* y = c.y.data();
+      float* z = c.z.data();
+      const float* pitch = c.pitch.data();
+      const float* yaw = c.yaw.data();
+      const float* velocity = c.velocity.data();
+      const std::uint8_t* movement = c.movement.data();
+      const __m128 vdt = _mm_set1_ps(dt);
+
+      std::size_t i = begin;
+      for (; i + 4 <= end; i += 4) {
+        __m128 sin_yaw, cos_yaw, sin_pitch, cos_pitch;
+        sincos_deg_sse(_mm_loadu_ps(yaw + i), sin_yaw, cos_yaw);
+        sincos_deg_sse(_mm_loadu_ps(pitch + i), sin_pitch, cos_pitch);
+
+        __m128 forward, strafe;
+        movement_axes(movement + i, forward, strafe);
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(velocity + i), vdt);
+        __m128 f = _mm_mul_ps(forward, step);
+        __m128 s = _mm_mul_ps(strafe, step);
+
+        __m128 dx = _mm_sub_ps(_mm_mul_ps(cos_yaw, s), _mm_mul_ps(sin_yaw, f));
+        __m128 dz = _mm_add_ps(_mm_mul_ps(cos_yaw, f), _mm_mul_ps(sin_yaw, s));
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), dx));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(sin_pitch, f)));
+        _mm_storeu_ps(z + i, _mm_sub_ps(_mm_loadu_ps(z + i), dz));
+      }
+
+      update_scalar(c, i, end, dt);
+    }
+
+    //----------------------------------------------------------------------------------------------
+    //! AVX kernel. AVX has no 256-bit integer operations, so the quadrant and flag arithmetic is
+    //! done on 128-bit halves with the SSE helpers.
+    //----------------------------------------------------------------------------------------------
+    __attribute__((target("avx"))) inline __attribute__((always_inline))
+    __m256 combine(__m128i lo, __m128i hi)
+    {
+      return _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+    }
+
+    __attribute__((target("avx"))) inline __attribute__((always_inline))
+    void sincos_deg_avx(__m256 degrees, __m256& s, __m256& c)
+    {
+      __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(degrees, _mm256_set1_ps(INV_90)));
+      __m256 r = _mm256_mul_ps(_mm256_sub_ps(degrees, _mm256_mul_ps(_mm256_cvtepi32_ps(q), _mm256_set1_ps(90.0f))), _mm256_set1_ps(DEG_TO_RAD));
+      __m256 z = _mm256_mul_ps(r, r);
+
+      __m256 ps = _mm256_set1_ps(SIN_C3);
+      ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(SIN_C2));
+      ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(SIN_C1));
+      __m256 sr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ps, z), r), r);
+
+      __m256 pc = _mm256_set1_ps(COS_C3);
+      pc = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(COS_C2));
+      pc = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(COS_C1));
+      __m256 cr = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(pc, z), z), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_set1_ps(1.0f));
+
+      __m128i swap_lo, sin_sign_lo, cos_sign_lo, swap_hi, sin_sign_hi, cos_sign_hi;
+      quadrant_masks(_mm256_castsi256_si128(q), swap_lo, sin_sign_lo, cos_sign_lo);
+      quadrant_masks(_mm256_extractf128_si256(q, 1), swap_hi, sin_sign_hi, cos_sign_hi);
+      __m256 swap = combine(swap_lo, swap_hi);
+      s = _mm256_or_ps(_mm256_and_ps(swap, cr), _mm256_andnot_ps(swap, sr));
+      c = _mm256_or_ps(_mm256_and_ps(swap, sr), _mm256_andnot_ps(swap, cr));
+      s = _mm256_xor_ps(s, combine(sin_sign_lo, sin_sign_hi));
+      c = _mm256_xor_ps(c, combine(cos_sign_lo, cos_sign_hi));
+    }
+
+    __attribute__((target("avx")))
+    void update_avx(movement_components& c, std::size_t begin, std::size_t end, float dt)
+    {
+      float* x = c.x.data();
+      float* y = c.y.data();
+      float* z = c.z.data();
+      const float* pitch = c.pitch.data();
+      const float* yaw = c.yaw.data();
+      const float* velocity = c.velocity.data();
+      const std::uint8_t* movement = c.movement.data();
+      const __m256 vdt = _mm256_set1_ps(dt);
+
+      std::size_t i = begin;
+      for (; i + 8 <= end; i += 8) {
+        __m256 sin_yaw, cos_yaw, sin_pitch, cos_pitch;
+        sincos_deg_avx(_mm256_loadu_ps(yaw + i), sin_yaw, cos_yaw);
+        sincos_deg_avx(_mm256_loadu_ps(pitch + i), sin_pitch, cos_pitch);
+
+        __m128 forward_lo, strafe_lo, forward_hi, strafe_hi;
+        movement_axes(movement + i, forward_lo, strafe_lo);
+        movement_axes(movement + i + 4, forward_hi, strafe_hi);
+        __m256 forward = _mm256_insertf128_ps(_mm256_castps128_ps256(forward_lo), forward_hi, 1);
+        __m256 strafe = _mm256_insertf128_ps(_mm256_castps128_ps256(strafe_lo), strafe_hi, 1);
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(velocity + i), vdt);
+        __m256 f = _mm256_mul_ps(forward, step);
+        __m256 s = _mm256_mul_ps(strafe, step);
+
+        __m256 dx = _mm256_sub_ps(_mm256_mul_ps(cos_yaw, s), _mm256_mul_ps(sin_yaw, f));
+        __m256 dz = _mm256_add_ps(_mm256_mul_ps(cos_yaw, f), _mm256_mul_ps(sin_yaw, s));
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), dx));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(sin_pitch, f)));
+        _mm256_storeu_ps(z + i, _mm256_sub_ps(_mm256_loadu_ps(z + i), dz));
+      }
+
+      // Clear the upper halves of the registers, otherwise the legacy SSE code that runs after us
+      // (the scalar tail, libm, the caller) pays for a state transition on every instruction
+      _mm256_zeroupper();
+      update_scalar(c, i, end, dt);
+    }
+#endif // BOGART_X86_KERNELS
+
+    bool is_supported(movement_kernel kernel)
+    {
+#ifdef BOGART_X86_KERNELS
+      if (kernel == MOVEMENT_KERNEL_SSE) {
+        return __builtin_cpu_supports("sse2");
+      }
+      if (kernel == MOVEMENT_KERNEL_AVX) {
+        return __builtin_cpu_supports("avx");
+      }
+#endif
+      return kernel == MOVEMENT_KERNEL_SCALAR;
+    }
+
+    // Picks the widest kernel before main() runs
+    struct kernel_selector
+    {
+      kernel_selector()
+      {
+        const movement_kernel kernels[] = { MOVEMENT_KERNEL_AVX, MOVEMENT_KERNEL_SSE };
+        for (movement_kernel k : kernels) {
+          if (set_movement_kernel(k)) {
+            return;
+          }
+        }
+      }
+    };
+
+    kernel_selector s_kernel_selector;
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool set_movement_kernel(movement_kernel kernel)
+  {
+    if (!is_supported(kernel)) {
+      return false;
+    }
+
+    s_kernel = kernel;
+    return true;
+  }
+
+  movement_kernel get_movement_kernel()
+  {
+    return static_cast<movement_kernel>(s_kernel.load());
+  }
+
+  void update_movement(movement_components& c, std::size_t begin, std::size_t end, float dt)
+  {
+    switch (s_kernel.load(std::memory_order_relaxed)) {
+#ifdef BOGART_X86_KERNELS
+      case MOVEMENT_KERNEL_AVX:
+        update_avx(c, begin, end, dt);
+        break;
+      case MOVEMENT_KERNEL_SSE:
+        update_sse(c, begin, end, dt);
+        break;
+#endif
+      default:
+        update_scalar(c, begin, end, dt);
+        break;
+    }
+  }
+} // namespace world
+} // namespace bogart
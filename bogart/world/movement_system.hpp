@@ -0,0 +1,83 @@
+#ifndef MOVEMENT_SYSTEM_HPP
+#define MOVEMENT_SYSTEM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bogart
+{
+namespace world
+{
+  //------------------------------------------------------------------------------------------------
+  //! Movement flags, combined with bitwise or
+  //------------------------------------------------------------------------------------------------
+  enum movement_flag
+  {
+    MOVE_NONE      = 0x0,
+    MOVE_FORWARD   = 0x1,
+    MOVE_BACKWARD  = 0x2,
+    STRAFE_RIGHT   = 0x4,
+    STRAFE_LEFT    = 0x8
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! Components of moving entities, as a structure of arrays. Element i of every array belongs to
+  //! the same entity. Angles are in degrees, movement holds movement_flag values.
+  //------------------------------------------------------------------------------------------------
+  struct movement_components
+  {
+    movement_components() : x(), y(), z(), pitch(), yaw(), velocity(), movement()
+    {
+
+    }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> pitch;
+    std::vector<float> yaw;
+    std::vector<float> velocity;
+    std::vector<std::uint8_t> movement;
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! Kernels update_movement() can run on.
+  //!
+  //! MOVEMENT_KERNEL_SCALAR is portable. MOVEMENT_KERNEL_SSE advances 4 entities at a time and is
+  //! available on every x86-64 CPU. MOVEMENT_KERNEL_AVX advances 8 entities at a time and is
+  //! available on x86 CPUs that support AVX. The default is the widest kernel the CPU supports.
+  //!
+  //! All kernels perform the same floating point operations in the same order, so they produce
+  //! bit-identical results and switching kernels doesn't break deterministic replays. Idle
+  //! entities stay where they are: the scalar kernel skips them, the others add zero to them.
+  //------------------------------------------------------------------------------------------------
+  enum movement_kernel
+  {
+    MOVEMENT_KERNEL_SCALAR = 0,
+    MOVEMENT_KERNEL_SSE,
+    MOVEMENT_KERNEL_AVX
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Selects the kernel update_movement() runs on. Thread-safe.
+  //! @return false if the kernel is not supported by this build or CPU. The current kernel is
+  //!  kept in that case.
+  //------------------------------------------------------------------------------------------------
+  bool set_movement_kernel(movement_kernel kernel);
+  movement_kernel get_movement_kernel();
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Moves the entities in [begin, end) for dt seconds along their forward vector
+  //!  (-sin(yaw), sin(pitch), -cos(yaw)) and their right vector (cos(yaw), 0, -sin(yaw)), with
+  //!  opposite flags cancelling each other. This is how the player moves too.
+  //!
+  //! Sine and cosine are computed once per entity with a polynomial approximation (error below
+  //! 2e-7 for angles of up to several thousand degrees) and movement flags are turned into axis
+  //! factors without branches.
+  //------------------------------------------------------------------------------------------------
+  void update_movement(movement_components& c, std::size_t begin, std::size_t end, float dt);
+} // namespace world
+} // namespace bogart
+
+#endif // MOVEMENT_SYSTEM_HPP
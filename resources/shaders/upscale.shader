@@ -0,0 +1,43 @@
+[[FX]]
+
+// Samplers
+sampler2D buf0 = sampler_state
+{
+	Address = Clamp;
+	Filter = Bilinear;
+};
+
+// Contexts
+context UPSCALE
+{
+	VertexShader = compile GLSL VS_FSQUAD;
+	PixelShader = compile GLSL FS_UPSCALE;
+	
+	ZWriteEnable = false;
+}
+
+
+[[VS_FSQUAD]]
+// =================================================================================================
+
+uniform mat4 projMat;
+attribute vec3 vertPos;
+varying vec2 texCoords;
+				
+void main( void )
+{
+	texCoords = vertPos.xy; 
+	gl_Position = projMat * vec4( vertPos, 1 );
+}
+
+
+[[FS_UPSCALE]]
+// =================================================================================================
+
+uniform sampler2D buf0;
+varying vec2 texCoords;
+
+void main( void )
+{
+	gl_FragColor = texture2D( buf0, texCoords );
+}
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/actor_1
+./actor_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/benchmark_1
+./benchmark_1 "$@"
+status=$?
+cd -
+exit $status
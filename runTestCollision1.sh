@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/collision_1
+./collision_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/input_1
+./input_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/input_2
+./input_2 "$@"
+status=$?
+cd -
+exit $status
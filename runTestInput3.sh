@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/input_3
+./input_3 "$@"
+status=$?
+cd -
+exit $status
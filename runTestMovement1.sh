@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/movement_1
+./movement_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/parallel_1
+./parallel_1 "$@"
+status=$?
+cd -
+exit $status
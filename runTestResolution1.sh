@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/resolution_1
+./resolution_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/scene_1
+./scene_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/streamer_1
+./streamer_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/texconv_1
+./texconv_1 "$@"
+status=$?
+cd -
+exit $status
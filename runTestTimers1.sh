@@ -1,5 +1,7 @@
 #! /bin/bash
 
 cd build/test/unit/timers_1
-./timers_1
+./timers_1 "$@"
+status=$?
 cd -
+exit $status
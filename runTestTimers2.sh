@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/timers_2
+./timers_2 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/triple_buffer_1
+./triple_buffer_1 "$@"
+status=$?
+cd -
+exit $status
@@ -0,0 +1,7 @@
+#! /bin/bash
+
+cd build/test/unit/world_1
+./world_1 "$@"
+status=$?
+cd -
+exit $status
@@ -1,11 +1,14 @@
-#include "bogart/fps_actor.hpp"
+#include "legacy_fps_actor.hpp"
 #include "bogart/log/log.hpp"
 
 #include <iomanip>
+#include <sstream>
 #include <cmath>
 
-namespace bogart
+namespace legacy
 {
+  using namespace bogart;
+
   //------------------------------------------------------------------------------------------------
   //! Internal helper functions and types.
   //------------------------------------------------------------------------------------------------
@@ -20,15 +23,23 @@ namespace bogart
     {
       return degrees * 0.017453292f; // = degrees * Pi / 180
     }
+
+    // Same rotation Horde3D builds from Euler angles (pitch, yaw, 0)
+    glm::quat make_orientation(float pitch, float yaw)
+    {
+      return glm::angleAxis(deg_to_rad(yaw), glm::vec3(0.0f, 1.0f, 0.0f)) *
+             glm::angleAxis(deg_to_rad(pitch), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
   } // Anonymous namespace
 
-  class fps_actor::fps_actor_impl
+  class legacy_fps_actor::legacy_fps_actor_impl
   {
   public:
-    fps_actor_impl() :
+    legacy_fps_actor_impl() :
       m_position(glm::vec3(0.0f)),
       m_pitch(0.0f),
       m_yaw(0.0f),
+      m_orientation(make_orientation(0.0f, 0.0f)),
       m_velocity(1.0f),
       m_moving_forward(false),
       m_moving_backward(false),
@@ -38,10 +49,11 @@ namespace bogart
 
     }
 
-    fps_actor_impl(const glm::vec3 position, float pitch, float yaw, float velocity) :
+    legacy_fps_actor_impl(const glm::vec3 position, float pitch, float yaw, float velocity) :
       m_position(position),
       m_pitch(cap_pitch(pitch)),
       m_yaw(yaw),
+      m_orientation(make_orientation(m_pitch, m_yaw)),
       m_velocity(velocity),
       m_moving_forward(false),
       m_moving_backward(false),
@@ -57,64 +69,90 @@ namespace bogart
     glm::vec3 m_position;
     float m_pitch;         // In degrees
     float m_yaw;           // In degrees
+    glm::quat m_orientation; // Kept in sync with m_pitch and m_yaw
     float m_velocity;
     bool m_moving_forward;
     bool m_moving_backward;
     bool m_strafing_right;
     bool m_strafing_left;
-  }; // class fps_actor::fps_actor_impl
+  }; // class legacy_fps_actor::legacy_fps_actor_impl
 
   //------------------------------------------------------------------------------------------------
   //! Public member functions.
   //------------------------------------------------------------------------------------------------
-  fps_actor::fps_actor() :
-    impl(std::make_unique<fps_actor::fps_actor_impl>())
+  legacy_fps_actor::legacy_fps_actor() :
+    impl(std::make_unique<legacy_fps_actor::legacy_fps_actor_impl>())
   {
 
   }
 
-  fps_actor::fps_actor(const glm::vec3& position, float pitch, float yaw, float velocity) :
-    impl(std::make_unique<fps_actor::fps_actor_impl>(position, pitch, yaw, velocity))
+  legacy_fps_actor::legacy_fps_actor(const glm::vec3& position, float pitch, float yaw, float velocity) :
+    impl(std::make_unique<legacy_fps_actor::legacy_fps_actor_impl>(position, pitch, yaw, velocity))
   {
 
   }
 
-  fps_actor::~fps_actor()
+  legacy_fps_actor::~legacy_fps_actor()
   {
 
   }
 
-  glm::vec3 fps_actor::get_position()
+  glm::vec3 legacy_fps_actor::get_position()
   {
     return impl->m_position;
   }
 
-  glm::vec3 fps_actor::get_forward()
+  glm::vec3 legacy_fps_actor::get_forward()
   {
     // Result of putting the vector (0, 0, -1) through an extrinsic rotation of pitch degrees
     // around X and m_yaw around Y
     return glm::vec3(-sinf(deg_to_rad(impl->m_yaw)), sinf(deg_to_rad(impl->m_pitch)), -cosf(deg_to_rad(impl->m_yaw)));
   }
 
-  glm::vec3 fps_actor::get_right()
+  glm::vec3 legacy_fps_actor::get_right()
   {
     // Result of putting the vector (1, 0, 0) through a rotation of m_yaw degrees
     // around Y
     return glm::vec3(-sinf(deg_to_rad(impl->m_yaw - 90)), 0.0f, -cosf(deg_to_rad(impl->m_yaw - 90)));
   }
 
-  float fps_actor::get_pitch()
+  float legacy_fps_actor::get_pitch()
   {
     return impl->m_pitch;
   }
 
-  float fps_actor::get_yaw()
+  float legacy_fps_actor::get_yaw()
   {
     return impl->m_yaw;
   }
 
-  void fps_actor::log_status()
+  glm::quat legacy_fps_actor::get_orientation()
+  {
+    return impl->m_orientation;
+  }
+
+  glm::mat4 legacy_fps_actor::get_transform()
+  {
+    glm::mat4 ret = glm::mat4_cast(impl->m_orientation);
+    ret[3] = glm::vec4(impl->m_position, 1.0f);
+    return ret;
+  }
+
+  unsigned int legacy_fps_actor::get_movement()
   {
+    return (impl->m_moving_forward ? world::MOVE_FORWARD : 0) |
+           (impl->m_moving_backward ? world::MOVE_BACKWARD : 0) |
+           (impl->m_strafing_right ? world::STRAFE_RIGHT : 0) |
+           (impl->m_strafing_left ? world::STRAFE_LEFT : 0);
+  }
+
+  void legacy_fps_actor::log_status()
+  {
+    // Don't pay for the formatting when nobody is going to see it
+    if (!log::is_enabled(log::DEBUG)) {
+      return;
+    }
+
     std::ostringstream os;
     glm::vec3 position = get_position();
     os << std::setprecision(2) << std::fixed << "Position: "
@@ -123,70 +161,80 @@ namespace bogart
     log::debug(os.str());
   }
 
-  void fps_actor::set_velocity(float v)
+  void legacy_fps_actor::set_velocity(float v)
   {
     impl->m_velocity = v;
   }
 
-  void fps_actor::start_moving_forward()
+  void legacy_fps_actor::start_moving_forward()
   {
     log::debug("fps_actor: start_moving_forward");
     impl->m_moving_forward = true;
     impl->m_moving_backward = false;
   }
 
-  void fps_actor::start_moving_backward()
+  void legacy_fps_actor::start_moving_backward()
   {
     log::debug("fps_actor: start_moving_backward");
     impl->m_moving_forward = false;
     impl->m_moving_backward = true;
   }
 
-  void fps_actor::start_strafing_right()
+  void legacy_fps_actor::start_strafing_right()
   {
     log::debug("fps_actor: start_strafing_right");
     impl->m_strafing_right = true;
     impl->m_strafing_left = false;
   }
 
-  void fps_actor::start_strafing_left()
+  void legacy_fps_actor::start_strafing_left()
   {
     log::debug("fps_actor: start_strafing_left");
     impl->m_strafing_right = false;
     impl->m_strafing_left = true;
   }
 
-  void fps_actor::stop_moving_forward_back()
+  void legacy_fps_actor::stop_moving_forward_back()
   {
     log::debug("fps_actor: stop_moving_forward_back");
     impl->m_moving_forward = false;
     impl->m_moving_backward = false;
   }
 
-  void fps_actor::stop_strafing()
+  void legacy_fps_actor::stop_strafing()
   {
     log::debug("fps_actor: stop_strafing");
     impl->m_strafing_left = false;
     impl->m_strafing_right = false;
   }
 
-  void fps_actor::set_position(const glm::vec3& position)
+  void legacy_fps_actor::set_movement(unsigned int flags)
+  {
+    impl->m_moving_forward = (flags & world::MOVE_FORWARD) != 0;
+    impl->m_moving_backward = (flags & world::MOVE_BACKWARD) != 0;
+    impl->m_strafing_right = (flags & world::STRAFE_RIGHT) != 0;
+    impl->m_strafing_left = (flags & world::STRAFE_LEFT) != 0;
+  }
+
+  void legacy_fps_actor::set_position(const glm::vec3& position)
   {
     impl->m_position = position;
   }
 
-  void fps_actor::set_pitch(float p)
+  void legacy_fps_actor::set_pitch(float p)
   {
     // Loop up/down but only in a limited range
     impl->m_pitch = cap_pitch(p);
+    impl->m_orientation = make_orientation(impl->m_pitch, impl->m_yaw);
   }
 
-  void fps_actor::set_yaw(float y)
+  void legacy_fps_actor::set_yaw(float y)
   {
     impl->m_yaw = y;
+    impl->m_orientation = make_orientation(impl->m_pitch, impl->m_yaw);
   }
 
-  void fps_actor::update(float dt)
+  void legacy_fps_actor::update(float dt)
   {
     if (impl->m_moving_forward)
     {
@@ -208,4 +256,4 @@ namespace bogart
       impl->m_position -= get_right() * impl->m_velocity * dt;
     }
   }
-} // namespace bogart
+} // namespace legacy
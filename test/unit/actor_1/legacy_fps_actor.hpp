@@ -1,19 +1,23 @@
-#ifndef FPS_ACTOR_HPP
-#define FPS_ACTOR_HPP
+#ifndef LEGACY_FPS_ACTOR_HPP
+#define LEGACY_FPS_ACTOR_HPP
 
+#include "bogart/world/movement_system.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
 #include <memory>
 
-namespace bogart
+namespace legacy
 {
   //------------------------------------------------------------------------------------------------
-  //! @class fps_actor
-  //! @ingroup bogart
+  //! @class legacy_fps_actor
   //!
-  //! Thread-safety: all public methods are thread-safe.
+  //! Copy of the fps_actor class the player used to be before it became an entity of the world,
+  //! kept to compare against.
   //------------------------------------------------------------------------------------------------
-  class fps_actor
+  class legacy_fps_actor
   {
   public:
     //----------------------------------------------------------------------------------------------
@@ -23,19 +27,19 @@ namespace bogart
     //----------------------------------------------------------------------------------------------
     //! Constructor
     //----------------------------------------------------------------------------------------------
-    fps_actor();
+    legacy_fps_actor();
 
     //----------------------------------------------------------------------------------------------
     //! Constructor
     //----------------------------------------------------------------------------------------------
     // Pitch and yaw are degrees of rotation with respect to the default orientation which is
     // looking down the nagative Z axis (forward = (0, 0, -1), right = (1, 0, 0))
-    fps_actor(const glm::vec3& position, float pitch, float yaw, float velocity);
+    legacy_fps_actor(const glm::vec3& position, float pitch, float yaw, float velocity);
 
     //----------------------------------------------------------------------------------------------
     //! Destructor
     //----------------------------------------------------------------------------------------------
-    ~fps_actor();
+    ~legacy_fps_actor();
 
     //----------------------------------------------------------------------------------------------
     //! Member functions
@@ -46,6 +50,9 @@ namespace bogart
     glm::vec3 get_right();
     float get_pitch();
     float get_yaw();
+    glm::quat get_orientation();   // rotation of pitch degrees around X and then yaw around Y
+    glm::mat4 get_transform();     // translation to the position times the orientation
+    unsigned int get_movement();
     void log_status();
 
     // Modifiers
@@ -56,16 +63,17 @@ namespace bogart
     void start_strafing_left();
     void stop_moving_forward_back();
     void stop_strafing();
+    void set_movement(unsigned int flags);
     void set_position(const glm::vec3& position);
     void set_pitch(float pitch);
     void set_yaw(float yaw);
     void update(float deltat);
 
   private:
-    class fps_actor_impl;                            //!< implementation class (Pimpl idiom)
-    std::unique_ptr<fps_actor_impl> impl;            //!< pointer to implementation (Pimpl idiom)
-  }; // class fps_actor
-} // namespace bogart
+    class legacy_fps_actor_impl;                            //!< implementation class (Pimpl idiom)
+    std::unique_ptr<legacy_fps_actor_impl> impl;            //!< pointer to implementation (Pimpl idiom)
+  }; // class legacy_fps_actor
+} // namespace legacy
 
 
-#endif // FPS_ACTOR_HPP
+#endif // LEGACY_FPS_ACTOR_HPP
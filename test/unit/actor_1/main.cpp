@@ -0,0 +1,145 @@
+#include "legacy_fps_actor.hpp"
+#include "bogart/world/entity_world.hpp"
+#include "bogart/player_camera.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <deque>
+#include <cmath>
+
+// Per-update cost of the player as the controller runs it, an entity of the world with a
+// player_camera, against the fps_actor it replaced (legacy_fps_actor). That one kept its state
+// behind a pointer, recomputed the forward and right vectors with trigonometry on every update and
+// rebuilt its orientation on every turn. Every actor of the population is moved and has its camera
+// read on every tick, like the player on every fixed step, in two scenarios:
+//
+// - walk: orientation never changes, which is what the player does on most ticks.
+// - look: yaw and pitch change on every tick, like the player while the mouse moves.
+//
+// Both must end with the same positions, to within float rounding (the movement kernels use their
+// own sine and cosine), and the same camera orientations.
+
+const unsigned int ACTOR_COUNT = 10000;
+const unsigned int TICK_COUNT = 200;
+const float DT = 1.0f / 60.0f;
+const float POSITION_TOLERANCE = 5e-5f;    // relative to the distance travelled
+const float ORIENTATION_TOLERANCE = 1e-6f;
+
+struct actor_start
+{
+  glm::vec3 position;
+  float pitch;
+  float yaw;
+  float velocity;
+  unsigned int movement;
+};
+
+// Actors start at the origin so that the comparison measures the motion, not the rounding of large
+// coordinates
+std::vector<actor_start> make_starts() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+  std::uniform_real_distribution<float> velocity(0.5f, 3.0f);
+  std::uniform_int_distribution<unsigned int> movement(0, 15);
+  std::vector<actor_start> starts(ACTOR_COUNT);
+  for (actor_start& s : starts) {
+    s.position = glm::vec3(0.0f);
+    s.pitch = angle(rng) / 2.0f;
+    s.yaw = angle(rng);
+    s.velocity = velocity(rng);
+    s.movement = movement(rng);
+  }
+  return starts;
+}
+
+// Advances the legacy actors, turning them on every tick if look is set. Returns ns per actor
+// update. The sum of the camera transforms keeps the reads from being optimized away.
+double run(std::deque<legacy::legacy_fps_actor>& actors, bool look, float& sum) {
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (unsigned int t = 0; t < TICK_COUNT; t++) {
+    for (legacy::legacy_fps_actor& a : actors) {
+      if (look) {
+        a.set_yaw(a.get_yaw() + 0.5f);
+        a.set_pitch(a.get_pitch() - 0.1f);
+      }
+      a.update(DT);
+      sum += a.get_transform()[0][0];
+    }
+  }
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - t0;
+  return d.count() / (TICK_COUNT * ACTOR_COUNT);
+}
+
+// Same for the entities of a world, the way the controller steps the player
+double run(bogart::world::entity_world& w, const std::vector<bogart::world::entity>& entities,
+           std::vector<bogart::player_camera>& cameras, bool look, float& sum) {
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (unsigned int t = 0; t < TICK_COUNT; t++) {
+    if (look) {
+      for (bogart::world::entity e : entities) {
+        w.set_pitch(e, w.get_pitch(e) - 0.1f);
+        w.set_yaw(e, w.get_yaw(e) + 0.5f);
+      }
+    }
+    w.update(DT);
+    for (std::size_t i = 0; i < entities.size(); i++) {
+      sum += cameras[i].get(w, entities[i]).transform[0][0];
+    }
+  }
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - t0;
+  return d.count() / (TICK_COUNT * ACTOR_COUNT);
+}
+
+float max_component(const glm::vec3& v) {
+  return std::max(std::fabs(v.x), std::max(std::fabs(v.y), std::fabs(v.z)));
+}
+
+float max_difference(const glm::quat& a, const glm::quat& b) {
+  return std::max(max_component(glm::vec3(a.x - b.x, a.y - b.y, a.z - b.z)), std::fabs(a.w - b.w));
+}
+
+int main() {
+  std::vector<actor_start> starts = make_starts();
+  std::cout << std::setw(8) << "case" << std::setw(20) << "legacy ns/update" << std::setw(20) << "player ns/update"
+            << std::setw(10) << "speedup" << "\n";
+
+  bool ok = true;
+  for (int look = 0; look < 2; look++) {
+    std::deque<legacy::legacy_fps_actor> old_actors; // legacy_fps_actor can't be moved
+    bogart::world::entity_world w;
+    std::vector<bogart::world::entity> entities;
+    std::vector<bogart::player_camera> cameras(ACTOR_COUNT);
+    w.reserve(ACTOR_COUNT);
+    for (const actor_start& s : starts) {
+      old_actors.emplace_back(s.position, s.pitch, s.yaw, s.velocity);
+      old_actors.back().set_movement(s.movement);
+      entities.push_back(w.spawn(s.position, s.pitch, s.yaw, s.velocity));
+      w.set_movement(entities.back(), s.movement);
+    }
+
+    float old_sum = 0.0f;
+    float new_sum = 0.0f;
+    double old_ns = run(old_actors, look != 0, old_sum);
+    double new_ns = run(w, entities, cameras, look != 0, new_sum);
+    std::cout << std::setw(8) << (look ? "look" : "walk") << std::fixed << std::setprecision(2)
+              << std::setw(20) << old_ns << std::setw(20) << new_ns << std::setw(9) << old_ns / new_ns << "x\n";
+
+    for (unsigned int i = 0; i < ACTOR_COUNT; i++) {
+      const bogart::camera_state& camera = cameras[i].get(w, entities[i]);
+      float travelled = starts[i].velocity * DT * TICK_COUNT;
+      if (max_component(camera.position - old_actors[i].get_position()) > POSITION_TOLERANCE * travelled ||
+          max_difference(camera.orientation, old_actors[i].get_orientation()) > ORIENTATION_TOLERANCE) {
+        std::cout << "FAILED: actor " << i << " ended somewhere else than with legacy_fps_actor\n";
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
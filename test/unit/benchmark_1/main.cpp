@@ -0,0 +1,113 @@
+#include "bogart/camera_path.hpp"
+#include "bogart/frame_report.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cmath>
+
+// Checks of the pieces of the fly-through benchmark that don't need a view:
+//
+// - camera_path parsing: comments and empty lines are skipped, and malformed lines or keyframes out
+//   of order make load() fail.
+// - camera_path interpolation: the spline goes through every keyframe, is clamped outside the path
+//   and, for keyframes evenly spaced on a line, stays on the line.
+// - frame_report output: metrics show up in JSON and CSV, and strings are escaped so that paths
+//   with quotes or backslashes still give valid JSON.
+
+bool failed = false;
+
+void check(bool condition, const std::string& what) {
+  if (!condition) {
+    std::cout << "FAILED: " << what << "\n";
+    failed = true;
+  }
+}
+
+bool near(float a, float b) {
+  return std::fabs(a - b) < 1e-4f;
+}
+
+void write_file(const std::string& path, const std::string& text) {
+  std::ofstream out(path.c_str(), std::ios::trunc);
+  out << text;
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream in(path.c_str());
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+void test_parsing() {
+  bogart::camera_path path;
+  write_file("benchmark_1.path", "# time x y z pitch yaw\n\n0 0 0 0 0 0\n1 1 2 3 10 20\n2.5 4 0 0 0 90\n");
+  check(path.load("benchmark_1.path"), "valid path rejected");
+  check(near(path.get_duration(), 2.5f), "wrong duration");
+
+  write_file("benchmark_1.path", "0 0 0 0 0 0\n1 1 2 3 10\n");
+  check(!path.load("benchmark_1.path") && path.is_empty(), "line with a missing value accepted");
+
+  write_file("benchmark_1.path", "0 0 0 0 0 0\n1 1 2 3 10 20\n1 1 2 3 10 20\n");
+  check(!path.load("benchmark_1.path") && path.is_empty(), "keyframes out of order accepted");
+
+  write_file("benchmark_1.path", "# nothing\n");
+  check(!path.load("benchmark_1.path"), "path without keyframes accepted");
+  check(!path.load("benchmark_1.missing"), "missing file accepted");
+  std::remove("benchmark_1.path");
+}
+
+void test_interpolation() {
+  bogart::camera_path path;
+  write_file("benchmark_1.path", "0 0 0 0 0 0\n1 2 0 0 10 0\n2 4 0 0 20 0\n3 6 0 0 30 0\n4 5 5 5 0 45\n");
+  check(path.load("benchmark_1.path"), "interpolation path rejected");
+  std::remove("benchmark_1.path");
+
+  // Through the keyframes
+  const float X[] = { 0.0f, 2.0f, 4.0f, 6.0f, 5.0f };
+  for (unsigned int i = 0; i < 5; i++) {
+    bogart::camera_keyframe k = path.evaluate(static_cast<float>(i));
+    check(near(k.position.x, X[i]), "spline misses keyframe " + std::to_string(i));
+  }
+
+  // Evenly spaced keyframes on a line give a point on the line
+  bogart::camera_keyframe k = path.evaluate(1.5f);
+  check(near(k.position.x, 3.0f) && near(k.position.y, 0.0f) && near(k.pitch, 15.0f), "spline leaves the line");
+
+  // Clamped outside the path
+  check(near(path.evaluate(-1.0f).position.x, 0.0f), "not clamped before the start");
+  check(near(path.evaluate(10.0f).yaw, 45.0f), "not clamped after the end");
+}
+
+void test_report() {
+  bogart::async::latency_histogram h;
+  h.record(std::chrono::milliseconds(10));
+  h.record(std::chrono::milliseconds(20));
+  bogart::frame_report report;
+  report.path_file = "C:\\paths\\\"fly\"\n.path";
+  report.duration = 2.0f;
+  report.metrics.push_back(bogart::frame_report_metric("frame_interval", h));
+
+  check(bogart::write_frame_report("benchmark_1.json", report), "could not write JSON report");
+  std::string json = read_file("benchmark_1.json");
+  check(json.find("\"path\": \"C:\\\\paths\\\\\\\"fly\\\"\\u000a.path\"") != std::string::npos, "path not escaped");
+  check(json.find("\"frame_interval\": {\"count\": 2") != std::string::npos, "metric missing from JSON");
+  check(json.find("\"max_ms\": 20.0") != std::string::npos, "wrong max in JSON");
+  std::remove("benchmark_1.json");
+
+  check(bogart::write_frame_report("benchmark_1.csv", report), "could not write CSV report");
+  std::string csv = read_file("benchmark_1.csv");
+  check(csv.find("metric,count,min_ms,mean_ms,stddev_ms,p50_ms,p95_ms,p99_ms,max_ms\nframe_interval,2,") == 0, "wrong CSV");
+  std::remove("benchmark_1.csv");
+}
+
+int main() {
+  test_parsing();
+  test_interpolation();
+  test_report();
+  std::cout << (failed ? "FAILED\n" : "PASSED\n");
+  return failed ? 1 : 0;
+}
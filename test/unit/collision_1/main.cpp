@@ -0,0 +1,259 @@
+#include "bogart/collision/triangle_mesh.hpp"
+#include "bogart/collision/geometry.hpp"
+#include "bogart/collision/bvh.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+
+// Correctness checks and benchmarks of the collision BVH on a real model. By default we load the
+// knight, pass the path of another .geo file as the first argument to use that instead.
+//
+// - Raycasts against the BVH must find the same closest hit as testing every triangle.
+// - Capsules swept towards the model must stop before penetrating any triangle.
+// - Cache files that are truncated or point outside of their arrays must be rejected.
+// - We time building the BVH against loading it from the cache, and report the cost per raycast
+//   and per sweep. Brute force raycasts are timed too, to show what the BVH saves.
+
+const char* DEFAULT_GEO = "../../../../resources/models/knight/knight.geo";
+const char* CACHE_PATH = "collision_1.bvh";
+const char* CORRUPT_CACHE_PATH = "collision_1_corrupt.bvh";
+const std::size_t CACHE_HEADER_SIZE = 24;
+const std::size_t CACHE_NODE_OFFSET = 12; // of the offset field, within a node
+const unsigned int RAY_COUNT = 2000;
+const unsigned int BRUTE_FORCE_RAY_COUNT = 200;
+const unsigned int SWEEP_COUNT = 500;
+const unsigned int TIMED_RAY_COUNT = 200000;
+const unsigned int TIMED_SWEEP_COUNT = 20000;
+const float PENETRATION_TOLERANCE = 1e-4f;
+
+typedef std::chrono::steady_clock clock_type;
+
+struct query
+{
+  glm::vec3 origin;
+  glm::vec3 dir;
+};
+
+double elapsed_ms(clock_type::time_point start) {
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void get_bounds(const bogart::collision::triangle_mesh& mesh, glm::vec3& min, glm::vec3& max) {
+  min = glm::vec3(std::numeric_limits<float>::max());
+  max = glm::vec3(-std::numeric_limits<float>::max());
+  for (const glm::vec3& v : mesh.vertices) {
+    min = glm::min(min, v);
+    max = glm::max(max, v);
+  }
+}
+
+// Queries from points around the model to points inside its bounds, so that most of them hit
+std::vector<query> make_queries(const glm::vec3& min, const glm::vec3& max, unsigned int count) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> u(0.0f, 1.0f);
+  glm::vec3 center = (min + max) * 0.5f;
+  float radius = glm::length(max - min);
+  std::vector<query> queries(count);
+  for (query& q : queries) {
+    glm::vec3 dir = glm::normalize(glm::vec3(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f) + glm::vec3(1e-3f));
+    glm::vec3 target = min + (max - min) * glm::vec3(u(rng), u(rng), u(rng));
+    q.origin = center + dir * radius;
+    q.dir = target - q.origin;
+  }
+  return queries;
+}
+
+bool brute_force_raycast(const bogart::collision::triangle_mesh& mesh, const query& q, float& best_t) {
+  bool found = false;
+  best_t = 1.0f;
+  for (std::size_t i = 0; i < mesh.get_triangle_count(); i++) {
+    float t = 0.0f;
+    const std::uint32_t* idx = &mesh.indices[3 * i];
+    if (bogart::collision::intersect_ray_triangle(q.origin, q.dir, best_t, mesh.vertices[idx[0]], mesh.vertices[idx[1]], mesh.vertices[idx[2]], t)) {
+      best_t = t;
+      found = true;
+    }
+  }
+  return found;
+}
+
+float brute_force_distance(const bogart::collision::triangle_mesh& mesh, const glm::vec3& a, const glm::vec3& b) {
+  float best = std::numeric_limits<float>::max();
+  for (std::size_t i = 0; i < mesh.get_triangle_count(); i++) {
+    glm::vec3 on_segment;
+    glm::vec3 on_triangle;
+    const std::uint32_t* idx = &mesh.indices[3 * i];
+    best = std::min(best, bogart::collision::closest_points_segment_triangle(a, b, mesh.vertices[idx[0]], mesh.vertices[idx[1]], mesh.vertices[idx[2]], on_segment, on_triangle));
+  }
+  return best;
+}
+
+bool check_raycasts(const bogart::collision::triangle_mesh& mesh, const bogart::collision::bvh& b, const std::vector<query>& queries) {
+  unsigned int hits = 0;
+  for (const query& q : queries) {
+    float expected_t = 0.0f;
+    bool expected = brute_force_raycast(mesh, q, expected_t);
+    bogart::collision::ray_hit hit;
+    bool found = b.raycast(q.origin, q.dir, 1.0f, hit);
+    if (found != expected || (found && hit.t != expected_t)) {
+      std::cout << "FAILED: BVH raycast doesn't match brute force\n";
+      return false;
+    }
+    hits += found ? 1 : 0;
+  }
+  std::cout << "raycasts: " << hits << " of " << queries.size() << " hit, all match brute force\n";
+  return true;
+}
+
+bool check_sweeps(const bogart::collision::triangle_mesh& mesh, const bogart::collision::bvh& b, const std::vector<query>& queries, float radius) {
+  unsigned int hits = 0;
+  glm::vec3 axis(0.0f, 2.0f * radius, 0.0f);
+  for (const query& q : queries) {
+    bogart::collision::capsule c(q.origin, q.origin + axis, radius);
+    if (brute_force_distance(mesh, c.a, c.b) <= radius) {
+      continue; // starts in contact
+    }
+
+    bogart::collision::sweep_hit hit;
+    bool found = b.sweep_capsule(c, q.dir, hit);
+    glm::vec3 end = q.dir * (found ? hit.t : 1.0f);
+    if (brute_force_distance(mesh, c.a + end, c.b + end) < radius - PENETRATION_TOLERANCE) {
+      std::cout << "FAILED: swept capsule ends up penetrating the mesh\n";
+      return false;
+    }
+    hits += found ? 1 : 0;
+  }
+  std::cout << "sweeps: " << hits << " of " << queries.size() << " hit, none penetrate\n";
+  return true;
+}
+
+// Writes bytes to CORRUPT_CACHE_PATH and tries to load it
+bool loads_corrupt_cache(const std::vector<char>& bytes, std::uint64_t hash) {
+  {
+    std::ofstream out(CORRUPT_CACHE_PATH, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+  }
+  bogart::collision::bvh b;
+  bool loaded = b.load(CORRUPT_CACHE_PATH, hash);
+  std::remove(CORRUPT_CACHE_PATH);
+  return loaded || !b.is_empty();
+}
+
+bool check_corrupt_caches(std::uint64_t hash) {
+  std::ifstream in(CACHE_PATH, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (bytes.size() < CACHE_HEADER_SIZE + 32) {
+    std::cout << "FAILED: BVH cache too small to corrupt\n";
+    return false;
+  }
+
+  std::vector<char> truncated(bytes.begin(), bytes.end() - 4);
+  std::vector<char> bad_child = bytes;
+  std::uint32_t offset = 0xfffffff0u;
+  std::memcpy(&bad_child[CACHE_HEADER_SIZE + CACHE_NODE_OFFSET], &offset, sizeof(offset));
+  std::vector<char> cycle = bytes;
+  offset = 0;
+  std::memcpy(&cycle[CACHE_HEADER_SIZE + CACHE_NODE_OFFSET], &offset, sizeof(offset));
+  if (loads_corrupt_cache(truncated, hash) || loads_corrupt_cache(bad_child, hash) || loads_corrupt_cache(cycle, hash)) {
+    std::cout << "FAILED: BVH cache with bad sizes or offsets was accepted\n";
+    return false;
+  }
+
+  std::cout << "corrupt BVH caches rejected\n";
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const char* path = (argc > 1) ? argv[1] : DEFAULT_GEO;
+  bogart::collision::triangle_mesh mesh;
+  if (!bogart::collision::load_geo(path, mesh)) {
+    std::cout << "FAILED: could not load " << path << "\n";
+    return 1;
+  }
+
+  glm::vec3 min;
+  glm::vec3 max;
+  get_bounds(mesh, min, max);
+  float size = glm::length(max - min);
+  std::cout << path << ": " << mesh.get_triangle_count() << " triangles, " << mesh.vertices.size() << " vertices\n";
+
+  // Build against cache load
+  bogart::collision::bvh built;
+  clock_type::time_point start = clock_type::now();
+  built.build(mesh);
+  double build_ms = elapsed_ms(start);
+  if (!built.save(CACHE_PATH)) {
+    std::cout << "FAILED: could not write the BVH cache\n";
+    return 1;
+  }
+
+  bogart::collision::bvh loaded;
+  start = clock_type::now();
+  bool is_loaded = loaded.load(CACHE_PATH, bogart::collision::hash_mesh(mesh));
+  double load_ms = elapsed_ms(start);
+  bogart::collision::bvh stale;
+  bool is_stale_loaded = stale.load(CACHE_PATH, bogart::collision::hash_mesh(mesh) + 1);
+  bool rejects_corrupt = check_corrupt_caches(bogart::collision::hash_mesh(mesh));
+  std::remove(CACHE_PATH);
+  if (!rejects_corrupt) {
+    return 1;
+  }
+  if (!is_loaded || loaded.get_node_count() != built.get_node_count() || is_stale_loaded || !stale.is_empty()) {
+    std::cout << "FAILED: BVH cache doesn't round-trip or accepts a stale mesh\n";
+    return 1;
+  }
+  std::cout << std::fixed << std::setprecision(2) << built.get_node_count() << " nodes, build " << build_ms
+            << " ms, cache load " << load_ms << " ms\n";
+
+  // Correctness, using the loaded BVH
+  std::vector<query> queries = make_queries(min, max, RAY_COUNT);
+  if (!check_raycasts(mesh, loaded, queries) || !check_sweeps(mesh, loaded, make_queries(min, max, SWEEP_COUNT), 0.02f * size)) {
+    return 1;
+  }
+
+  // Timing
+  queries = make_queries(min, max, TIMED_RAY_COUNT);
+  unsigned int hits = 0;
+  start = clock_type::now();
+  for (const query& q : queries) {
+    bogart::collision::ray_hit hit;
+    hits += loaded.raycast(q.origin, q.dir, 1.0f, hit) ? 1 : 0;
+  }
+  double bvh_ray_ns = elapsed_ms(start) * 1e6 / queries.size();
+
+  start = clock_type::now();
+  for (unsigned int i = 0; i < BRUTE_FORCE_RAY_COUNT; i++) {
+    float t = 0.0f;
+    hits += brute_force_raycast(mesh, queries[i], t) ? 1 : 0;
+  }
+  double brute_ray_ns = elapsed_ms(start) * 1e6 / BRUTE_FORCE_RAY_COUNT;
+
+  // Sweeps as short as a tick of player motion, starting inside the bounds of the model
+  float radius = 0.02f * size;
+  glm::vec3 axis(0.0f, 2.0f * radius, 0.0f);
+  start = clock_type::now();
+  for (unsigned int i = 0; i < TIMED_SWEEP_COUNT; i++) {
+    const query& q = queries[i];
+    glm::vec3 from = q.origin + q.dir * 0.9f;
+    bogart::collision::sweep_hit hit;
+    hits += loaded.sweep_capsule(bogart::collision::capsule(from, from + axis, radius), glm::normalize(q.dir) * radius, hit) ? 1 : 0;
+  }
+  double sweep_ns = elapsed_ms(start) * 1e6 / TIMED_SWEEP_COUNT;
+
+  std::cout << std::setw(22) << "query" << std::setw(14) << "ns/query" << "\n"
+            << std::setw(22) << "raycast (BVH)" << std::setw(14) << bvh_ray_ns << "\n"
+            << std::setw(22) << "raycast (brute force)" << std::setw(14) << brute_ray_ns << "\n"
+            << std::setw(22) << "capsule sweep (BVH)" << std::setw(14) << sweep_ns << "\n"
+            << "(" << hits << " hits)\n";
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include "bogart/service/input_state.hpp"
+#include "bogart/event.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+
+// Micro-benchmark of the controller's input path. We build batches like the ones a 1000 Hz mouse
+// produces at 60 frames per second (about 16 motion samples per batch plus the odd key event) and
+// feed them through two implementations:
+//
+// - per_event: the previous controller code, which handled every motion sample on its own and
+//   formatted the actor status into an ostringstream each time, even with logging disabled.
+// - input_state: the batch is folded into held keys and a single mouse delta.
+//
+// We report the time per event and the number of heap allocations per batch. The event vectors are
+// built beforehand, so their allocations don't count.
+
+unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = std::malloc(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+const unsigned int BATCH_COUNT = 20000;
+const unsigned int MOUSE_SAMPLES_PER_BATCH = 16;
+
+struct actor_state
+{
+  actor_state() : pitch(0.0f), yaw(0.0f), w(false)
+  {
+
+  }
+
+  float pitch;
+  float yaw;
+  bool w;
+};
+
+std::vector<bogart::event_vector> make_batches() {
+  std::vector<bogart::event_vector> batches(BATCH_COUNT);
+  float x = 0.0f;
+  for (unsigned int i = 0; i < BATCH_COUNT; i++) {
+    for (unsigned int j = 0; j < MOUSE_SAMPLES_PER_BATCH; j++) {
+      x += 1.0f;
+      batches[i].push_back(bogart::event(bogart::EVENT_MOUSE_MOVE, bogart::KEY_UNKNOWN, x, 0.5f * x));
+    }
+    if (i % 30 == 0) {
+      batches[i].push_back(bogart::event(bogart::EVENT_KEY_PRESS, bogart::KEY_W, 0.0f, 0.0f));
+    } else if (i % 30 == 15) {
+      batches[i].push_back(bogart::event(bogart::EVENT_KEY_RELEASE, bogart::KEY_W, 0.0f, 0.0f));
+    }
+  }
+  return batches;
+}
+
+void per_event(const bogart::event_vector& events, actor_state& a, float& last_x, float& last_y) {
+  for (bogart::event_vector::const_iterator it = events.begin(); it != events.end(); it++) {
+    if (it->type == bogart::EVENT_KEY_PRESS && it->value == bogart::KEY_W) {
+      a.w = true;
+    } else if (it->type == bogart::EVENT_KEY_RELEASE && it->value == bogart::KEY_W) {
+      a.w = false;
+    } else if (it->type == bogart::EVENT_MOUSE_MOVE) {
+      a.yaw -= 0.1f * (it->mouse_x - last_x);
+      last_x = it->mouse_x;
+      a.pitch += 0.1f * (last_y - it->mouse_y);
+      last_y = it->mouse_y;
+
+      std::ostringstream os;
+      os << std::setprecision(2) << std::fixed << "pitch: " << a.pitch << ", yaw: " << a.yaw;
+      // The string was handed to log::debug, which discarded it
+      if (os.str().empty()) {
+        a.w = false;
+      }
+    }
+  }
+}
+
+void batched(const bogart::event_vector& events, actor_state& a, bogart::service::input_state& input) {
+  input.process(events);
+  a.w = input.is_key_down(bogart::KEY_W);
+  a.yaw -= 0.1f * input.get_mouse_dx();
+  a.pitch -= 0.1f * input.get_mouse_dy();
+}
+
+void report(const char* name, std::chrono::steady_clock::duration d, unsigned long allocs, const actor_state& a) {
+  double events = BATCH_COUNT * (MOUSE_SAMPLES_PER_BATCH + 0.067);
+  std::cout << std::setw(12) << name
+            << std::fixed << std::setprecision(1)
+            << std::setw(14) << std::chrono::duration<double, std::nano>(d).count() / events
+            << std::setw(16) << std::setprecision(2) << static_cast<double>(allocs) / BATCH_COUNT
+            << "    (yaw " << a.yaw << ")\n";
+}
+
+int main() {
+  std::vector<bogart::event_vector> batches = make_batches();
+  std::cout << std::setw(12) << "path" << std::setw(14) << "ns/event" << std::setw(16) << "allocs/batch" << "\n";
+
+  {
+    actor_state a;
+    float last_x = 0.0f;
+    float last_y = 0.0f;
+    unsigned long before = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < BATCH_COUNT; i++) {
+      per_event(batches[i], a, last_x, last_y);
+    }
+    report("per_event", std::chrono::steady_clock::now() - start, allocations - before, a);
+  }
+
+  {
+    actor_state a;
+    bogart::service::input_state input;
+    unsigned long before = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < BATCH_COUNT; i++) {
+      batched(batches[i], a, input);
+    }
+    unsigned long allocs = allocations - before;
+    report("input_state", std::chrono::steady_clock::now() - start, allocs, a);
+
+    if (allocs != 0) {
+      std::cout << "FAILED: input_state allocated in the per-event path\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
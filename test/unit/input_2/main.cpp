@@ -0,0 +1,168 @@
+#include "bogart/async/latency_histogram.hpp"
+#include "bogart/async/message_queue.hpp"
+#include "bogart/event.hpp"
+
+#include <condition_variable>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+
+// Input-to-logic latency of the two ways the view can hand input to the controller. A producer
+// thread plays the window system: it stamps events at random intervals, like a user typing and
+// moving the mouse, and queues them where the view can pick them up. Then:
+//
+// - render_poll: the previous design. The render thread polls the window system once per frame,
+//   at 60 frames per second, and posts what it found to the logic queue.
+// - event_pump: the main thread waits for events and posts them to the logic queue as soon as they
+//   arrive, while rendering happens on another thread.
+//
+// The logic thread records, for every event, the time from its stamp to its handler running. We
+// report the percentiles of that latency. The event pump must beat the per-frame poll.
+
+typedef bogart::event::clock bench_clock;
+
+const unsigned int EVENT_COUNT = 400;
+const bench_clock::duration FRAME_TIME = std::chrono::microseconds(16667);
+
+// Events the window system has seen but nobody has asked for yet
+struct window_system
+{
+  window_system() : mtx(), cv(), pending(), done(false)
+  {
+
+  }
+
+  void push(const bogart::event& e)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    pending.push_back(e);
+    cv.notify_one();
+  }
+
+  void finish()
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    done = true;
+    cv.notify_one();
+  }
+
+  // Like glfwPollEvents
+  bogart::event_vector_ptr poll(bool& finished)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    bogart::event_vector_ptr e = std::make_unique<bogart::event_vector>();
+    e->swap(pending);
+    finished = done;
+    return e;
+  }
+
+  // Like glfwWaitEvents
+  bogart::event_vector_ptr wait(bool& finished)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this]() { return !pending.empty() || done; });
+    bogart::event_vector_ptr e = std::make_unique<bogart::event_vector>();
+    e->swap(pending);
+    finished = done;
+    return e;
+  }
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bogart::event_vector pending;
+  bool done;
+};
+
+void produce(window_system& w) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> gap_us(1000, 8000);
+  for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+    std::this_thread::sleep_for(std::chrono::microseconds(gap_us(rng)));
+    w.push(bogart::event(bogart::EVENT_MOUSE_MOVE, bogart::KEY_UNKNOWN, 0.0f, 0.0f, bench_clock::now()));
+  }
+  w.finish();
+}
+
+void forward(bogart::async::message_queue& logic_queue, bogart::async::latency_histogram& latency, bogart::event_vector_ptr e) {
+  if (e->empty()) {
+    return;
+  }
+
+  logic_queue.post(bogart::async::make_callable([&latency, e = std::move(e)]() {
+    bench_clock::time_point now = bench_clock::now();
+    for (bogart::event_vector::const_iterator it = e->begin(); it != e->end(); it++) {
+      latency.record(now - it->time);
+    }
+  }));
+}
+
+bogart::async::latency_histogram run(bool pump) {
+  window_system w;
+  bogart::async::message_queue logic_queue;
+  bogart::async::latency_histogram latency;
+  std::atomic<bool> finished(false);
+
+  std::thread logic_thread([&]() {
+    while (!finished) {
+      logic_queue.run(std::chrono::milliseconds(100));
+    }
+  });
+  std::thread producer([&]() { produce(w); });
+
+  bool done = false;
+  if (pump) {
+    while (!done) {
+      forward(logic_queue, latency, w.wait(done));
+    }
+  } else {
+    bench_clock::time_point next_frame = bench_clock::now();
+    while (!done) {
+      forward(logic_queue, latency, w.poll(done));
+      next_frame += FRAME_TIME;
+      std::this_thread::sleep_until(next_frame);
+    }
+  }
+
+  producer.join();
+  logic_queue.post(bogart::async::make_callable([&]() { finished = true; }));
+  logic_thread.join();
+  return latency;
+}
+
+double to_ms(bogart::async::latency_histogram::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+void report(const char* name, const bogart::async::latency_histogram& h) {
+  std::cout << std::setw(12) << name << std::fixed << std::setprecision(3)
+            << std::setw(10) << h.get_count()
+            << std::setw(12) << to_ms(h.get_percentile(50.0))
+            << std::setw(12) << to_ms(h.get_percentile(99.0))
+            << std::setw(12) << to_ms(h.get_max()) << "\n";
+}
+
+int main() {
+  std::cout << std::setw(12) << "design" << std::setw(10) << "events" << std::setw(12) << "p50 ms"
+            << std::setw(12) << "p99 ms" << std::setw(12) << "max ms" << "\n";
+
+  bogart::async::latency_histogram before = run(false);
+  report("render_poll", before);
+  bogart::async::latency_histogram after = run(true);
+  report("event_pump", after);
+
+  if (before.get_count() != EVENT_COUNT || after.get_count() != EVENT_COUNT) {
+    std::cout << "FAILED: events were lost\n";
+    return 1;
+  }
+
+  if (after.get_percentile(50.0) * 4 > before.get_percentile(50.0)) {
+    std::cout << "FAILED: the event pump doesn't cut the median latency\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "bogart/service/input_log.hpp"
+#include "bogart/event.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+// Round trip of the input log format. We record a session the way the controller does (event
+// batches interleaved with ticks, each with its timestep) and check that load_input_log() gives
+// back the same records in the same order, bit for bit. Then we check that logs cut short and files
+// that aren't input logs are rejected.
+
+const char* PATH = "input_3.log";
+
+bool failed = false;
+
+void check(bool condition, const std::string& what) {
+  if (!condition) {
+    std::cout << "FAILED: " << what << "\n";
+    failed = true;
+  }
+}
+
+bogart::service::input_batch_vector make_session() {
+  bogart::service::input_batch_vector session;
+  for (unsigned int i = 0; i < 100; i++) {
+    bogart::service::input_batch tick;
+    tick.type = bogart::service::INPUT_RECORD_TICK;
+    tick.time = 16667 * i;
+    tick.dt = 0.012f + 0.0001f * i;
+    session.push_back(tick);
+
+    if (i % 3 == 0) {
+      bogart::service::input_batch batch;
+      batch.time = 16667 * i + 5000;
+      batch.events.push_back(bogart::event(bogart::EVENT_MOUSE_MOVE, bogart::KEY_UNKNOWN, 0.5f * i, 1024.25f - i));
+      batch.events.push_back(bogart::event((i % 2) ? bogart::EVENT_KEY_RELEASE : bogart::EVENT_KEY_PRESS, bogart::KEY_W, 0.0f, 0.0f));
+      session.push_back(batch);
+    }
+  }
+
+  // Empty batches are valid too
+  bogart::service::input_batch empty;
+  empty.time = 2000000;
+  session.push_back(empty);
+  return session;
+}
+
+void write_session(const bogart::service::input_batch_vector& session) {
+  bogart::service::input_recorder recorder;
+  check(recorder.open(PATH), "could not open the log for writing");
+  for (bogart::service::input_batch_vector::const_iterator it = session.begin(); it != session.end(); it++) {
+    if (it->type == bogart::service::INPUT_RECORD_TICK) {
+      recorder.write_tick(it->time, it->dt);
+    } else {
+      recorder.write(it->time, it->events);
+    }
+  }
+  recorder.close();
+}
+
+bool equal(const bogart::service::input_batch& a, const bogart::service::input_batch& b) {
+  if (a.type != b.type || a.time != b.time || a.dt != b.dt || a.events.size() != b.events.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.events.size(); i++) {
+    const bogart::event& ea = a.events[i];
+    const bogart::event& eb = b.events[i];
+    if (ea.type != eb.type || ea.value != eb.value || ea.mouse_x != eb.mouse_x || ea.mouse_y != eb.mouse_y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  bogart::service::input_batch_vector session = make_session();
+  write_session(session);
+
+  // Round trip
+  bogart::service::input_batch_vector loaded;
+  check(bogart::service::load_input_log(PATH, loaded), "could not load the log");
+  check(loaded.size() == session.size(), "wrong number of records");
+  for (size_t i = 0; i < session.size() && i < loaded.size(); i++) {
+    if (!equal(session[i], loaded[i])) {
+      check(false, "record " + std::to_string(i) + " differs");
+      break;
+    }
+  }
+  std::cout << "round trip: " << loaded.size() << " records\n";
+
+  // Cut the log in the middle of its last tick
+  std::ifstream in(PATH, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  {
+    std::ofstream out(PATH, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size() - 2);
+  }
+  loaded.clear();
+  check(!bogart::service::load_input_log(PATH, loaded), "truncated log was accepted");
+
+  // Not an input log
+  {
+    std::ofstream out(PATH, std::ios::binary | std::ios::trunc);
+    out << "BGIX not a log";
+  }
+  loaded.clear();
+  check(!bogart::service::load_input_log(PATH, loaded) && loaded.empty(), "invalid log was accepted");
+
+  std::remove(PATH);
+  std::cout << (failed ? "FAILED\n" : "PASSED\n");
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+#include "bogart/world/movement_system.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <cmath>
+
+// Correctness test and benchmark of the movement kernels.
+//
+// We build a population with every combination of movement flags and a wide range of angles, and
+// advance it for a number of ticks with reference_actor and with update_movement() on every kernel
+// the CPU supports. The kernels must agree with each other to the bit, and with reference_actor to
+// within float rounding (the kernels use their own sine and cosine, and reference_actor sums the
+// forward and right motion in a different order).
+//
+// Then we time each kernel on a large population and report the cost per entity next to the cost
+// of reference_actor.
+
+const unsigned int CHECK_ENTITIES = 1003; // not a multiple of 8, so the tails are exercised
+const unsigned int CHECK_TICKS = 100;
+const unsigned int BENCH_ENTITIES = 100000;
+const unsigned int BENCH_TICKS = 50;
+const float DT = 1.0f / 60.0f;
+const float TOLERANCE = 5e-5f; // relative to the distance travelled
+const float DEG_TO_RAD = 0.017453292f; // = Pi / 180
+
+const char* kernel_name(bogart::world::movement_kernel k) {
+  switch (k) {
+    case bogart::world::MOVEMENT_KERNEL_SCALAR: return "scalar";
+    case bogart::world::MOVEMENT_KERNEL_SSE: return "sse";
+    case bogart::world::MOVEMENT_KERNEL_AVX: return "avx";
+  }
+  return "?";
+}
+
+// Moves the way the player did before it became an entity of the world: forward and right vectors
+// built with the libm sine and cosine, and the motion of each flag added on its own
+struct reference_actor
+{
+  reference_actor(const glm::vec3& position, float pitch, float yaw, float velocity, unsigned int movement) :
+    position(position),
+    forward(-sinf(yaw * DEG_TO_RAD), sinf(pitch * DEG_TO_RAD), -cosf(yaw * DEG_TO_RAD)),
+    right(-sinf((yaw - 90) * DEG_TO_RAD), 0.0f, -cosf((yaw - 90) * DEG_TO_RAD)),
+    velocity(velocity),
+    movement(movement)
+  {
+
+  }
+
+  void update(float dt)
+  {
+    if (movement & bogart::world::MOVE_FORWARD) {
+      position += forward * velocity * dt;
+    }
+    if (movement & bogart::world::MOVE_BACKWARD) {
+      position -= forward * velocity * dt;
+    }
+    if (movement & bogart::world::STRAFE_RIGHT) {
+      position += right * velocity * dt;
+    }
+    if (movement & bogart::world::STRAFE_LEFT) {
+      position -= right * velocity * dt;
+    }
+  }
+
+  glm::vec3 position;
+  glm::vec3 forward;
+  glm::vec3 right;
+  float velocity;
+  unsigned int movement;
+};
+
+// Entities start at the origin so that the comparison measures the motion, not the rounding of
+// large coordinates
+bogart::world::movement_components make_population(unsigned int count) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> yaw(-3600.0f, 3600.0f);
+  std::uniform_real_distribution<float> pitch(-90.0f, 90.0f);
+  std::uniform_real_distribution<float> velocity(0.5f, 10.0f);
+
+  bogart::world::movement_components c;
+  for (unsigned int i = 0; i < count; i++) {
+    c.x.push_back(0.0f);
+    c.y.push_back(0.0f);
+    c.z.push_back(0.0f);
+    c.pitch.push_back(pitch(rng));
+    c.yaw.push_back(yaw(rng));
+    c.velocity.push_back(velocity(rng));
+    c.movement.push_back(static_cast<std::uint8_t>(i % 16));
+  }
+  return c;
+}
+
+bool same_bits(const std::vector<float>& a, const std::vector<float>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), [](float x, float y) {
+    return std::memcmp(&x, &y, sizeof(float)) == 0;
+  });
+}
+
+int main() {
+  const bogart::world::movement_kernel kernels[] = {
+    bogart::world::MOVEMENT_KERNEL_SCALAR,
+    bogart::world::MOVEMENT_KERNEL_SSE,
+    bogart::world::MOVEMENT_KERNEL_AVX
+  };
+  bogart::world::movement_kernel default_kernel = bogart::world::get_movement_kernel();
+  int status = 0;
+
+  // Reference
+  bogart::world::movement_components start = make_population(CHECK_ENTITIES);
+  std::vector<glm::vec3> expected;
+  for (unsigned int i = 0; i < CHECK_ENTITIES; i++) {
+    reference_actor a(glm::vec3(start.x[i], start.y[i], start.z[i]), start.pitch[i], start.yaw[i], start.velocity[i],
+                      start.movement[i]);
+    for (unsigned int t = 0; t < CHECK_TICKS; t++) {
+      a.update(DT);
+    }
+    expected.push_back(a.position);
+  }
+
+  bogart::world::movement_components scalar;
+  for (bogart::world::movement_kernel k : kernels) {
+    if (!bogart::world::set_movement_kernel(k)) {
+      std::cout << std::setw(8) << kernel_name(k) << ": not supported, skipped\n";
+      continue;
+    }
+
+    bogart::world::movement_components c = start;
+    for (unsigned int t = 0; t < CHECK_TICKS; t++) {
+      bogart::world::update_movement(c, 0, CHECK_ENTITIES, DT);
+    }
+
+    float max_error = 0.0f;
+    for (unsigned int i = 0; i < CHECK_ENTITIES; i++) {
+      float travelled = start.velocity[i] * DT * CHECK_TICKS;
+      glm::vec3 d = glm::vec3(c.x[i], c.y[i], c.z[i]) - expected[i];
+      float error = std::max(std::fabs(d.x), std::max(std::fabs(d.y), std::fabs(d.z))) / travelled;
+      max_error = std::max(max_error, error);
+    }
+
+    bool identical = true;
+    if (k == bogart::world::MOVEMENT_KERNEL_SCALAR) {
+      scalar = c;
+    } else {
+      identical = same_bits(c.x, scalar.x) && same_bits(c.y, scalar.y) && same_bits(c.z, scalar.z);
+    }
+
+    std::cout << std::setw(8) << kernel_name(k) << ": max relative error vs reference "
+              << std::scientific << std::setprecision(2) << max_error
+              << (identical ? ", bit-identical to scalar" : ", DIFFERS from scalar") << "\n";
+    if (max_error > TOLERANCE || !identical) {
+      status = 1;
+    }
+  }
+
+  // Benchmark
+  std::cout << "\n" << std::setw(12) << "update" << std::setw(14) << "ns/entity" << "\n";
+  {
+    bogart::world::movement_components c = make_population(BENCH_ENTITIES);
+    std::vector<reference_actor> actors;
+    actors.reserve(BENCH_ENTITIES);
+    for (unsigned int i = 0; i < BENCH_ENTITIES; i++) {
+      actors.emplace_back(glm::vec3(c.x[i], c.y[i], c.z[i]), c.pitch[i], c.yaw[i], c.velocity[i], c.movement[i]);
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < BENCH_TICKS; t++) {
+      for (reference_actor& a : actors) {
+        a.update(DT);
+      }
+    }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - t0;
+    std::cout << std::setw(12) << "reference" << std::setw(14) << std::fixed << std::setprecision(2)
+              << d.count() / (BENCH_TICKS * BENCH_ENTITIES) << "\n";
+  }
+
+  for (bogart::world::movement_kernel k : kernels) {
+    if (!bogart::world::set_movement_kernel(k)) {
+      continue;
+    }
+
+    bogart::world::movement_components c = make_population(BENCH_ENTITIES);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < BENCH_TICKS; t++) {
+      bogart::world::update_movement(c, 0, BENCH_ENTITIES, DT);
+    }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - t0;
+    std::cout << std::setw(12) << kernel_name(k) << std::setw(14) << std::fixed << std::setprecision(2)
+              << d.count() / (BENCH_TICKS * BENCH_ENTITIES) << "\n";
+  }
+
+  bogart::world::set_movement_kernel(default_kernel);
+  if (status != 0) {
+    std::cout << "FAILED\n";
+  }
+  return status;
+}
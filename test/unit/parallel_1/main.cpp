@@ -0,0 +1,124 @@
+#include "bogart/async/worker_pool.hpp"
+#include "bogart/world/entity_world.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+// Speedup of the parallel simulation tick. We advance the same world serially and on worker pools
+// of 1 to N threads (N is the first argument, by default the number of cores but at least 4), and
+// report the time per tick and the speedup over the serial update.
+//
+// Every run must end with exactly the same components as the serial one, and a parallel_reduce()
+// over the positions must give the same sum on every pool, bit for bit. An exception thrown by a
+// chunk must reach the caller of parallel_for(), and leave the pool ready for the next loop.
+
+const unsigned int ENTITY_COUNT = 1000000;
+const unsigned int TICK_COUNT = 60;
+const float DT = 1.0f / 60.0f;
+const std::size_t REDUCE_GRAIN = 10000;
+
+void spawn(bogart::world::entity_world& w) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+  w.reserve(ENTITY_COUNT);
+  for (unsigned int i = 0; i < ENTITY_COUNT; i++) {
+    bogart::world::entity e = w.spawn(glm::vec3(pos(rng), pos(rng), pos(rng)), angle(rng) - 180.0f, angle(rng), 2.0f);
+    w.set_movement(e, (i % 3) ? bogart::world::MOVE_FORWARD : (bogart::world::MOVE_BACKWARD | bogart::world::STRAFE_LEFT));
+  }
+}
+
+bool same_components(const bogart::world::movement_components& a, const bogart::world::movement_components& b) {
+  return std::memcmp(a.x.data(), b.x.data(), a.x.size() * sizeof(float)) == 0 &&
+         std::memcmp(a.y.data(), b.y.data(), a.y.size() * sizeof(float)) == 0 &&
+         std::memcmp(a.z.data(), b.z.data(), a.z.size() * sizeof(float)) == 0;
+}
+
+// Sum of all coordinates, in an order that doesn't depend on the pool
+double sum_positions(bogart::async::worker_pool& pool, const bogart::world::movement_components& c) {
+  return bogart::async::parallel_reduce(pool, 0, c.x.size(), REDUCE_GRAIN, 0.0,
+    [&c](std::size_t begin, std::size_t end) {
+      float sum = 0.0f;
+      for (std::size_t i = begin; i < end; i++) {
+        sum += c.x[i] + c.y[i] + c.z[i];
+      }
+      return static_cast<double>(sum);
+    },
+    [](double a, double b) { return a + b; });
+}
+
+bool check_exceptions(unsigned int threads) {
+  bogart::async::worker_pool pool(threads);
+  bool caught = false;
+  try {
+    pool.parallel_for(0, 1000, 10, [](std::size_t begin, std::size_t) {
+      if (begin == 500) {
+        throw std::runtime_error("chunk failed");
+      }
+    });
+  } catch (const std::runtime_error&) {
+    caught = true;
+  }
+
+  std::size_t chunks = bogart::async::parallel_reduce(pool, 0, 1000, 10, std::size_t(0),
+    [](std::size_t, std::size_t) { return std::size_t(1); },
+    [](std::size_t a, std::size_t b) { return a + b; });
+  return caught && chunks == 100;
+}
+
+int main(int argc, char** argv) {
+  unsigned int max_threads = (argc > 1) ? static_cast<unsigned int>(std::atoi(argv[1])) : std::max(std::thread::hardware_concurrency(), 4u);
+
+  for (unsigned int threads = 1; threads <= 4; threads++) {
+    if (!check_exceptions(threads)) {
+      std::cout << "FAILED: exception thrown by a chunk on a pool of " << threads << " threads was lost\n";
+      return 1;
+    }
+  }
+
+  bogart::world::entity_world serial;
+  spawn(serial);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < TICK_COUNT; i++) {
+    serial.update(DT);
+  }
+  double serial_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / TICK_COUNT;
+
+  bogart::async::worker_pool reference_pool(1);
+  double reference_sum = sum_positions(reference_pool, serial.get_movement_components());
+
+  std::cout << std::thread::hardware_concurrency() << " cores, " << ENTITY_COUNT << " entities\n"
+            << std::setw(10) << "threads" << std::setw(12) << "ms/tick" << std::setw(10) << "speedup" << "\n"
+            << std::setw(10) << "serial" << std::fixed << std::setprecision(2) << std::setw(12) << serial_ms
+            << std::setw(10) << 1.0 << "\n";
+
+  for (unsigned int threads = 1; threads <= max_threads; threads++) {
+    bogart::async::worker_pool pool(threads);
+    bogart::world::entity_world w;
+    spawn(w);
+    start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < TICK_COUNT; i++) {
+      w.update(DT, pool);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / TICK_COUNT;
+    std::cout << std::setw(10) << threads << std::setw(12) << ms << std::setw(10) << serial_ms / ms << "\n";
+
+    if (!same_components(serial.get_movement_components(), w.get_movement_components())) {
+      std::cout << "FAILED: parallel update doesn't match the serial one with " << threads << " threads\n";
+      return 1;
+    }
+    if (sum_positions(pool, w.get_movement_components()) != reference_sum) {
+      std::cout << "FAILED: parallel_reduce depends on the thread count (" << threads << " threads)\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "bogart/service/resolution_scaler.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+// Dynamic resolution on a simulated GPU. A frame costs a fixed part plus a part proportional to
+// the number of pixels, with some noise, and the middle of the run goes through a heavy area where
+// the per-pixel part doubles. We drive two controllers with it:
+//
+// - naive: scales proportionally every frame, with no smoothing, thresholds or delays.
+// - resolution_scaler: the one the view uses.
+//
+// We report how many times each one changed the scale (every change reallocates the render targets)
+// and the share of frames over budget. The resolution_scaler must hold the target in the heavy area
+// without oscillating, and go back to full resolution after it.
+
+const float TARGET = 1.0f / 60.0f;
+const float FIXED_COST = 0.004f;
+const float PIXEL_COST = 0.009f;           // at full resolution, outside the heavy area
+const float HEAVY_FACTOR = 2.0f;
+const unsigned int HEAVY_START = 300;
+const unsigned int HEAVY_END = 2100;
+const unsigned int FRAME_COUNT = 3000;
+const unsigned int SETTLE_FRAMES = 300;    // frames the controllers get to react to a change
+
+struct naive_scaler
+{
+  naive_scaler() : scale(1.0f)
+  {
+
+  }
+
+  bool update(float frame_time)
+  {
+    float s = scale * std::sqrt(TARGET / frame_time);
+    s = std::min(1.0f, std::max(0.5f, s));
+    bool changed = (std::fabs(s - scale) > 1e-4f);
+    scale = s;
+    return changed;
+  }
+
+  float get_scale() const
+  {
+    return scale;
+  }
+
+  float scale;
+};
+
+struct run_result
+{
+  run_result() : changes(0), settled_changes(0), settled_over(0), settled_frames(0), heavy_scale(0.0f), final_scale(0.0f)
+  {
+
+  }
+
+  unsigned int changes;
+  unsigned int settled_changes;            // changes in the heavy area after it settled
+  unsigned int settled_over;               // frames over budget in the heavy area after it settled
+  unsigned int settled_frames;
+  float heavy_scale;                       // scale at the end of the heavy area
+  float final_scale;
+};
+
+template<typename Scaler>
+run_result run(Scaler& scaler) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> noise(0.95f, 1.05f);
+  run_result r;
+  for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+    bool heavy = (i >= HEAVY_START && i < HEAVY_END);
+    float scale = scaler.get_scale();
+    float frame_time = (FIXED_COST + PIXEL_COST * (heavy ? HEAVY_FACTOR : 1.0f) * scale * scale) * noise(rng);
+    bool changed = scaler.update(frame_time);
+    r.changes += changed ? 1 : 0;
+    if (heavy && i >= HEAVY_START + SETTLE_FRAMES) {
+      r.settled_changes += changed ? 1 : 0;
+      r.settled_over += (frame_time > 1.1f * TARGET) ? 1 : 0;
+      r.settled_frames++;
+    }
+    if (i == HEAVY_END - 1) {
+      r.heavy_scale = scaler.get_scale();
+    }
+  }
+  r.final_scale = scaler.get_scale();
+  return r;
+}
+
+void report(const char* name, const run_result& r) {
+  std::cout << std::setw(18) << name
+            << std::setw(10) << r.changes
+            << std::setw(16) << r.settled_changes
+            << std::fixed << std::setprecision(1)
+            << std::setw(14) << 100.0 * r.settled_over / r.settled_frames
+            << std::setprecision(2)
+            << std::setw(14) << r.heavy_scale
+            << std::setw(14) << r.final_scale << "\n";
+}
+
+int main() {
+  std::cout << std::setw(18) << "controller" << std::setw(10) << "changes" << std::setw(16) << "heavy changes"
+            << std::setw(14) << "% over" << std::setw(14) << "heavy scale" << std::setw(14) << "final scale" << "\n";
+
+  naive_scaler naive;
+  report("naive", run(naive));
+
+  bogart::service::resolution_scaler scaler(TARGET);
+  run_result r = run(scaler);
+  report("resolution_scaler", r);
+
+  if (r.heavy_scale >= 1.0f || r.settled_over * 20 > r.settled_frames) {
+    std::cout << "FAILED: resolution_scaler did not hold the target in the heavy area\n";
+    return 1;
+  }
+  if (r.settled_changes > 2) {
+    std::cout << "FAILED: resolution_scaler oscillated in the heavy area\n";
+    return 1;
+  }
+  if (r.final_scale != 1.0f) {
+    std::cout << "FAILED: resolution_scaler did not go back to full resolution\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include "bogart/async/message_queue.hpp"
+#include "bogart/scene_mirror.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <new>
+
+// Benchmark of the ways the logic thread can hand node transforms to the render thread. A scene of
+// NODE_COUNT nodes runs for TICK_COUNT ticks, with one frame per tick. Only MOVING_PERCENT percent
+// of the nodes move; the rest stand still. An array of transforms stands in for the engine. The
+// two threads are played by the same one, so that we only measure the handoff:
+//
+// - per_node_post: one closure per node per tick posted to the render queue, which applies it.
+// - scene_mirror: the logic thread writes every node to the mirror in one batch, and the render
+//   thread collects the dirty ones once per frame and applies them in one pass.
+//
+// We report the time per tick, the heap allocations per tick and the nodes applied per frame. Both
+// must leave the engine with the same transforms.
+
+unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = std::malloc(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+const unsigned int NODE_COUNT = 10000;
+const unsigned int TICK_COUNT = 300;
+const unsigned int MOVING_PERCENT = 20;
+
+glm::mat4 get_transform(unsigned int node, unsigned int tick) {
+  glm::mat4 ret(1.0f);
+  float t = (node % 100 < MOVING_PERCENT) ? static_cast<float>(tick) : 0.0f;
+  ret[3] = glm::vec4(static_cast<float>(node), 0.01f * t, 0.0f, 1.0f);
+  return ret;
+}
+
+void report(const char* name, std::chrono::steady_clock::duration d, unsigned long allocs, unsigned long applied) {
+  std::cout << std::setw(14) << name << std::fixed << std::setprecision(1)
+            << std::setw(14) << std::chrono::duration<double, std::micro>(d).count() / TICK_COUNT
+            << std::setw(14) << static_cast<double>(allocs) / TICK_COUNT
+            << std::setw(16) << static_cast<double>(applied) / TICK_COUNT << "\n";
+}
+
+int main() {
+  std::cout << std::setw(14) << "handoff" << std::setw(14) << "us/tick" << std::setw(14) << "allocs/tick"
+            << std::setw(16) << "applied/frame" << "\n";
+
+  std::vector<glm::mat4> engine_posted(NODE_COUNT);
+  {
+    bogart::async::message_queue render_queue;
+    unsigned long applied = 0;
+    unsigned long before = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int tick = 0; tick < TICK_COUNT; tick++) {
+      for (unsigned int node = 0; node < NODE_COUNT; node++) {
+        glm::mat4 m = get_transform(node, tick);
+        render_queue.post(bogart::async::make_callable([&engine_posted, &applied, node, m]() {
+          engine_posted[node] = m;
+          applied++;
+        }));
+      }
+      render_queue.poll();
+    }
+    report("per_node_post", std::chrono::steady_clock::now() - start, allocations - before, applied);
+  }
+
+  std::vector<glm::mat4> engine_mirrored(NODE_COUNT);
+  {
+    bogart::scene_mirror scene;
+    bogart::scene_node_update_vector updates;
+    std::vector<std::uint32_t> nodes;
+    {
+      bogart::scene_mirror::writer writer = scene.begin_update();
+      for (unsigned int node = 0; node < NODE_COUNT; node++) {
+        nodes.push_back(writer.add_node(get_transform(node, 0), 0));
+      }
+    }
+    updates.reserve(NODE_COUNT);
+
+    unsigned long applied = 0;
+    unsigned long before = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int tick = 0; tick < TICK_COUNT; tick++) {
+      {
+        bogart::scene_mirror::writer writer = scene.begin_update();
+        for (unsigned int node = 0; node < NODE_COUNT; node++) {
+          writer.set_transform(nodes[node], get_transform(node, tick));
+        }
+      }
+
+      scene.collect(updates);
+      for (bogart::scene_node_update_vector::const_iterator it = updates.begin(); it != updates.end(); it++) {
+        engine_mirrored[it->node] = it->transform;
+      }
+      applied += updates.size();
+    }
+    report("scene_mirror", std::chrono::steady_clock::now() - start, allocations - before, applied);
+  }
+
+  if (engine_posted != engine_mirrored) {
+    std::cout << "FAILED: the scene mirror left the engine with different transforms\n";
+    return 1;
+  }
+
+  return 0;
+}
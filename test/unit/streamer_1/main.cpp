@@ -0,0 +1,283 @@
+#include "bogart/resource_streamer.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Checks of resource_streamer against an engine that keeps its resources in memory, so that no
+// Horde3D context is needed. A scene references a geometry and a material, and the material a
+// texture and a file that doesn't exist, so the total grows as resources are loaded:
+//
+// - ordering: every resource is loaded once, after the one that referenced it, with the contents
+//   of its file.
+// - progress: update() with no budget loads at most one resource, the total never goes down, and
+//   loading ends with everything loaded and counted.
+// - failure: a resource whose file isn't in any content directory is loaded with no data, counts as
+//   loaded, and doesn't stop the others.
+// - cancel: reads that were in flight when cancel() or a new start() was called never reach the
+//   engine. We restart with another content directory while the first start() is still reading a
+//   large file, and the engine must get the file of the second one.
+//
+// Each check runs with one and with several I/O threads.
+
+const char* CONTENT_DIR = "streamer_1_nowhere|.";
+const char* SCENE = "streamer_1_scene.xml";
+const char* GEOMETRY = "streamer_1_scene.geo";
+const char* MATERIAL = "streamer_1_scene.material.xml";
+const char* TEXTURE = "streamer_1_scene.dds";
+const char* MISSING = "streamer_1_missing.dds";
+const std::size_t RESOURCE_COUNT = 5;
+const char* LARGE = "streamer_1_large.bin";
+const char* OLD_DIR = "streamer_1_old";    // each one holds LARGE filled with its first letter
+const char* NEW_DIR = "streamer_1_new";
+const std::size_t LARGE_SIZE = 64 * 1024 * 1024;
+const unsigned int RESTART_COUNT = 3;
+const std::chrono::seconds TIMEOUT(10);
+
+// What loading each resource adds to the engine
+std::vector<std::string> get_references(const std::string& name) {
+  if (name == SCENE) {
+    return { GEOMETRY, MATERIAL };
+  } else if (name == MATERIAL) {
+    return { TEXTURE, MISSING };
+  }
+  return std::vector<std::string>();
+}
+
+struct fake_resource
+{
+  explicit fake_resource(const std::string& name) : name(name), loaded(false), had_data(false), data()
+  {
+
+  }
+
+  std::string name;
+  bool loaded;
+  bool had_data;
+  std::string data;
+};
+
+// Handles are indices plus one. Adding a name twice returns the first handle, like Horde3D does.
+class fake_engine : public bogart::resource_engine
+{
+public:
+  fake_engine() : resources(), loads()
+  {
+
+  }
+
+  int add(const std::string& name)
+  {
+    for (std::size_t i = 0; i < resources.size(); i++) {
+      if (resources[i].name == name) {
+        return static_cast<int>(i + 1);
+      }
+    }
+
+    resources.push_back(fake_resource(name));
+    return static_cast<int>(resources.size());
+  }
+
+  virtual int query_unloaded(int index)
+  {
+    for (std::size_t i = 0; i < resources.size(); i++) {
+      if (!resources[i].loaded && index-- == 0) {
+        return static_cast<int>(i + 1);
+      }
+    }
+
+    return 0;
+  }
+
+  virtual std::string get_name(int res)
+  {
+    return resources[res - 1].name;
+  }
+
+  virtual void load(int res, const char* data, int size)
+  {
+    resources[res - 1].loaded = true;
+    resources[res - 1].had_data = (data != 0);
+    resources[res - 1].data = data ? std::string(data, size) : std::string();
+    loads.push_back(res);
+    if (data) {
+      std::vector<std::string> references = get_references(resources[res - 1].name);
+      for (const std::string& name : references) {
+        add(name);
+      }
+    }
+  }
+
+  std::vector<fake_resource> resources;
+  std::vector<int> loads;                  // resources in the order they were loaded
+};
+
+// Every file holds its own name, so that we can tell whether a resource got the right one
+void write_files(bool create) {
+  const char* files[] = { SCENE, GEOMETRY, MATERIAL, TEXTURE };
+  for (const char* name : files) {
+    if (create) {
+      std::ofstream out(name, std::ios::binary);
+      out << name;
+    } else {
+      std::remove(name);
+    }
+  }
+
+  const char* dirs[] = { OLD_DIR, NEW_DIR };
+  for (const char* dir : dirs) {
+    std::string path = std::string(dir) + "/" + LARGE;
+    if (create) {
+      mkdir(dir, 0755);
+      std::ofstream out(path.c_str(), std::ios::binary);
+      std::vector<char> data(LARGE_SIZE, dir[std::string("streamer_1_").size()]);
+      out.write(data.data(), data.size());
+    } else {
+      std::remove(path.c_str());
+      rmdir(dir);
+    }
+  }
+}
+
+// Updates with no budget until loading ends. Returns false on a broken progress rule or a timeout.
+bool run_to_end(bogart::resource_streamer& streamer, fake_engine& engine) {
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + TIMEOUT;
+  bogart::loading_progress last = streamer.get_progress();
+  while (streamer.is_loading()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      std::cout << "FAILED: loading didn't end, " << engine.loads.size() << " resources loaded\n";
+      return false;
+    }
+
+    std::size_t before = engine.loads.size();
+    streamer.update(bogart::resource_streamer::clock::duration::zero());
+    bogart::loading_progress p = streamer.get_progress();
+    if (engine.loads.size() > before + 1) {
+      std::cout << "FAILED: an update with no budget loaded " << engine.loads.size() - before << " resources\n";
+      return false;
+    }
+    if (p.total < last.total || p.loaded < last.loaded || p.loaded > p.total || p.loaded != engine.loads.size()) {
+      std::cout << "FAILED: progress went from " << last.loaded << "/" << last.total << " to " << p.loaded << "/"
+                << p.total << " with " << engine.loads.size() << " resources loaded\n";
+      return false;
+    }
+    last = p;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  return true;
+}
+
+bool check_loading(unsigned int io_threads) {
+  fake_engine engine;
+  engine.add(SCENE);
+  bogart::resource_streamer streamer(engine, io_threads);
+  streamer.start(CONTENT_DIR);
+  if (!run_to_end(streamer, engine)) {
+    return false;
+  }
+
+  // Ordering
+  if (engine.loads.size() != RESOURCE_COUNT || engine.resources.size() != RESOURCE_COUNT) {
+    std::cout << "FAILED: " << engine.loads.size() << " loads of " << engine.resources.size() << " resources, expected "
+              << RESOURCE_COUNT << "\n";
+    return false;
+  }
+  for (std::size_t i = 0; i < engine.loads.size(); i++) {
+    const fake_resource& r = engine.resources[engine.loads[i] - 1];
+    if (std::count(engine.loads.begin(), engine.loads.end(), engine.loads[i]) != 1) {
+      std::cout << "FAILED: " << r.name << " was loaded more than once\n";
+      return false;
+    }
+    std::vector<std::string> references = get_references(r.name);
+    for (const std::string& name : references) {
+      int res = engine.add(name);
+      if (std::find(engine.loads.begin(), engine.loads.begin() + i, res) != engine.loads.begin() + i) {
+        std::cout << "FAILED: " << name << " was loaded before " << r.name << ", which references it\n";
+        return false;
+      }
+    }
+    if (r.name != MISSING && (!r.had_data || r.data != r.name)) {
+      std::cout << "FAILED: " << r.name << " was loaded with the wrong data\n";
+      return false;
+    }
+  }
+
+  // Progress
+  bogart::loading_progress p = streamer.get_progress();
+  if (!p.done || p.loaded != RESOURCE_COUNT || p.total != RESOURCE_COUNT || p.get_fraction() != 1.0f) {
+    std::cout << "FAILED: loading ended at " << p.loaded << "/" << p.total << "\n";
+    return false;
+  }
+
+  // Failure
+  const fake_resource& missing = engine.resources[engine.add(MISSING) - 1];
+  if (!missing.loaded || missing.had_data) {
+    std::cout << "FAILED: the missing file wasn't loaded with no data\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool check_cancel(unsigned int io_threads) {
+  fake_engine engine;
+  engine.add(SCENE);
+  bogart::resource_streamer streamer(engine, io_threads);
+  streamer.start(CONTENT_DIR);
+  streamer.cancel();
+
+  // Give the reads that were in flight time to finish. None of them may be loaded.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  streamer.update(std::chrono::seconds(1));
+  if (!engine.loads.empty() || streamer.is_loading() || streamer.get_progress().total != 0) {
+    std::cout << "FAILED: " << engine.loads.size() << " resources were loaded after cancel()\n";
+    return false;
+  }
+
+  // The read of the first start() is still going when the second one starts
+  for (unsigned int i = 0; i < RESTART_COUNT; i++) {
+    fake_engine restarted;
+    restarted.add(LARGE);
+    bogart::resource_streamer s(restarted, io_threads);
+    s.start(OLD_DIR);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    s.start(NEW_DIR);
+    if (!run_to_end(s, restarted)) {
+      return false;
+    }
+    const std::string& data = restarted.resources[0].data;
+    if (restarted.loads.size() != 1 || data.size() != LARGE_SIZE || data[0] != 'n') {
+      std::cout << "FAILED: after restarting, " << LARGE << " was loaded " << restarted.loads.size()
+                << " times, last from the " << (data.empty() ? "none" : (data[0] == 'n' ? "new" : "old"))
+                << " directory\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main() {
+  write_files(true);
+  bool ok = true;
+  const unsigned int thread_counts[] = { 1, 4 };
+  for (unsigned int threads : thread_counts) {
+    bool loading = check_loading(threads);
+    bool cancel = check_cancel(threads);
+    std::cout << threads << " I/O thread(s): loading " << (loading ? "ok" : "failed") << ", cancel "
+              << (cancel ? "ok" : "failed") << "\n";
+    ok = ok && loading && cancel;
+  }
+  write_files(false);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
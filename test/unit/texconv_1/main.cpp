@@ -0,0 +1,193 @@
+#include "tools/texconv/texture.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <cmath>
+
+// Quality and speed of the bogart_texconv block encoder. We build images like the ones in Sponza
+// (smooth gradients with noise on top, and a cutout alpha channel), encode their whole mip chain as
+// BC1 and BC3, decode the blocks back the way the GPU does and compare them with the source:
+//
+// - bytes per pixel: must be 0.5 for BC1 and 1 for BC3, against 4 for the RGBA8 textures the
+//   engine builds from JPG files. Every level must take the size the BC formats define: 8 bytes
+//   (BC1) or 16 bytes (BC3) per 4x4 block, partial blocks included.
+// - RMSE of the base level, in 8 bit steps. It must stay under the bound each image has.
+// - encoding speed in megapixels per second.
+
+const unsigned int SIZE = 512;
+
+struct test_image
+{
+  const char* name;
+  unsigned int noise;        // amplitude of the noise added to the gradient
+  bool cutout;               // whether alpha has holes, as foliage textures have
+  double max_rmse;
+};
+
+// Size of a level as the BC1 and BC3 formats define it, independently of get_level_size()
+std::size_t get_spec_size(bogart::texconv::texture_format format, unsigned int width, unsigned int height) {
+  std::size_t blocks = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4);
+  return blocks * (format == bogart::texconv::FORMAT_BC1 ? 8 : 16);
+}
+
+bogart::texconv::image make_image(const test_image& t) {
+  bogart::texconv::image img(SIZE, SIZE);
+  std::srand(1);
+  for (unsigned int y = 0; y < SIZE; y++) {
+    for (unsigned int x = 0; x < SIZE; x++) {
+      std::uint8_t* p = &img.pixels[4 * (y * SIZE + x)];
+      int n = t.noise ? static_cast<int>(std::rand() % (2 * t.noise + 1)) - static_cast<int>(t.noise) : 0;
+      p[0] = static_cast<std::uint8_t>(std::min(std::max(static_cast<int>(x * 255 / SIZE) + n, 0), 255));
+      p[1] = static_cast<std::uint8_t>(std::min(std::max(static_cast<int>(y * 255 / SIZE) + n, 0), 255));
+      p[2] = static_cast<std::uint8_t>(std::min(std::max(static_cast<int>((x + y) * 127 / SIZE) + n, 0), 255));
+      p[3] = (t.cutout && ((x / 32 + y / 32) % 2)) ? 0 : 255;
+    }
+  }
+  return img;
+}
+
+void decode_565(std::uint16_t c, int* rgb) {
+  rgb[0] = ((c >> 11) & 31) * 255 / 31;
+  rgb[1] = ((c >> 5) & 63) * 255 / 63;
+  rgb[2] = (c & 31) * 255 / 31;
+}
+
+// Decodes the color part of a block into 16 RGB pixels
+void decode_color_block(const std::uint8_t* block, bool four_colors_only, int rgb[16][3]) {
+  std::uint16_t c0 = static_cast<std::uint16_t>(block[0] | (block[1] << 8));
+  std::uint16_t c1 = static_cast<std::uint16_t>(block[2] | (block[3] << 8));
+  int palette[4][3];
+  decode_565(c0, palette[0]);
+  decode_565(c1, palette[1]);
+  for (unsigned int i = 0; i < 3; i++) {
+    if (c0 > c1 || four_colors_only) {
+      palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+      palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+    } else {
+      palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+      palette[3][i] = 0;
+    }
+  }
+  std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<std::uint32_t>(block[7]) << 24);
+  for (unsigned int p = 0; p < 16; p++) {
+    for (unsigned int i = 0; i < 3; i++) {
+      rgb[p][i] = palette[(indices >> (2 * p)) & 3][i];
+    }
+  }
+}
+
+void decode_alpha_block(const std::uint8_t* block, int alpha[16]) {
+  int a0 = block[0];
+  int a1 = block[1];
+  int palette[8] = { a0, a1, 0, 0, 0, 0, 0, 255 };
+  for (int k = 2; k < 8; k++) {
+    if (a0 > a1) {
+      palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+    } else if (k < 6) {
+      palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+    }
+  }
+  std::uint64_t bits = 0;
+  for (unsigned int i = 0; i < 6; i++) {
+    bits |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+  }
+  for (unsigned int p = 0; p < 16; p++) {
+    alpha[p] = palette[(bits >> (3 * p)) & 7];
+  }
+}
+
+// Root mean square error over all channels, in 8 bit steps
+double get_rmse(const bogart::texconv::image& img, bogart::texconv::texture_format format, const std::vector<std::uint8_t>& data) {
+  unsigned int block_bytes = (format == bogart::texconv::FORMAT_BC1) ? 8 : 16;
+  unsigned int blocks_x = (img.width + 3) / 4;
+  double sum = 0.0;
+  for (unsigned int y = 0; y < img.height; y++) {
+    for (unsigned int x = 0; x < img.width; x++) {
+      const std::uint8_t* block = &data[block_bytes * ((y / 4) * blocks_x + x / 4)];
+      int rgb[16][3];
+      int alpha[16];
+      unsigned int p = (y % 4) * 4 + x % 4;
+      if (format == bogart::texconv::FORMAT_BC1) {
+        decode_color_block(block, false, rgb);
+        alpha[p] = 255;
+      } else {
+        decode_alpha_block(block, alpha);
+        decode_color_block(block + 8, true, rgb);
+      }
+      const std::uint8_t* source = &img.pixels[4 * (y * img.width + x)];
+      for (unsigned int i = 0; i < 3; i++) {
+        sum += (rgb[p][i] - source[i]) * (rgb[p][i] - source[i]);
+      }
+      sum += (alpha[p] - source[3]) * (alpha[p] - source[3]);
+    }
+  }
+  return std::sqrt(sum / (4.0 * img.width * img.height));
+}
+
+int main() {
+  const test_image IMAGES[] = {
+    { "gradient", 0, false, 3.0 },
+    { "noisy", 12, false, 8.0 },
+    { "cutout", 4, true, 6.0 }
+  };
+  const bogart::texconv::texture_format FORMATS[] = { bogart::texconv::FORMAT_BC1, bogart::texconv::FORMAT_BC3 };
+
+  std::cout << std::setw(10) << "image" << std::setw(8) << "format" << std::setw(16) << "bytes/pixel"
+            << std::setw(10) << "rmse" << std::setw(14) << "Mpixels/s" << "\n";
+  bool failed = false;
+  for (const test_image& t : IMAGES) {
+    bogart::texconv::image img = make_image(t);
+    bogart::texconv::image_vector levels;
+    bogart::texconv::make_mip_chain(img, levels);
+    if (levels.size() != 10 || levels.back().width != 1 || levels.back().height != 1) {
+      std::cout << "FAILED: wrong mip chain for " << t.name << "\n";
+      return 1;
+    }
+
+    for (bogart::texconv::texture_format format : FORMATS) {
+      // BC1 has no alpha, so cutouts go to BC3
+      if (format == bogart::texconv::FORMAT_BC1 && bogart::texconv::has_alpha(img)) {
+        continue;
+      }
+
+      std::vector<std::uint8_t> data;
+      std::size_t pixels = 0;
+      std::size_t expected_size = 0;
+      bool level_sizes_ok = true;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (const bogart::texconv::image& level : levels) {
+        bogart::texconv::encode_level(level, format, data);
+        pixels += level.width * level.height;
+        std::size_t spec_size = get_spec_size(format, level.width, level.height);
+        expected_size += spec_size;
+        level_sizes_ok = level_sizes_ok && bogart::texconv::get_level_size(format, level.width, level.height) == spec_size;
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      std::vector<std::uint8_t> base(data.begin(), data.begin() + get_spec_size(format, SIZE, SIZE));
+      double rmse = get_rmse(img, format, base);
+      std::cout << std::setw(10) << t.name << std::setw(8) << bogart::texconv::get_format_name(format)
+                << std::fixed << std::setprecision(2) << std::setw(16) << static_cast<double>(data.size()) / pixels
+                << std::setw(10) << rmse << std::setw(14) << std::setprecision(1) << pixels / seconds / 1e6 << "\n";
+
+      if (data.size() != expected_size) {
+        std::cout << "FAILED: encoded " << data.size() << " bytes, expected " << expected_size << "\n";
+        failed = true;
+      }
+      if (!level_sizes_ok) {
+        std::cout << "FAILED: get_level_size() disagrees with the " << bogart::texconv::get_format_name(format)
+                  << " block size\n";
+        failed = true;
+      }
+      if (rmse > t.max_rmse) {
+        std::cout << "FAILED: rmse above " << t.max_rmse << "\n";
+        failed = true;
+      }
+    }
+  }
+
+  return failed ? 1 : 0;
+}
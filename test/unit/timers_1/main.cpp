@@ -1,7 +1,9 @@
+#include "bogart/service/cmd_line_args.hpp"
 #include "bogart/async/message_queue.hpp"
 #include "bogart/async/timer.hpp"
 
 #include <iostream>
+#include <sstream>
 #include <chrono>
 
 bogart::async::message_queue q;
@@ -31,11 +33,60 @@ void timer_handler3() {
   q.post(bogart::async::make_callable(func2));
 }
 
-int main() {
+// Accuracy benchmark: a timer re-armed every 15 milliseconds, like the controller's logic tick.
+// Deadlines are absolute, so lateness does not accumulate from one tick to the next. The default
+// p99 threshold is half a tick: a tick that is later than that gets merged with the next one in
+// the camera motion.
+const std::chrono::milliseconds TICK(15);
+const unsigned int TICK_COUNT = 200;
+bogart::async::timer::time_point tick_deadline;
+unsigned int ticks = 0;
+
+void tick(bogart::async::timer& tm) {
+  if (++ticks < TICK_COUNT) {
+    tick_deadline += TICK;
+    tm.async_wait(tick_deadline, bogart::async::make_callable([&tm]() { tick(tm); }));
+  } else {
+    done = true;
+  }
+}
+
+double to_micros(bogart::async::latency_histogram::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+// Percentiles of the values 1 to 10 ns, which get a bucket each. The result must be the smallest
+// value with at least that percentage of the values at or below it.
+bool check_percentiles() {
+  bogart::async::latency_histogram h;
+  for (int ns = 1; ns <= 10; ns++) {
+    h.record(std::chrono::nanoseconds(ns));
+  }
+
+  const double percentiles[] = { 0.0, 10.0, 11.0, 40.0, 43.0, 50.0, 99.0, 100.0 };
+  const long long expected[] = { 1, 1, 2, 4, 5, 5, 10, 10 };
+  for (unsigned int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+    long long actual = h.get_percentile(percentiles[i]).count();
+    if (actual != expected[i]) {
+      std::cout << "FAILED: p" << percentiles[i] << " of 1..10 ns is " << actual << " ns, expected " << expected[i]
+                << " ns\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Call like this:
+// $ ./timers_1 -p99-threshold-us 7500 [-high-precision]
+int main(int argc, char** argv) {
+  bogart::service::cmd_line_args args(argc, argv);
+  bogart::async::set_timer_high_precision(args.has_option("-high-precision"));
+
   bogart::async::timer tm1(q);
   bogart::async::timer tm2(q);
   bogart::async::timer tm3(q);
-  bogart::async::timer::time_point now = std::chrono::high_resolution_clock::now();
+  bogart::async::timer::time_point now = bogart::async::timer::clock::now();
   tm2.async_wait(now + std::chrono::seconds(2), bogart::async::make_callable(timer_handler2));
   tm3.async_wait(now + std::chrono::seconds(3), bogart::async::make_callable(timer_handler3));
   tm1.async_wait(now + std::chrono::seconds(1), bogart::async::make_callable(timer_handler1));
@@ -45,5 +96,38 @@ int main() {
     q.run(std::chrono::milliseconds(500));
   }
 
+  if (!check_percentiles()) {
+    return 1;
+  }
+
+  // Run the accuracy benchmark
+  double threshold = 0.0;
+  std::stringstream ss;
+  ss << args.get_option_value("-p99-threshold-us", "7500");
+  ss >> threshold;
+
+  done = false;
+  bogart::async::timer tm4(q);
+  tick_deadline = bogart::async::timer::clock::now() + TICK;
+  tm4.async_wait(tick_deadline, bogart::async::make_callable([&tm4]() { tick(tm4); }));
+  while (!done) {
+    q.run(std::chrono::milliseconds(500));
+  }
+
+  bogart::async::latency_histogram lateness = tm4.get_lateness();
+  double p99 = to_micros(lateness.get_percentile(99.0));
+  std::cout << "Lateness over " << lateness.get_count() << " ticks (us):"
+            << " min " << to_micros(lateness.get_min())
+            << ", mean " << to_micros(lateness.get_mean())
+            << ", p50 " << to_micros(lateness.get_percentile(50.0))
+            << ", p99 " << p99
+            << ", max " << to_micros(lateness.get_max()) << "\n";
+
+  if (p99 > threshold) {
+    std::cout << "FAILED: p99 lateness is over the threshold of " << threshold << " us\n";
+    return 1;
+  }
+
+  std::cout << "PASSED\n";
   return 0;
 }
@@ -0,0 +1,123 @@
+#include "bogart/async/message_queue.hpp"
+#include "bogart/async/timer.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+// Benchmark of the timer backends. A set of periodic timers with slightly different periods runs
+// for a while on each backend. For every configuration we report how many times the timer thread
+// woke up, how many batches of handlers it posted to the queue and how late the handlers ran with
+// respect to their deadlines (jitter).
+
+typedef bogart::async::timer::clock bench_clock;
+typedef std::chrono::duration<double, std::micro> micros;
+
+const unsigned int TIMER_COUNT = 16;
+const bench_clock::duration RUN_TIME = std::chrono::seconds(2);
+
+struct periodic_timer
+{
+  periodic_timer(bogart::async::message_queue& q, bench_clock::duration period, bench_clock::duration slack) :
+    t(q, slack), period(period), deadline()
+  {
+
+  }
+
+  bogart::async::timer t;
+  bench_clock::duration period;
+  bogart::async::timer::time_point deadline;
+};
+
+bogart::async::message_queue q;
+std::vector<double> lateness;
+bench_clock::time_point end_time;
+unsigned int active = 0;
+
+void arm(periodic_timer& p);
+
+void on_timer(periodic_timer& p) {
+  bench_clock::time_point now = bench_clock::now();
+  lateness.push_back(micros(now - p.deadline).count());
+  if (now < end_time) {
+    arm(p);
+  } else {
+    active--;
+  }
+}
+
+void arm(periodic_timer& p) {
+  p.deadline += p.period;
+  p.t.async_wait(p.deadline, bogart::async::make_callable([&p]() { on_timer(p); }));
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+void run(const char* name, bogart::async::timer_backend backend, bench_clock::duration slack) {
+  if (!bogart::async::set_timer_backend(backend)) {
+    std::cout << std::setw(10) << name << "  not available on this platform\n";
+    return;
+  }
+
+  // Periods go from 5 ms to 8.75 ms, so deadlines rarely coincide
+  std::vector<std::unique_ptr<periodic_timer>> timers;
+  lateness.clear();
+  bench_clock::time_point start = bench_clock::now();
+  end_time = start + RUN_TIME;
+  for (unsigned int i = 0; i < TIMER_COUNT; i++) {
+    timers.push_back(std::make_unique<periodic_timer>(q, std::chrono::microseconds(5000 + 250 * i), slack));
+    timers.back()->deadline = start;
+    arm(*timers.back());
+  }
+  active = TIMER_COUNT;
+
+  bogart::async::timer_loop_stats before = bogart::async::get_timer_loop_stats();
+  while (active > 0) {
+    q.run(std::chrono::milliseconds(100));
+  }
+  bogart::async::timer_loop_stats after = bogart::async::get_timer_loop_stats();
+
+  std::sort(lateness.begin(), lateness.end());
+  double mean = 0.0;
+  for (double l : lateness) {
+    mean += l;
+  }
+  mean /= (lateness.empty() ? 1 : lateness.size());
+
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(10) << name
+            << std::setw(12) << std::chrono::duration_cast<std::chrono::microseconds>(slack).count()
+            << std::setw(10) << (after.wake_ups - before.wake_ups)
+            << std::setw(10) << (after.posts - before.posts)
+            << std::setw(10) << lateness.size()
+            << std::setw(10) << mean
+            << std::setw(10) << percentile(lateness, 0.5)
+            << std::setw(10) << percentile(lateness, 0.99)
+            << std::setw(10) << (lateness.empty() ? 0.0 : lateness.back()) << "\n";
+}
+
+int main() {
+  std::cout << std::setw(10) << "backend"
+            << std::setw(12) << "slack(us)"
+            << std::setw(10) << "wake-ups"
+            << std::setw(10) << "posts"
+            << std::setw(10) << "firings"
+            << std::setw(10) << "mean(us)"
+            << std::setw(10) << "p50(us)"
+            << std::setw(10) << "p99(us)"
+            << std::setw(10) << "max(us)" << "\n";
+
+  run("condvar", bogart::async::TIMER_BACKEND_CONDITION_VARIABLE, std::chrono::microseconds(0));
+  run("timerfd", bogart::async::TIMER_BACKEND_TIMERFD, std::chrono::microseconds(0));
+  run("condvar", bogart::async::TIMER_BACKEND_CONDITION_VARIABLE, std::chrono::microseconds(2000));
+  run("timerfd", bogart::async::TIMER_BACKEND_TIMERFD, std::chrono::microseconds(2000));
+
+  return 0;
+}
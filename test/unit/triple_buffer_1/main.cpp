@@ -0,0 +1,90 @@
+#include "bogart/async/triple_buffer.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+
+// Stress test of triple_buffer. A writer thread publishes an increasing counter as fast as it can,
+// written to every word of a payload several cache lines long, while a reader thread reads as fast
+// as it can. The reader checks that:
+//
+// - every value it reads has the same counter in all of its words (no torn reads).
+// - the counter never goes backwards, and update() returning true always brings a newer one.
+// - once the writer has stopped, the next update() brings the last value published, and the ones
+//   after it return false.
+
+const std::uint64_t PUBLISH_COUNT = 2000000;
+const unsigned int PAYLOAD_WORDS = 64;           // 512 bytes, 8 cache lines
+
+struct payload
+{
+  payload() : words()
+  {
+
+  }
+
+  std::uint64_t words[PAYLOAD_WORDS];
+};
+
+bool is_torn(const payload& p) {
+  for (unsigned int i = 1; i < PAYLOAD_WORDS; i++) {
+    if (p.words[i] != p.words[0]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main() {
+  bogart::async::triple_buffer<payload> buffer;
+  std::atomic<bool> writer_done(false);
+
+  std::thread writer([&]() {
+    for (std::uint64_t n = 1; n <= PUBLISH_COUNT; n++) {
+      payload& p = buffer.get_write_buffer();
+      for (unsigned int i = 0; i < PAYLOAD_WORDS; i++) {
+        p.words[i] = n;
+      }
+      buffer.publish();
+    }
+    writer_done.store(true, std::memory_order_release);
+  });
+
+  bool ok = true;
+  std::uint64_t last = 0;
+  std::uint64_t updates = 0;
+  std::uint64_t reads = 0;
+  bool done = false;
+  while (ok && !done) {
+    // Read the flag before updating, so that an update after the writer finished sees its last value
+    done = writer_done.load(std::memory_order_acquire);
+    bool updated = buffer.update();
+    const payload& p = buffer.get_read_buffer();
+    std::uint64_t n = p.words[0];
+    reads++;
+    if (is_torn(p)) {
+      std::cout << "FAILED: torn read of value " << n << "\n";
+      ok = false;
+    } else if (updated ? n <= last : n != last) {
+      std::cout << "FAILED: read " << n << " after " << last << (updated ? " with" : " without") << " an update\n";
+      ok = false;
+    }
+    updates += updated ? 1 : 0;
+    last = n;
+  }
+  writer.join();
+
+  if (ok && last != PUBLISH_COUNT) {
+    std::cout << "FAILED: the last value read was " << last << ", not the last one published\n";
+    ok = false;
+  }
+  if (ok && (buffer.update() || buffer.update())) {
+    std::cout << "FAILED: update() returned true after the writer stopped and the last value was read\n";
+    ok = false;
+  }
+
+  std::cout << PUBLISH_COUNT << " values published, " << updates << " seen in " << reads << " reads\n";
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+#include "bogart/world/entity_world.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+
+// Scaling benchmark of entity_world::update(). For each entity count we spawn that many moving
+// actors, run updates for about half a second and report entity updates per second and the cost
+// per entity. A flat ns/entity column means the update scales linearly with the number of
+// entities, i.e. the component arrays stream through the cache.
+//
+// Before timing anything we check that spawning and destroying entities keeps handles and
+// components together.
+
+const float DT = 1.0f / 60.0f;
+const double TARGET_SECONDS = 0.5;
+
+void spawn(bogart::world::entity_world& w, unsigned int count) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+  w.reserve(count);
+  for (unsigned int i = 0; i < count; i++) {
+    bogart::world::entity e = w.spawn(glm::vec3(pos(rng), pos(rng), pos(rng)), 0.0f, angle(rng), 2.0f);
+    w.set_movement(e, (i % 2) ? bogart::world::MOVE_FORWARD : (bogart::world::MOVE_FORWARD | bogart::world::STRAFE_LEFT));
+  }
+}
+
+bool check_handles() {
+  bogart::world::entity_world w;
+  bogart::world::entity a = w.spawn(glm::vec3(1.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f);
+  bogart::world::entity b = w.spawn(glm::vec3(2.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f);
+  bogart::world::entity c = w.spawn(glm::vec3(3.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f);
+  w.destroy(a);
+  bogart::world::entity d = w.spawn(glm::vec3(4.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f);
+  return !w.is_alive(bogart::world::INVALID_ENTITY) && w.size() == 3 &&
+         w.get_position(b).x == 2.0f && w.get_position(c).x == 3.0f && w.get_position(d).x == 4.0f;
+}
+
+int main() {
+  if (!check_handles()) {
+    std::cout << "FAILED: entity handles don't match their components after destroy\n";
+    return 1;
+  }
+
+  std::cout << std::setw(10) << "entities"
+            << std::setw(12) << "updates"
+            << std::setw(18) << "entity updates/s"
+            << std::setw(14) << "ns/entity" << "\n";
+
+  const unsigned int counts[] = { 1000, 10000, 100000, 1000000 };
+  for (unsigned int count : counts) {
+    bogart::world::entity_world w;
+    spawn(w, count);
+
+    unsigned long updates = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+    while (elapsed.count() < TARGET_SECONDS) {
+      w.update(DT);
+      updates++;
+      elapsed = std::chrono::steady_clock::now() - start;
+    }
+
+    double entity_updates = static_cast<double>(updates) * count;
+    std::cout << std::setw(10) << count
+              << std::setw(12) << updates
+              << std::setw(18) << std::setprecision(3) << std::scientific << entity_updates / elapsed.count()
+              << std::setw(14) << std::fixed << std::setprecision(2) << elapsed.count() * 1e9 / entity_updates
+              << "\n";
+  }
+
+  return 0;
+}
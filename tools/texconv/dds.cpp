@@ -0,0 +1,114 @@
+#include "tools/texconv/dds.hpp"
+#include "bogart/log/log.hpp"
+
+#include <fstream>
+
+namespace bogart
+{
+namespace texconv
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants. See the DDS_HEADER and DDS_PIXELFORMAT documentation of Direct3D.
+    //----------------------------------------------------------------------------------------------
+    const std::uint32_t DDSD_CAPS        = 0x1;
+    const std::uint32_t DDSD_HEIGHT      = 0x2;
+    const std::uint32_t DDSD_WIDTH       = 0x4;
+    const std::uint32_t DDSD_PITCH       = 0x8;
+    const std::uint32_t DDSD_PIXELFORMAT = 0x1000;
+    const std::uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const std::uint32_t DDSD_LINEARSIZE  = 0x80000;
+    const std::uint32_t DDPF_ALPHAPIXELS = 0x1;
+    const std::uint32_t DDPF_FOURCC      = 0x4;
+    const std::uint32_t DDPF_RGB         = 0x40;
+    const std::uint32_t DDSCAPS_COMPLEX  = 0x8;
+    const std::uint32_t DDSCAPS_TEXTURE  = 0x1000;
+    const std::uint32_t DDSCAPS_MIPMAP   = 0x400000;
+    const std::uint32_t HEADER_SIZE      = 124;
+    const std::uint32_t PIXEL_FORMAT_SIZE = 32;
+
+    std::uint32_t make_four_cc(char a, char b, char c, char d)
+    {
+      return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8) |
+             (static_cast<std::uint32_t>(c) << 16) | (static_cast<std::uint32_t>(d) << 24);
+    }
+
+    // DDS files are little endian, whatever the machine
+    void write_uint32(std::ofstream& out, std::uint32_t value)
+    {
+      char bytes[4] = { static_cast<char>(value & 0xff), static_cast<char>((value >> 8) & 0xff),
+                        static_cast<char>((value >> 16) & 0xff), static_cast<char>((value >> 24) & 0xff) };
+      out.write(bytes, sizeof(bytes));
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  bool write_dds(const std::string& path,
+                 texture_format format,
+                 unsigned int width,
+                 unsigned int height,
+                 unsigned int mip_count,
+                 const std::vector<std::uint8_t>& data)
+  {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      log::error(std::string("Could not open DDS file for writing: ") + path);
+      return false;
+    }
+
+    bool compressed = (format != FORMAT_BGRA8);
+    std::uint32_t flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+    flags |= compressed ? DDSD_LINEARSIZE : DDSD_PITCH;
+    std::uint32_t pitch = compressed ? static_cast<std::uint32_t>(get_level_size(format, width, height)) : width * 4;
+
+    out.write("DDS ", 4);
+    write_uint32(out, HEADER_SIZE);
+    write_uint32(out, flags);
+    write_uint32(out, height);
+    write_uint32(out, width);
+    write_uint32(out, pitch);
+    write_uint32(out, 0);                 // depth
+    write_uint32(out, mip_count);
+    for (unsigned int i = 0; i < 11; i++) {
+      write_uint32(out, 0);               // reserved
+    }
+
+    // Pixel format
+    write_uint32(out, PIXEL_FORMAT_SIZE);
+    if (compressed) {
+      write_uint32(out, DDPF_FOURCC);
+      write_uint32(out, (format == FORMAT_BC1) ? make_four_cc('D', 'X', 'T', '1') : make_four_cc('D', 'X', 'T', '5'));
+      for (unsigned int i = 0; i < 5; i++) {
+        write_uint32(out, 0);             // bit count and masks
+      }
+    } else {
+      write_uint32(out, DDPF_RGB | DDPF_ALPHAPIXELS);
+      write_uint32(out, 0);
+      write_uint32(out, 32);
+      write_uint32(out, 0x00ff0000);
+      write_uint32(out, 0x0000ff00);
+      write_uint32(out, 0x000000ff);
+      write_uint32(out, 0xff000000);
+    }
+
+    write_uint32(out, DDSCAPS_TEXTURE | (mip_count > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+    for (unsigned int i = 0; i < 4; i++) {
+      write_uint32(out, 0);               // caps2, caps3, caps4, reserved
+    }
+
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!out) {
+      log::error(std::string("Could not write DDS file: ") + path);
+      return false;
+    }
+
+    return true;
+  }
+} // namespace texconv
+} // namespace bogart
@@ -0,0 +1,28 @@
+#ifndef DDS_HPP
+#define DDS_HPP
+
+#include "tools/texconv/texture.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bogart
+{
+namespace texconv
+{
+  //------------------------------------------------------------------------------------------------
+  //! @brief Writes a 2D texture with its whole mip chain to a DDS file. data holds every level,
+  //!  from the largest to 1x1, as encode_level() lays them out.
+  //! @return false if the file can't be written.
+  //------------------------------------------------------------------------------------------------
+  bool write_dds(const std::string& path,
+                 texture_format format,
+                 unsigned int width,
+                 unsigned int height,
+                 unsigned int mip_count,
+                 const std::vector<std::uint8_t>& data);
+} // namespace texconv
+} // namespace bogart
+
+#endif // DDS_HPP
@@ -0,0 +1,404 @@
+#include "bogart/service/cmd_line_args.hpp"
+#include "bogart/log/log.hpp"
+#include "tools/texconv/texture.hpp"
+#include "tools/texconv/dds.hpp"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <map>
+
+// Converts the textures the materials of a content directory reference to DDS files with their
+// mipmaps already built and compressed, and writes them to an output directory together with the
+// materials, rewritten to point at them. Call like this:
+// $ cd bogart/build/tools/texconv
+// $ ./bogart_texconv -content-dir ../../../resources -output-dir converted
+//
+// The content directory is only read. Run bogart with -content-dir "<output dir>|<content dir>" so
+// that the converted files take precedence over the originals.
+//
+// The load times it prints are only the CPU side of loading, with the files in the page cache:
+// reading and decoding the sources with stb_image against reading the DDS files. Uploading to the
+// GPU, and building the mipmaps the sources don't have, come on top of the first figure.
+//
+// Formats are picked per texture: BC1 for opaque ones, BC3 for the ones with alpha, and plain BGRA8
+// with mipmaps for normal maps and for samplers with allowCompression="false", since this version
+// of Horde3D can't load BC5 and normal maps don't survive BC1 well. Overlay materials are left
+// alone, as they are drawn 1:1 on screen.
+
+// The engine bundles stb_image and exports its C interface. We decode with it so that the pixels
+// we compress are exactly the ones the engine would have uploaded.
+extern "C"
+{
+  unsigned char* stbi_load_from_memory(const unsigned char* buffer, int len, int* x, int* y, int* comp, int req_comp);
+  void stbi_image_free(void* data);
+  const char* stbi_failure_reason();
+}
+
+namespace
+{
+  //------------------------------------------------------------------------------------------------
+  //! Constants
+  //------------------------------------------------------------------------------------------------
+  const std::string OPTION_CONTENT_DIR = "-content-dir";
+  const std::string OPTION_OUTPUT_DIR  = "-output-dir";
+  const std::string MATERIAL_SUFFIX    = ".material.xml";
+  const std::string SKIPPED_DIR        = "overlays";
+  const char* SOURCE_EXTENSIONS[]      = { "jpg", "jpeg", "png", "tga", "bmp" };
+
+  typedef std::chrono::steady_clock clock;
+
+  //------------------------------------------------------------------------------------------------
+  //! Types
+  //------------------------------------------------------------------------------------------------
+  struct texture_job
+  {
+    texture_job() : allow_compression(true), converted(false)
+    {
+
+    }
+
+    bool allow_compression;    // false if any sampler using the texture forbids it
+    bool converted;
+  };
+
+  typedef std::map<std::string, texture_job> texture_job_map;
+
+  struct conversion_report
+  {
+    conversion_report() :
+      converted(0),
+      failed(0),
+      materials(0),
+      decode_time(0.0),
+      dds_read_time(0.0),
+      rgba_bytes(0),
+      dds_bytes(0)
+    {
+      std::fill(formats, formats + bogart::texconv::FORMAT_COUNT, 0u);
+    }
+
+    unsigned int converted;
+    unsigned int failed;
+    unsigned int materials;     // materials rewritten
+    unsigned int formats[bogart::texconv::FORMAT_COUNT];
+    double decode_time;         // reading and decoding the sources from the page cache, in seconds
+    double dds_read_time;       // reading the DDS files from the page cache, in seconds
+    std::size_t rgba_bytes;     // RGBA8 with the mipmaps the engine builds at load time
+    std::size_t dds_bytes;      // DDS data, which is what the GPU keeps
+  };
+
+  //------------------------------------------------------------------------------------------------
+  //! Functions
+  //------------------------------------------------------------------------------------------------
+  std::string get_extension(const std::string& path)
+  {
+    std::size_t dot = path.rfind('.');
+    std::size_t slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+      return "";
+    }
+
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    return extension;
+  }
+
+  bool is_source_texture(const std::string& path)
+  {
+    std::string extension = get_extension(path);
+    return std::find(std::begin(SOURCE_EXTENSIONS), std::end(SOURCE_EXTENSIONS), extension) != std::end(SOURCE_EXTENSIONS);
+  }
+
+  std::string get_dds_path(const std::string& path)
+  {
+    return path.substr(0, path.rfind('.')) + ".dds";
+  }
+
+  std::string join_path(const std::string& dir, const std::string& path)
+  {
+    return (dir.empty() || dir[dir.size() - 1] == '/') ? dir + path : dir + "/" + path;
+  }
+
+  bool read_file(const std::string& path, std::string& data)
+  {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+      return false;
+    }
+
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    data = ss.str();
+    return true;
+  }
+
+  bool write_file(const std::string& path, const std::string& data)
+  {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+    return static_cast<bool>(out);
+  }
+
+  // Creates the directories leading to path
+  void make_parent_dirs(const std::string& path)
+  {
+    for (std::size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+      mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+  }
+
+  // Adds the materials under root/dir to materials, as paths relative to root
+  void find_materials(const std::string& root, const std::string& dir, std::vector<std::string>& materials)
+  {
+    DIR* d = opendir(join_path(root, dir).c_str());
+    if (!d) {
+      return;
+    }
+
+    for (dirent* entry = readdir(d); entry; entry = readdir(d)) {
+      std::string name = entry->d_name;
+      std::string path = dir.empty() ? name : dir + "/" + name;
+      struct stat st;
+      if (name == "." || name == ".." || stat(join_path(root, path).c_str(), &st) != 0) {
+        continue;
+      }
+      if (S_ISDIR(st.st_mode)) {
+        if (path != SKIPPED_DIR) {
+          find_materials(root, path, materials);
+        }
+      } else if (name.size() > MATERIAL_SUFFIX.size() &&
+                 name.compare(name.size() - MATERIAL_SUFFIX.size(), MATERIAL_SUFFIX.size(), MATERIAL_SUFFIX) == 0) {
+        materials.push_back(path);
+      }
+    }
+    closedir(d);
+  }
+
+  // Finds the value of attribute name in the tag text. begin and end delimit it, without quotes.
+  bool find_attribute(const std::string& tag, const std::string& name, std::size_t& begin, std::size_t& end)
+  {
+    std::string key = name + "=\"";
+    for (std::size_t pos = tag.find(key); pos != std::string::npos; pos = tag.find(key, pos + 1)) {
+      if (pos > 0 && std::isspace(static_cast<unsigned char>(tag[pos - 1]))) {
+        begin = pos + key.size();
+        end = tag.find('"', begin);
+        return end != std::string::npos;
+      }
+    }
+
+    return false;
+  }
+
+  std::string get_attribute(const std::string& tag, const std::string& name)
+  {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    return find_attribute(tag, name, begin, end) ? tag.substr(begin, end - begin) : "";
+  }
+
+  // Calls f(tag) for each Sampler tag of the material. f returns the tag to put in its place.
+  template<typename F>
+  std::string for_each_sampler(const std::string& material, F f)
+  {
+    std::string result;
+    std::size_t pos = 0;
+    for (std::size_t start = material.find("<Sampler", pos); start != std::string::npos; start = material.find("<Sampler", pos)) {
+      std::size_t end = material.find('>', start);
+      if (end == std::string::npos) {
+        break;
+      }
+      result += material.substr(pos, start - pos);
+      result += f(material.substr(start, end - start));
+      pos = end;
+    }
+
+    return result + material.substr(pos);
+  }
+
+  // Whether a and b are the same existing directory
+  bool is_same_dir(const std::string& a, const std::string& b)
+  {
+    struct stat sa;
+    struct stat sb;
+    return stat(a.c_str(), &sa) == 0 && stat(b.c_str(), &sb) == 0 && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+  }
+
+  // Converts one texture and writes it as DDS. Returns false on errors, which are logged.
+  bool convert_texture(const std::string& content_dir,
+                       const std::string& output_dir,
+                       const std::string& source,
+                       const texture_job& job,
+                       conversion_report& report)
+  {
+    // Before: the engine reads and decodes the source, uploads it as RGBA8 and builds the mipmaps.
+    // We time the reading and decoding. The source is read once beforehand, so that it comes from
+    // the page cache like the DDS file we read back below.
+    std::string data;
+    if (!read_file(join_path(content_dir, source), data)) {
+      bogart::log::error(std::string("Could not read texture: ") + source);
+      return false;
+    }
+    clock::time_point start = clock::now();
+    read_file(join_path(content_dir, source), data);
+
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const unsigned char*>(data.data()), static_cast<int>(data.size()),
+                                                  &width, &height, &components, 4);
+    if (!pixels) {
+      bogart::log::error(std::string("Could not decode texture: ") + source + " (" + stbi_failure_reason() + ")");
+      return false;
+    }
+    bogart::texconv::image base(width, height);
+    std::copy(pixels, pixels + base.pixels.size(), base.pixels.begin());
+    stbi_image_free(pixels);
+    double decode_time = std::chrono::duration<double>(clock::now() - start).count();
+
+    bogart::texconv::image_vector levels;
+    bogart::texconv::make_mip_chain(base, levels);
+    bogart::texconv::texture_format format = !job.allow_compression ? bogart::texconv::FORMAT_BGRA8 :
+                                             bogart::texconv::has_alpha(base) ? bogart::texconv::FORMAT_BC3 :
+                                             bogart::texconv::FORMAT_BC1;
+    std::vector<std::uint8_t> encoded;
+    std::size_t rgba_bytes = 0;
+    for (bogart::texconv::image_vector::const_iterator it = levels.begin(); it != levels.end(); it++) {
+      bogart::texconv::encode_level(*it, format, encoded);
+      rgba_bytes += bogart::texconv::get_level_size(bogart::texconv::FORMAT_BGRA8, it->width, it->height);
+    }
+
+    std::string target = join_path(output_dir, get_dds_path(source));
+    make_parent_dirs(target);
+    if (!bogart::texconv::write_dds(target, format, base.width, base.height, levels.size(), encoded)) {
+      return false;
+    }
+
+    // After: the engine reads the DDS file and uploads every level as it is. We time the reading.
+    start = clock::now();
+    if (!read_file(target, data)) {
+      bogart::log::error(std::string("Could not read back DDS file: ") + target);
+      return false;
+    }
+    double dds_read_time = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << source << ": " << width << " x " << height << ", "
+       << bogart::texconv::get_format_name(format) << ", " << rgba_bytes / 1024 << " KB -> " << encoded.size() / 1024 << " KB, "
+       << decode_time * 1000.0 << " ms -> " << dds_read_time * 1000.0 << " ms";
+    bogart::log::debug(ss.str());
+
+    report.converted++;
+    report.formats[format]++;
+    report.decode_time += decode_time;
+    report.dds_read_time += dds_read_time;
+    report.rgba_bytes += rgba_bytes;
+    report.dds_bytes += encoded.size();
+    return true;
+  }
+
+  void print_report(const conversion_report& report)
+  {
+    const double MB = 1024.0 * 1024.0;
+    std::cout << std::fixed << std::setprecision(1)
+              << "textures:       " << report.converted << " converted ("
+              << report.formats[bogart::texconv::FORMAT_BC1] << " BC1, "
+              << report.formats[bogart::texconv::FORMAT_BC3] << " BC3, "
+              << report.formats[bogart::texconv::FORMAT_BGRA8] << " BGRA8), " << report.failed << " failed\n"
+              << "materials:      " << report.materials << " rewritten\n"
+              << "load time:      " << report.decode_time * 1000.0 << " ms reading and decoding sources, "
+              << report.dds_read_time * 1000.0 << " ms reading DDS files (CPU only, files in the page cache, "
+              << "GPU upload and mipmap generation not included)\n"
+              << "texture memory: " << report.rgba_bytes / MB << " MB as RGBA8 with mipmaps, "
+              << report.dds_bytes / MB << " MB as DDS\n";
+  }
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+  bogart::service::cmd_line_args args(argc, argv);
+  if (args.has_option("-debug")) {
+    bogart::log::set_log_level(bogart::log::DEBUG);
+  }
+  if (!args.has_option(OPTION_CONTENT_DIR) || !args.has_option(OPTION_OUTPUT_DIR)) {
+    std::cerr << "usage: bogart_texconv -content-dir <dir> -output-dir <dir> [-debug]\n";
+    return 1;
+  }
+  std::string content_dir = args.get_option_value(OPTION_CONTENT_DIR, "");
+  std::string output_dir = args.get_option_value(OPTION_OUTPUT_DIR, "");
+
+  // The sources and materials stay as they are, so that converting never touches the originals
+  if (output_dir.empty() || is_same_dir(content_dir, output_dir)) {
+    std::cerr << "bogart_texconv: the output directory must be a different one than the content directory\n";
+    return 1;
+  }
+
+  // Gather the textures the materials use. A texture is only compressed if every sampler that uses
+  // it allows it.
+  std::vector<std::string> materials;
+  find_materials(content_dir, "", materials);
+  std::sort(materials.begin(), materials.end());
+  std::map<std::string, std::string> material_texts;
+  texture_job_map jobs;
+  for (std::vector<std::string>::const_iterator it = materials.begin(); it != materials.end(); it++) {
+    std::string& text = material_texts[*it];
+    if (!read_file(join_path(content_dir, *it), text)) {
+      bogart::log::error(std::string("Could not read material: ") + *it);
+      continue;
+    }
+    for_each_sampler(text, [&](const std::string& tag) {
+      std::string map = get_attribute(tag, "map");
+      if (is_source_texture(map)) {
+        texture_job& job = jobs[map];
+        job.allow_compression = job.allow_compression && get_attribute(tag, "name") != "normalMap" &&
+                                get_attribute(tag, "allowCompression") != "false";
+      }
+      return tag;
+    });
+  }
+
+  conversion_report report;
+  for (texture_job_map::iterator it = jobs.begin(); it != jobs.end(); it++) {
+    it->second.converted = convert_texture(content_dir, output_dir, it->first, it->second, report);
+    report.failed += it->second.converted ? 0 : 1;
+  }
+
+  // Point the materials at the textures that were converted. The ones that failed keep their source.
+  for (std::map<std::string, std::string>::const_iterator it = material_texts.begin(); it != material_texts.end(); it++) {
+    std::string text = for_each_sampler(it->second, [&](const std::string& tag) {
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      if (!find_attribute(tag, "map", begin, end)) {
+        return tag;
+      }
+      texture_job_map::const_iterator job = jobs.find(tag.substr(begin, end - begin));
+      if (job == jobs.end() || !job->second.converted) {
+        return tag;
+      }
+      return tag.substr(0, begin) + get_dds_path(job->first) + tag.substr(end);
+    });
+
+    if (text != it->second) {
+      std::string target = join_path(output_dir, it->first);
+      make_parent_dirs(target);
+      if (!write_file(target, text)) {
+        bogart::log::error(std::string("Could not write material: ") + target);
+        report.failed++;
+      } else {
+        report.materials++;
+      }
+    }
+  }
+
+  print_report(report);
+  return report.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,362 @@
+#include "tools/texconv/texture.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace bogart
+{
+namespace texconv
+{
+  //------------------------------------------------------------------------------------------------
+  //! Internal helper functions.
+  //------------------------------------------------------------------------------------------------
+  namespace
+  {
+    //----------------------------------------------------------------------------------------------
+    //! Constants
+    //----------------------------------------------------------------------------------------------
+    const unsigned int BLOCK_SIZE = 4;
+    const unsigned int BLOCK_PIXELS = BLOCK_SIZE * BLOCK_SIZE;
+    const unsigned int POWER_ITERATIONS = 8;
+    const char* FORMAT_NAMES[] = { "BC1", "BC3", "BGRA8" };
+
+    //----------------------------------------------------------------------------------------------
+    //! Functions
+    //----------------------------------------------------------------------------------------------
+    std::uint16_t pack_565(const float* rgb)
+    {
+      unsigned int r = static_cast<unsigned int>(std::min(std::max(rgb[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+      unsigned int g = static_cast<unsigned int>(std::min(std::max(rgb[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+      unsigned int b = static_cast<unsigned int>(std::min(std::max(rgb[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+      return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(std::uint16_t c, int* rgb)
+    {
+      int r = (c >> 11) & 31;
+      int g = (c >> 5) & 63;
+      int b = c & 31;
+      rgb[0] = (r << 3) | (r >> 2);
+      rgb[1] = (g << 2) | (g >> 4);
+      rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // Picks the nearest color of the palette c0, c1 describe for each pixel. Returns the squared
+    // error of the block.
+    int fit_indices(const std::uint8_t* rgba, std::uint16_t c0, std::uint16_t c1, std::uint32_t& indices)
+    {
+      int palette[4][3];
+      unpack_565(c0, palette[0]);
+      unpack_565(c1, palette[1]);
+      for (unsigned int i = 0; i < 3; i++) {
+        palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+        palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+      }
+
+      // With equal endpoints the block is in three color mode, where index 3 is transparent
+      unsigned int colors = (c0 == c1) ? 1 : 4;
+      int error = 0;
+      indices = 0;
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        const std::uint8_t* pixel = rgba + 4 * p;
+        int best_distance = INT_MAX;
+        std::uint32_t best = 0;
+        for (std::uint32_t k = 0; k < colors; k++) {
+          int dr = pixel[0] - palette[k][0];
+          int dg = pixel[1] - palette[k][1];
+          int db = pixel[2] - palette[k][2];
+          int distance = dr * dr + dg * dg + db * db;
+          if (distance < best_distance) {
+            best_distance = distance;
+            best = k;
+          }
+        }
+        indices |= best << (2 * p);
+        error += best_distance;
+      }
+
+      return error;
+    }
+
+    // Four color mode needs c0 > c1
+    int fit_ordered(const std::uint8_t* rgba, std::uint16_t& c0, std::uint16_t& c1, std::uint32_t& indices)
+    {
+      if (c0 < c1) {
+        std::swap(c0, c1);
+      }
+      return fit_indices(rgba, c0, c1, indices);
+    }
+
+    // Least squares endpoints for the pixels, keeping the palette entry each one is assigned to.
+    // Returns false if they can't be solved for, which happens when every pixel uses the same entry.
+    bool refine_endpoints(const std::uint8_t* rgba, std::uint32_t indices, std::uint16_t& c0, std::uint16_t& c1)
+    {
+      const float WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+      float aa = 0.0f;
+      float ab = 0.0f;
+      float bb = 0.0f;
+      float ax[3] = { 0.0f, 0.0f, 0.0f };
+      float bx[3] = { 0.0f, 0.0f, 0.0f };
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        float a = WEIGHTS[(indices >> (2 * p)) & 3];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (unsigned int i = 0; i < 3; i++) {
+          ax[i] += a * rgba[4 * p + i];
+          bx[i] += b * rgba[4 * p + i];
+        }
+      }
+
+      float det = aa * bb - ab * ab;
+      if (std::fabs(det) < 1e-6f) {
+        return false;
+      }
+
+      float e0[3];
+      float e1[3];
+      for (unsigned int i = 0; i < 3; i++) {
+        e0[i] = (bb * ax[i] - ab * bx[i]) / det;
+        e1[i] = (aa * bx[i] - ab * ax[i]) / det;
+      }
+      c0 = pack_565(e0);
+      c1 = pack_565(e1);
+      return true;
+    }
+
+    // Endpoints are the pixels at both ends of the principal axis of the block colors, then
+    // refined once by least squares if that lowers the error.
+    void encode_color_block(const std::uint8_t* rgba, std::uint8_t* out)
+    {
+      float mean[3] = { 0.0f, 0.0f, 0.0f };
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        for (unsigned int i = 0; i < 3; i++) {
+          mean[i] += rgba[4 * p + i];
+        }
+      }
+      for (unsigned int i = 0; i < 3; i++) {
+        mean[i] /= BLOCK_PIXELS;
+      }
+
+      float covariance[3][3] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        float d[3] = { rgba[4 * p] - mean[0], rgba[4 * p + 1] - mean[1], rgba[4 * p + 2] - mean[2] };
+        for (unsigned int i = 0; i < 3; i++) {
+          for (unsigned int j = 0; j < 3; j++) {
+            covariance[i][j] += d[i] * d[j];
+          }
+        }
+      }
+
+      float axis[3] = { 1.0f, 1.0f, 1.0f };
+      for (unsigned int k = 0; k < POWER_ITERATIONS; k++) {
+        float next[3];
+        for (unsigned int i = 0; i < 3; i++) {
+          next[i] = covariance[i][0] * axis[0] + covariance[i][1] * axis[1] + covariance[i][2] * axis[2];
+        }
+        float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+        if (length < 1e-6f) {
+          break;
+        }
+        for (unsigned int i = 0; i < 3; i++) {
+          axis[i] = next[i] / length;
+        }
+      }
+
+      unsigned int min_pixel = 0;
+      unsigned int max_pixel = 0;
+      float min_t = 0.0f;
+      float max_t = 0.0f;
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        float t = rgba[4 * p] * axis[0] + rgba[4 * p + 1] * axis[1] + rgba[4 * p + 2] * axis[2];
+        if (p == 0 || t < min_t) {
+          min_t = t;
+          min_pixel = p;
+        }
+        if (p == 0 || t > max_t) {
+          max_t = t;
+          max_pixel = p;
+        }
+      }
+
+      float max_color[3];
+      float min_color[3];
+      for (unsigned int i = 0; i < 3; i++) {
+        max_color[i] = rgba[4 * max_pixel + i];
+        min_color[i] = rgba[4 * min_pixel + i];
+      }
+      std::uint16_t c0 = pack_565(max_color);
+      std::uint16_t c1 = pack_565(min_color);
+      std::uint32_t indices = 0;
+      int error = fit_ordered(rgba, c0, c1, indices);
+
+      std::uint16_t r0 = c0;
+      std::uint16_t r1 = c1;
+      std::uint32_t refined_indices = 0;
+      if (error > 0 && refine_endpoints(rgba, indices, r0, r1) && fit_ordered(rgba, r0, r1, refined_indices) < error) {
+        c0 = r0;
+        c1 = r1;
+        indices = refined_indices;
+      }
+
+      out[0] = static_cast<std::uint8_t>(c0 & 0xff);
+      out[1] = static_cast<std::uint8_t>(c0 >> 8);
+      out[2] = static_cast<std::uint8_t>(c1 & 0xff);
+      out[3] = static_cast<std::uint8_t>(c1 >> 8);
+      for (unsigned int i = 0; i < 4; i++) {
+        out[4 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+      }
+    }
+
+    // Alpha goes from the block maximum to its minimum in eight steps
+    void encode_alpha_block(const std::uint8_t* rgba, std::uint8_t* out)
+    {
+      int a0 = 0;
+      int a1 = 255;
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        a0 = std::max(a0, static_cast<int>(rgba[4 * p + 3]));
+        a1 = std::min(a1, static_cast<int>(rgba[4 * p + 3]));
+      }
+
+      int palette[8] = { a0, a1, a0, a0, a0, a0, a0, a0 };
+      unsigned int entries = 1;
+      if (a0 > a1) {
+        for (int k = 2; k < 8; k++) {
+          palette[k] = ((8 - k) * a0 + (k - 1) * a1 + 3) / 7;
+        }
+        entries = 8;
+      }
+
+      std::uint64_t bits = 0;
+      for (unsigned int p = 0; p < BLOCK_PIXELS; p++) {
+        int alpha = rgba[4 * p + 3];
+        std::uint64_t best = 0;
+        for (unsigned int k = 1; k < entries; k++) {
+          if (std::abs(alpha - palette[k]) < std::abs(alpha - palette[best])) {
+            best = k;
+          }
+        }
+        bits |= best << (3 * p);
+      }
+
+      out[0] = static_cast<std::uint8_t>(a0);
+      out[1] = static_cast<std::uint8_t>(a1);
+      for (unsigned int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<std::uint8_t>(bits >> (8 * i));
+      }
+    }
+
+    // Copies the 4x4 block at (x, y), repeating the last row and column past the image edges
+    void get_block(const image& level, unsigned int x, unsigned int y, std::uint8_t* rgba)
+    {
+      for (unsigned int j = 0; j < BLOCK_SIZE; j++) {
+        unsigned int row = std::min(y + j, level.height - 1);
+        for (unsigned int i = 0; i < BLOCK_SIZE; i++) {
+          unsigned int column = std::min(x + i, level.width - 1);
+          const std::uint8_t* pixel = &level.pixels[4 * (row * level.width + column)];
+          std::copy(pixel, pixel + 4, rgba + 4 * (j * BLOCK_SIZE + i));
+        }
+      }
+    }
+  } // Anonymous namespace
+
+  //------------------------------------------------------------------------------------------------
+  //! Public functions.
+  //------------------------------------------------------------------------------------------------
+  const char* get_format_name(texture_format format)
+  {
+    return (format < FORMAT_COUNT) ? FORMAT_NAMES[format] : "unknown";
+  }
+
+  bool has_alpha(const image& img)
+  {
+    for (std::size_t i = 3; i < img.pixels.size(); i += 4) {
+      if (img.pixels[i] != 255) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void make_mip_chain(const image& base, image_vector& levels)
+  {
+    levels.clear();
+    levels.push_back(base);
+    while (levels.back().width > 1 || levels.back().height > 1) {
+      const image& src = levels.back();
+      image dst(std::max(1u, src.width / 2), std::max(1u, src.height / 2));
+      for (unsigned int y = 0; y < dst.height; y++) {
+        unsigned int y0 = std::min(2 * y, src.height - 1);
+        unsigned int y1 = std::min(2 * y + 1, src.height - 1);
+        for (unsigned int x = 0; x < dst.width; x++) {
+          unsigned int x0 = std::min(2 * x, src.width - 1);
+          unsigned int x1 = std::min(2 * x + 1, src.width - 1);
+          for (unsigned int c = 0; c < 4; c++) {
+            unsigned int sum = src.pixels[4 * (y0 * src.width + x0) + c] + src.pixels[4 * (y0 * src.width + x1) + c] +
+                               src.pixels[4 * (y1 * src.width + x0) + c] + src.pixels[4 * (y1 * src.width + x1) + c];
+            dst.pixels[4 * (y * dst.width + x) + c] = static_cast<std::uint8_t>((sum + 2) / 4);
+          }
+        }
+      }
+      levels.push_back(std::move(dst));
+    }
+  }
+
+  std::size_t get_level_size(texture_format format, unsigned int width, unsigned int height)
+  {
+    std::size_t blocks = static_cast<std::size_t>((width + BLOCK_SIZE - 1) / BLOCK_SIZE) * ((height + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    switch (format) {
+      case FORMAT_BC1:
+        return blocks * 8;
+      case FORMAT_BC3:
+        return blocks * 16;
+      default:
+        return static_cast<std::size_t>(width) * height * 4;
+    }
+  }
+
+  void encode_level(const image& level, texture_format format, std::vector<std::uint8_t>& out)
+  {
+    if (format == FORMAT_BGRA8) {
+      out.reserve(out.size() + level.pixels.size());
+      for (std::size_t i = 0; i < level.pixels.size(); i += 4) {
+        out.push_back(level.pixels[i + 2]);
+        out.push_back(level.pixels[i + 1]);
+        out.push_back(level.pixels[i]);
+        out.push_back(level.pixels[i + 3]);
+      }
+      return;
+    }
+
+    std::uint8_t rgba[4 * BLOCK_PIXELS];
+    std::uint8_t block[16];
+    std::size_t block_bytes = (format == FORMAT_BC1) ? 8 : 16;
+    out.reserve(out.size() + get_level_size(format, level.width, level.height));
+    for (unsigned int y = 0; y < level.height; y += BLOCK_SIZE) {
+      for (unsigned int x = 0; x < level.width; x += BLOCK_SIZE) {
+        get_block(level, x, y, rgba);
+        if (format == FORMAT_BC1) {
+          encode_bc1_block(rgba, block);
+        } else {
+          encode_bc3_block(rgba, block);
+        }
+        out.insert(out.end(), block, block + block_bytes);
+      }
+    }
+  }
+
+  void encode_bc1_block(const std::uint8_t* rgba, std::uint8_t* out)
+  {
+    encode_color_block(rgba, out);
+  }
+
+  void encode_bc3_block(const std::uint8_t* rgba, std::uint8_t* out)
+  {
+    encode_alpha_block(rgba, out);
+    encode_color_block(rgba, out + 8);
+  }
+} // namespace texconv
+} // namespace bogart
@@ -0,0 +1,80 @@
+#ifndef TEXTURE_HPP
+#define TEXTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bogart
+{
+namespace texconv
+{
+  //------------------------------------------------------------------------------------------------
+  //! Formats of the converted textures. They are the ones the Horde3D DDS loader understands.
+  //------------------------------------------------------------------------------------------------
+  enum texture_format
+  {
+    FORMAT_BC1 = 0,    // DXT1, 4 bits per pixel, opaque
+    FORMAT_BC3,        // DXT5, 8 bits per pixel, with alpha
+    FORMAT_BGRA8,      // uncompressed, for textures that must not be compressed
+    FORMAT_COUNT
+  };
+
+  const char* get_format_name(texture_format format);
+
+  //------------------------------------------------------------------------------------------------
+  //! An image in RGBA8, rows top-down, which is how stb_image decodes them and how the engine
+  //! uploads them.
+  //------------------------------------------------------------------------------------------------
+  struct image
+  {
+    image() : width(0), height(0), pixels()
+    {
+
+    }
+
+    image(unsigned int width, unsigned int height) : width(width), height(height), pixels(width * height * 4)
+    {
+
+    }
+
+    unsigned int width;
+    unsigned int height;
+    std::vector<std::uint8_t> pixels;
+  };
+
+  typedef std::vector<image> image_vector;
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Whether any pixel of the image is not fully opaque.
+  //------------------------------------------------------------------------------------------------
+  bool has_alpha(const image& img);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Fills levels with base and its mipmaps down to 1x1, each one a box filter of the
+  //!  previous one. This is what glGenerateMipmap() computes when the engine builds them at load
+  //!  time.
+  //------------------------------------------------------------------------------------------------
+  void make_mip_chain(const image& base, image_vector& levels);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Size in bytes of a width x height level in the given format. Compressed formats are
+  //!  stored in 4x4 blocks, so partial blocks at the edges count as whole ones.
+  //------------------------------------------------------------------------------------------------
+  std::size_t get_level_size(texture_format format, unsigned int width, unsigned int height);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Encodes a level and appends it to out, laid out the way DDS files store it.
+  //------------------------------------------------------------------------------------------------
+  void encode_level(const image& level, texture_format format, std::vector<std::uint8_t>& out);
+
+  //------------------------------------------------------------------------------------------------
+  //! @brief Encodes a 4x4 block of RGBA8 pixels, in rows, as BC1 (8 bytes) or BC3 (16 bytes).
+  //!  Alpha is ignored by BC1.
+  //------------------------------------------------------------------------------------------------
+  void encode_bc1_block(const std::uint8_t* rgba, std::uint8_t* out);
+  void encode_bc3_block(const std::uint8_t* rgba, std::uint8_t* out);
+} // namespace texconv
+} // namespace bogart
+
+#endif // TEXTURE_HPP